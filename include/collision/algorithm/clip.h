@@ -6,9 +6,37 @@
 #include "include/collision/algorithm/gjk.h"
 namespace Physics2D
 {
+	/// <summary>
+	/// Clipping routines for building multi-point contact manifolds
+	/// </summary>
 	class ContactClipper
 	{
-		
+	public:
+		/// <summary>
+		/// Keep the part of segment that satisfies normal.dot(p) <= offset.
+		/// </summary>
+		/// <param name="segment">two end points, clipped in place</param>
+		/// <param name="normal">normal of clipping plane</param>
+		/// <param name="offset">offset of clipping plane</param>
+		/// <returns>return the number of points left</returns>
+		static size_t clip(Vector2* segment, const Vector2& normal, const real& offset);
+		/// <summary>
+		/// Find edge whose normal is the most anti-parallel to reference normal
+		/// </summary>
+		/// <param name="normals">edge normals of incident shape</param>
+		/// <param name="count">number of edges</param>
+		/// <param name="normal">reference normal in local space of incident shape</param>
+		/// <returns>return index of incident edge start vertex</returns>
+		static size_t findIncidentEdge(const Vector2* normals, const size_t& count, const Vector2& normal);
+		/// <summary>
+		/// Feature of a manifold point: the touching edge of each shape and the end of the contact the point lies at.
+		/// Whichever shape gives the reference edge, and whether a vertex was clipped, the same point gets the same id.
+		/// </summary>
+		/// <param name="edgeA">edge of shape A</param>
+		/// <param name="edgeB">edge of shape B</param>
+		/// <param name="side">0 or 1 along the contact tangent</param>
+		/// <returns>nonzero feature</returns>
+		static uint32_t feature(const size_t& edgeA, const size_t& edgeB, const size_t& side);
 	};
 	
 }
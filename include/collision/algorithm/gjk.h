@@ -60,6 +60,11 @@ namespace Physics2D
 		PointPair() = default;
 		Vector2 pointA;
 		Vector2 pointB;
+		/// <summary>
+		/// Geometric features that made the point, stable while the same edges touch.
+		/// Low half comes from clipping, high half tells children apart. Zero means unknown.
+		/// </summary>
+		uint64_t feature = 0;
 		bool isEmpty()const
 		{
 			return pointA.fuzzyEqual({ 0, 0 }) && pointB.fuzzyEqual({ 0, 0 });
@@ -87,15 +92,16 @@ namespace Physics2D
 		                                     const size_t& iteration = 20);
 		/// <summary>
 		/// Expanding Polygon Algorithm
+		/// Edges of polytope are kept in a min-heap by distance to origin, only the closest edge is split each iteration.
 		/// </summary>
 		/// <param name="shape_A"></param>
 		/// <param name="shape_B"></param>
 		/// <param name="src">initial simplex</param>
-		/// <param name="iteration">iteration times</param>
-		/// <param name="epsilon">epsilon of iterated result</param>
-		/// <returns>return expanded simplex</returns>
-		static Simplex epa(const ShapePrimitive& shapeA, const ShapePrimitive& shapshapeBe_B, const Simplex& src,
-		                   const size_t& iteration = 20, const real& epsilon = Constant::GeometryEpsilon);
+		/// <param name="iteration">maximum iteration times</param>
+		/// <param name="epsilon">relative error of penetration depth to stop expanding</param>
+		/// <returns>return the polytope edge closest to origin as a two points simplex, and iterations used</returns>
+		static std::tuple<Simplex, size_t> epa(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB, const Simplex& src,
+		                   const size_t& iteration = 20, const real& epsilon = 0.0001);
 		/// <summary>
 		/// Dump collision penetration normal and depth
 		/// </summary>
@@ -127,6 +133,15 @@ namespace Physics2D
 		/// <returns></returns>
 		static Vector2 findFarthestPoint(const ShapePrimitive& shape, const Vector2& direction);
 		/// <summary>
+		/// Find index of farthest polygon vertex in given local direction.
+		/// Small polygons are scanned directly, large polygons hill-climb from seed vertex.
+		/// </summary>
+		/// <param name="polygon"></param>
+		/// <param name="direction"></param>
+		/// <param name="seed">index of vertex to start climbing from, usually the previous result</param>
+		/// <returns></returns>
+		static size_t findFarthestIndex(const Polygon* polygon, const Vector2& direction, const size_t& seed = 0);
+		/// <summary>
 		/// Adjust triangle simplex, remove the point that can not form a triangle that contains origin
 		/// </summary>
 		/// <param name="simplex"></param>
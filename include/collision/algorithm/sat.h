@@ -24,9 +24,22 @@ namespace Physics2D
         static std::tuple<ProjectedSegment, real> intersect(const ProjectedSegment& s1, const ProjectedSegment& s2);
     };
 	
+    /// <summary>
+    /// Convex outline given by raw arrays, count edges and count + 1 vertices including the closing vertex.
+    /// Outline is rounded by radius.
+    /// </summary>
+    struct ConvexOutline
+    {
+        const Vector2* vertices = nullptr;
+        const Vector2* normals = nullptr;
+        size_t count = 0;
+        real radius = 0;
+    };
+	
     struct SATResult
     {
         PointPair pointPair[2];
+        size_t contactsCount = 0;
         Vector2 normal;
         real penetration = 0;
         bool isColliding = false;
@@ -44,8 +57,22 @@ namespace Physics2D
         static SATResult circleVsCircle(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB);
         static SATResult circleVsPolygon(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB);
 
-        static SATResult polygonVsPolygon(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB);
+        /// <summary>
+        /// Clipped manifold of two polygons. With margin above zero, polygons apart by up to margin give points too,
+        /// each at its own separation and with negative penetration for the closest one: the speculative manifold of the pair.
+        /// </summary>
+        static SATResult polygonVsPolygon(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB, const real& margin = 0);
 		static SATResult polygonVsEdge(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB);
+        /// <summary>
+        /// Two-sided test of polygon A against segment B given in world space.
+        /// If segmentReference is set, the front face of segment is always used as reference face.
+        /// Margin works as in polygonVsPolygon.
+        /// </summary>
+        static SATResult polygonVsSegment(const ShapePrimitive& shapeA, const Vector2& start, const Vector2& end, const bool& segmentReference = false, const real& margin = 0);
+        /// <summary>
+        /// Two-sided test of circle A against segment B given in world space
+        /// </summary>
+        static SATResult circleVsSegment(const ShapePrimitive& shapeA, const Vector2& start, const Vector2& end);
         static SATResult polygonVsCapsule(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB);
         static SATResult polygonVsSector(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB);
         
@@ -55,6 +82,7 @@ namespace Physics2D
 
         static SATResult sectorVsSector(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB);
     private:
+        static SATResult outlineVsOutline(const ShapePrimitive& shapeA, const ConvexOutline& outlineA, const ShapePrimitive& shapeB, const ConvexOutline& outlineB, const bool& referenceB = false, const real& margin = 0);
         static ProjectedSegment axisProjection(const ShapePrimitive& shape, Polygon* polygon, const Vector2& normal);
         static ProjectedSegment axisProjection(const ShapePrimitive& shape, Circle* circle, const Vector2& normal);
         static ProjectedSegment axisProjection(const ShapePrimitive& shape, Ellipse* ellipse, const Vector2& normal);
@@ -2,11 +2,13 @@
 #define PHYSICS2D_BROADPHASE_AABB_H
 
 #include "include/math/linear/linear.h"
-#include "include/geometry/shape.h"
+#include "include/math/math.h"
+#include "include/common/common.h"
 
 namespace Physics2D
 {
 	class Body;
+	struct ShapePrimitive;
 
 	struct AABB
 	{
@@ -27,6 +27,13 @@ namespace Physics2D
 			~DBVH();
 			void insert(Body* body);
 			void update(Body* body);
+			/// <summary>
+			/// Fit leaf of body to aabb instead of its shape, such as the box a fast body sweeps through in a step.
+			/// Pairs are generated against that box until the leaf is fitted again.
+			/// </summary>
+			/// <param name="body"></param>
+			/// <param name="aabb"></param>
+			void update(Body* body, const AABB& aabb);
 			Node* extract(Body* body);
 			void erase(Body* body);
 			Node* raycast(const Vector2& start, const Vector2& direction);
@@ -38,8 +45,13 @@ namespace Physics2D
 		private:
 			void insert(Node* node);
 			void cleanUp(Node* node);
+			/// <summary>
+			/// Leaf a new leaf of aabb is merged with, found by descending from root
+			/// </summary>
+			/// <param name="aabb"></param>
+			/// <returns></returns>
+			Node* sibling(const AABB& aabb)const;
 			real deltaCost(Node* node, const AABB& aabb)const;
-			void totalCost(Node* node, const AABB& aabb, real& cost)const;
 			Node* merge(Node* node, const Pair& pair);
 			void merge(Node* target, Node* source);
 			void update(Node* parent);
@@ -0,0 +1,45 @@
+#ifndef PHYSICS2D_BROADPHASE_STATIC_TREE_H
+#define PHYSICS2D_BROADPHASE_STATIC_TREE_H
+#include "aabb.h"
+
+namespace Physics2D
+{
+	/// <summary>
+	/// Bounding volume tree built once over a fixed list of boxes.
+	/// Nodes are stored in a vector, leaves refer to the index of source box.
+	/// Used for children of shapes in their local space.
+	/// </summary>
+	class StaticTree
+	{
+	public:
+		struct Node
+		{
+			AABB aabb;
+			int left = -1;
+			int right = -1;
+			int index = -1;
+			bool isLeaf()const;
+		};
+		/// <summary>
+		/// Rebuild tree by splitting boxes at the median of the longest axis
+		/// </summary>
+		/// <param name="boxes"></param>
+		void build(const std::vector<AABB>& boxes);
+		/// <summary>
+		/// Append index of every box overlapping aabb to result
+		/// </summary>
+		/// <param name="aabb"></param>
+		/// <param name="result"></param>
+		void query(const AABB& aabb, std::vector<size_t>& result)const;
+		const std::vector<Node>& nodes()const;
+		void clear();
+	private:
+		int build(std::vector<size_t>& indices, const size_t& begin, const size_t& end, const std::vector<AABB>& boxes);
+		std::vector<Node> m_nodes;
+	};
+	inline bool StaticTree::Node::isLeaf() const
+	{
+		return index != -1;
+	}
+}
+#endif
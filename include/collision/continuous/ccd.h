@@ -5,22 +5,10 @@
 #include "include/dynamics/body.h"
 namespace Physics2D
 {
-	
+
 	class CCD
 	{
 	public:
-		struct AABBShot
-		{
-			AABBShot(const AABB& box, const Body::PhysicsAttribute& attr, const real& t) : aabb(box), attribute(attr), time(t){}
-			AABB aabb;
-			Body::PhysicsAttribute attribute;
-			real time = 0;
-		};
-		struct IndexSection
-		{
-			int forward = -1;
-			int backward = -1;
-		};
 		struct CCDPair
 		{
 			CCDPair() = default;
@@ -28,13 +16,73 @@ namespace Physics2D
 			real toi = 0.0;
 			Body* body = nullptr;
 		};
-		typedef std::vector<AABBShot> BroadphaseTrajectory;
-		static std::tuple<BroadphaseTrajectory, AABB> buildTrajectoryAABB(Body* body, const real& dt);
-		static std::tuple<std::vector<AABBShot>, AABB> buildTrajectoryAABB(Body* body, const Vector2& target, const real& dt);
-		static std::optional<IndexSection> findBroadphaseRoot(Body* body1, const BroadphaseTrajectory& trajectory1, Body* body2, const BroadphaseTrajectory& trajectory2, const real& dt);
-		static std::optional<real> findNarrowphaseRoot(Body* body1, const BroadphaseTrajectory& trajectory1, Body* body2, const BroadphaseTrajectory& trajectory2, const IndexSection& index, const real& dt);
+		/// <summary>
+		/// Bounding box of everything body covers while moving with its current velocities for dt.
+		/// A rotating body is bounded by the disc it can sweep around its position.
+		/// </summary>
+		/// <param name="body"></param>
+		/// <param name="dt"></param>
+		/// <returns></returns>
+		static AABB sweep(Body* body, const real& dt);
+		/// <summary>
+		/// Sweep of body from start instead of its current pose and velocities
+		/// </summary>
+		/// <param name="body"></param>
+		/// <param name="start"></param>
+		/// <param name="dt"></param>
+		/// <returns></returns>
+		static AABB sweep(Body* body, const Body::PhysicsAttribute& start, const real& dt);
+		/// <summary>
+		/// Time of impact of two bodies moving with their current velocities, by conservative advancement.
+		/// Every iteration takes the GJK distance of convex pieces of both bodies and advances time as far as
+		/// the plane between the closest points is sure to separate them, bounding motion by linear velocity along
+		/// the normal and angular velocity times the reach of the body. Bodies never pass through each other
+		/// and stop about Target apart. Piece pairs touching or within Target + Tolerance at the start are left to discrete
+		/// and speculative contact.
+		/// </summary>
+		/// <param name="body1"></param>
+		/// <param name="body2"></param>
+		/// <param name="dt"></param>
+		/// <param name="closest">if given, closest points of the pieces that stopped the pair, on body1 then body2</param>
+		/// <returns>time in (0, dt] at which the pair comes within Target, none if it does not</returns>
+		static std::optional<real> timeOfImpact(Body* body1, Body* body2, const real& dt, PointPair* closest = nullptr);
+		/// <summary>
+		/// Time of impact of bodies moving from start1 and start2 instead of their current poses and velocities.
+		/// Bodies are only read, so pairs can be swept from other threads.
+		/// </summary>
+		/// <param name="body1"></param>
+		/// <param name="start1"></param>
+		/// <param name="body2"></param>
+		/// <param name="start2"></param>
+		/// <param name="dt"></param>
+		/// <param name="closest"></param>
+		/// <returns></returns>
+		static std::optional<real> timeOfImpact(Body* body1, const Body::PhysicsAttribute& start1, Body* body2, const Body::PhysicsAttribute& start2,
+			const real& dt, PointPair* closest = nullptr);
 		static std::optional<std::vector<CCDPair>> query(DBVH::Node* root, Body* body, const real& dt);
+		/// <summary>
+		/// Upper bound of distance from position of body to any point of its shape
+		/// </summary>
+		/// <param name="body"></param>
+		/// <returns></returns>
+		static real reach(Body* body);
 
+		static constexpr real Target = 0.005;
+		static constexpr real Tolerance = 0.0025;
+		static constexpr int MaxIterations = 20;
+	private:
+		/// <summary>
+		/// Convex pieces of body in its local space. Compounds give their children,
+		/// chains and heightfields at pose give the segments near the sweep of other from otherStart.
+		/// </summary>
+		/// <param name="body"></param>
+		/// <param name="pose"></param>
+		/// <param name="other"></param>
+		/// <param name="otherStart"></param>
+		/// <param name="dt"></param>
+		/// <param name="output"></param>
+		static void pieces(Body* body, const Body::PhysicsAttribute& pose, Body* other, const Body::PhysicsAttribute& otherStart,
+			const real& dt, std::vector<ShapePrimitive>& output);
 	};
 }
 #endif
\ No newline at end of file
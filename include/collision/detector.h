@@ -6,6 +6,7 @@
 #include "include/math/math.h"
 #include "include/geometry/shape.h"
 #include "include/dynamics/body.h"
+#include "include/utils/worker_pool.h"
 
 namespace Physics2D
 {
@@ -17,17 +18,74 @@ namespace Physics2D
 		std::vector<PointPair> contactList;
 		Vector2 normal;
 		real penetration = 0;
+		//iterations epa spent on the pair, zero when penetration came without it
+		size_t epaIterations = 0;
 	};
 
+	class ManifoldCache;
+
 	class Detector
 	{
 
 	public:
 		static bool collide(Body* bodyA, Body* bodyB);
 		static Collision detect(Body* bodyA, Body* bodyB);
+		/// <summary>
+		/// Narrowphase for pairs with compound bodies.
+		/// Children are culled by the child tree of compound, and every touching child pair gives its own collision.
+		/// </summary>
+		/// <param name="bodyA"></param>
+		/// <param name="bodyB"></param>
+		/// <returns></returns>
+		static std::vector<Collision> detectCompound(Body* bodyA, Body* bodyB);
+		/// <summary>
+		/// Narrowphase for pairs with a chain or heightfield body.
+		/// Only segments near the other shape are tested, every touching segment gives its own collision.
+		/// </summary>
+		/// <param name="bodyA"></param>
+		/// <param name="bodyB"></param>
+		/// <returns></returns>
+		static std::vector<Collision> detectChain(Body* bodyA, Body* bodyB);
 		static std::optional<PointPair> distance(Body* bodyA, Body* bodyB);
+		/// <summary>
+		/// Speculative contact for a separated pair that may touch within dt.
+		/// Polygons and edges are clipped like touching ones, so faces give two points with their own separations.
+		/// Other shapes give the closest points of GJK distance. The penetration is the negative of the smallest separation.
+		/// </summary>
+		/// <param name="bodyA"></param>
+		/// <param name="bodyB"></param>
+		/// <param name="dt">time step used to bound the approach of the pair</param>
+		/// <returns></returns>
+		static Collision speculate(Body* bodyA, Body* bodyB, const real& dt);
+		/// <summary>
+		/// Narrowphase for a batch of broadphase pairs.
+		/// Pairs are bucketed by shape type pair and dispatched to specialized kernels,
+		/// the rest falls back to GJK/EPA. Returns colliding results in the order of input pairs.
+		/// If pool is given, every bucket is split across its workers. Each pair owns its output slot,
+		/// so results are identical for any number of workers.
+		/// If speculativeTime is positive, separated pairs that may touch within it get speculative contacts.
+		/// If cache is given, pairs that barely moved relative to each other reuse their last manifold,
+		/// and pairs missing from this batch are pruned from it.
+		/// </summary>
+		/// <param name="pairs">potential pairs from broadphase</param>
+		/// <param name="pool">optional worker pool</param>
+		/// <param name="speculativeTime">time step for speculative contacts, zero to disable</param>
+		/// <param name="cache">optional manifold cache</param>
+		/// <returns></returns>
+		static std::vector<Collision> detect(const std::vector<std::pair<Body*, Body*>>& pairs, Utils::WorkerPool* pool = nullptr, const real& speculativeTime = 0, ManifoldCache* cache = nullptr);
 		
 	private:
+		using PairList = std::vector<std::pair<Body*, Body*>>;
+		static Collision detect(Body* bodyA, const ShapePrimitive& shapeA, Body* bodyB, const ShapePrimitive& shapeB);
+		static Collision detectConvex(Body* bodyA, const ShapePrimitive& shapeA, Body* bodyB, const ShapePrimitive& shapeB);
+		static void collectChildren(const ShapePrimitive& shape, const AABB& region, std::vector<ShapePrimitive>& output);
+		static Collision detectSegment(Body* body, const ShapePrimitive& shape, Body* chainBody, const ShapePrimitive& chainShape, const Chain::Segment& segment);
+		static AABB localRegion(const ShapePrimitive& shape, const AABB& region);
+		static bool isTerrain(const Shape::Type& type);
+		static void circleVsCircleBatch(const PairList& pairs, const std::vector<size_t>& indices, size_t begin, size_t end, std::vector<Collision>& output);
+		static void circleVsPolygonBatch(const PairList& pairs, const std::vector<size_t>& indices, size_t begin, size_t end, std::vector<Collision>& output);
+		static void polygonVsPolygonBatch(const PairList& pairs, const std::vector<size_t>& indices, size_t begin, size_t end, std::vector<Collision>& output);
+		static void fromSATResult(const SATResult& sat, Collision& collision, bool swap);
 	};
 	
 }
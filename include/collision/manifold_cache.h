@@ -0,0 +1,63 @@
+#ifndef PHYSICS2D_MANIFOLD_CACHE_H
+#define PHYSICS2D_MANIFOLD_CACHE_H
+#include "include/collision/detector.h"
+#include <unordered_map>
+
+namespace Physics2D
+{
+	/// <summary>
+	/// Narrowphase results of last steps, keyed by body pair.
+	/// Manifolds are kept in local space of bodies along with the relative transform they were computed at.
+	/// While the pair moves relatively less than the tolerances, the manifold is re-projected instead of detected again.
+	/// Shapes edited in place are not noticed, clear the cache after editing them.
+	/// </summary>
+	class ManifoldCache
+	{
+	public:
+		ManifoldCache(const real& linearTolerance = 0.000001, const real& angularTolerance = 0.000001);
+
+		real linearTolerance()const;
+		void setLinearTolerance(const real& tolerance);
+
+		real angularTolerance()const;
+		void setAngularTolerance(const real& tolerance);
+		/// <summary>
+		/// Get cached collisions of pair in world space, if relative transform is still within tolerances.
+		/// Empty output with true return means the pair was separated.
+		/// </summary>
+		/// <param name="bodyA"></param>
+		/// <param name="bodyB"></param>
+		/// <param name="output"></param>
+		/// <returns></returns>
+		bool fetch(Body* bodyA, Body* bodyB, std::vector<Collision>& output);
+		void store(Body* bodyA, Body* bodyB, const std::vector<Collision>& collisions);
+		/// <summary>
+		/// Drop pairs that were neither fetched nor stored since last prune
+		/// </summary>
+		void prune();
+		void clear();
+		size_t size()const;
+	private:
+		struct Entry
+		{
+			const Shape* shapeA = nullptr;
+			const Shape* shapeB = nullptr;
+			Vector2 relativePosition;
+			real relativeRotation = 0;
+			std::vector<Collision> collisions;
+			bool touched = false;
+		};
+		struct PairHash
+		{
+			size_t operator()(const std::pair<Body*, Body*>& pair)const
+			{
+				return std::hash<Body*>()(pair.first) ^ (std::hash<Body*>()(pair.second) * 31);
+			}
+		};
+		static std::tuple<Vector2, real> relativeTransform(Body* bodyA, Body* bodyB);
+		real m_linearTolerance;
+		real m_angularTolerance;
+		std::unordered_map<std::pair<Body*, Body*>, Entry, PairHash> m_entries;
+	};
+}
+#endif
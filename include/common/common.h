@@ -11,6 +11,15 @@
 #include <functional>
 #include <memory>
 #include <map>
+
+//simd instruction sets available for double precision kernels
+#if !defined(SINGLE_PRECISION) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define PHYSICS2D_SSE2
+#endif
+#if !defined(SINGLE_PRECISION) && defined(__AVX2__)
+#define PHYSICS2D_AVX2
+#endif
+
 namespace Physics2D
 {
 #ifdef SINGLE_PRECISION
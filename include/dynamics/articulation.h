@@ -0,0 +1,222 @@
+#ifndef PHYSICS2D_ARTICULATION_H
+#define PHYSICS2D_ARTICULATION_H
+#include "include/dynamics/body.h"
+#include "include/math/linear/matrix3x3.h"
+namespace Physics2D
+{
+	enum class ArticulationJointType
+	{
+		Revolute,
+		Prismatic
+	};
+	/// <summary>
+	/// Tree of bodies in reduced coordinates, every link but the root has one degree of freedom relative to its parent.
+	/// Links are placed from joint coordinates by forward kinematics, so joints can not drift apart.
+	/// A dynamic root floats freely, any other root is fixed and only carries the tree along at the velocity it was given.
+	/// Forward dynamics is the articulated body algorithm, O(n) in links.
+	/// Spatial vectors are planar (angular, linear x, linear y) about the world origin, so links need no transforms between them.
+	/// Bodies of links are moved by the articulation only, joints of World must not act on them.
+	/// </summary>
+	class Articulation
+	{
+	public:
+		Articulation(Body* root);
+		/// <summary>
+		/// Join body to parent link by a hinge at localPointA on parent and localPointB on body. Returns index of the new link.
+		/// Joint position is zero at the current rotations.
+		/// </summary>
+		/// <param name="parent"></param>
+		/// <param name="body"></param>
+		/// <param name="localPointA"></param>
+		/// <param name="localPointB"></param>
+		/// <returns></returns>
+		size_t addRevolute(const size_t& parent, Body* body, const Vector2& localPointA, const Vector2& localPointB);
+		/// <summary>
+		/// Join body to parent link by a slider along localAxis of parent. Returns index of the new link.
+		/// Joint position is the current offset of localPointB from localPointA along the axis.
+		/// </summary>
+		/// <param name="parent"></param>
+		/// <param name="body"></param>
+		/// <param name="localPointA"></param>
+		/// <param name="localPointB"></param>
+		/// <param name="localAxis"></param>
+		/// <returns></returns>
+		size_t addPrismatic(const size_t& parent, Body* body, const Vector2& localPointA, const Vector2& localPointB, const Vector2& localAxis);
+		/// <summary>
+		/// Joint accelerations from gravity, forces of link bodies and joint forces, then integrate joint velocities.
+		/// The tree is integrated in inner steps short for its fastest joint, links are put back where they were
+		/// and the motion is kept for stepPosition.
+		/// </summary>
+		/// <param name="h"></param>
+		/// <param name="gravity"></param>
+		void stepVelocity(const real& h, const Vector2& gravity);
+		/// <summary>
+		/// Move links by the motion of stepVelocity plus the velocity impulses changed since, over h, and place them.
+		/// A floating root then takes the velocity that keeps the momentum of the tree to what forces and impulses gave it.
+		/// </summary>
+		/// <param name="h"></param>
+		void stepPosition(const real& h);
+		/// <summary>
+		/// Impulse at world point on link, propagated through the tree to joint velocities and velocities of all links
+		/// </summary>
+		/// <param name="link"></param>
+		/// <param name="impulse"></param>
+		/// <param name="point"></param>
+		void applyImpulse(const size_t& link, const Vector2& impulse, const Vector2& point);
+		/// <summary>
+		/// Velocity change along direction at world point of link per unit impulse along direction, O(depth of link)
+		/// </summary>
+		/// <param name="link"></param>
+		/// <param name="point"></param>
+		/// <param name="direction"></param>
+		/// <returns></returns>
+		real inverseMass(const size_t& link, const Vector2& point, const Vector2& direction);
+
+		size_t links()const;
+		Body* body(const size_t& link)const;
+		ArticulationJointType jointType(const size_t& link)const;
+		real jointPosition(const size_t& link)const;
+		real jointVelocity(const size_t& link)const;
+		/// <summary>
+		/// Torque of a hinge or force of a slider driving link, kept until changed
+		/// </summary>
+		/// <param name="link"></param>
+		/// <returns></returns>
+		real& jointForce(const size_t& link);
+		/// <summary>
+		/// Take energy the integration gains from motion of links, off by default.
+		/// The inner steps of the tree keep it stable without, but long fast chains still gain some energy.
+		/// </summary>
+		/// <returns></returns>
+		bool energyLimit()const;
+		void setEnergyLimit(const bool& energyLimit);
+	private:
+		/// <summary>
+		/// Names in comments follow Featherstone: S motion subspace, IA articulated inertia, pA articulated bias force,
+		/// U = IA S, D = S^T U, u = force - S^T pA
+		/// </summary>
+		struct Link
+		{
+			Body* body = nullptr;
+			size_t parent = 0;
+			ArticulationJointType type = ArticulationJointType::Revolute;
+			Vector2 localPointA;
+			Vector2 localPointB;
+			Vector2 localAxis;
+			//rotation relative to parent at joint position zero
+			real reference = 0;
+			real position = 0;
+			real velocity = 0;
+			//joint velocity at the start of an inner step, then the one the velocity step ended with
+			real start = 0;
+			//change of joint position over the velocity step, applied by the position step
+			real travel = 0;
+			real force = 0;
+
+			//S, spatial velocity, velocity product acceleration and spatial acceleration
+			Vector3 motion;
+			Vector3 spatialVelocity;
+			Vector3 bias;
+			Vector3 acceleration;
+			//rigid inertia of the link, then IA, U and D
+			Matrix3x3 inertia;
+			Matrix3x3 articulatedInertia;
+			Vector3 inertiaMotion;
+			real pivot = 0;
+			//pA and u
+			Vector3 articulatedForce;
+			real residual = 0;
+		};
+		size_t add(Link link);
+		/// <summary>
+		/// Poses of links and their motion subspaces from joint positions, root to leaves
+		/// </summary>
+		void place();
+		/// <summary>
+		/// Spatial velocities of links from joint velocities, written to bodies of links
+		/// </summary>
+		void propagate();
+		/// <summary>
+		/// Articulated inertias from leaves to root. They depend on positions only and are kept until links move.
+		/// </summary>
+		void factor();
+		/// <summary>
+		/// Joint accelerations with velocity products of current velocities, joint velocities become start ones advanced over h
+		/// </summary>
+		/// <param name="h"></param>
+		void accelerate(const real& h);
+		/// <summary>
+		/// Articulated bias of spatial impulse on link carried to root, u of links on the way and spatial velocity change of root.
+		/// Fills m_path with link and its ancestors, root excluded.
+		/// </summary>
+		/// <param name="link"></param>
+		/// <param name="impulse"></param>
+		/// <returns></returns>
+		Vector3 rootResponse(const size_t& link, const Vector3& impulse);
+		/// <summary>
+		/// Add spatial velocity change of an impulse to a floating root
+		/// </summary>
+		/// <param name="velocityChange"></param>
+		void moveRoot(const Vector3& velocityChange);
+		/// <summary>
+		/// Spatial velocity that motion of links is measured against: a fixed root, or the whole tree as one rigid body.
+		/// Scaling joint velocities and the root about it scales kinetic energy relative to it and keeps momentum.
+		/// </summary>
+		/// <returns></returns>
+		Vector3 frame()const;
+		/// <summary>
+		/// Spatial momentum of all links about the world origin
+		/// </summary>
+		/// <returns></returns>
+		Vector3 momentum()const;
+		/// <summary>
+		/// Spatial force of gravity and forces of link bodies about the world origin
+		/// </summary>
+		/// <returns></returns>
+		Vector3 external()const;
+		/// <summary>
+		/// Kinetic energy of moving links relative to frame
+		/// </summary>
+		/// <param name="frame"></param>
+		/// <returns></returns>
+		real kineticEnergy(const Vector3& frame)const;
+		real potentialEnergy()const;
+		/// <summary>
+		/// Power of forces of link bodies and joint forces, gravity is in the potential energy
+		/// </summary>
+		/// <returns></returns>
+		real power()const;
+		/// <summary>
+		/// Keep the energy of the tree from growing beyond the energy of last step plus work of forces, impulses
+		/// and position correction, only with energy limit on
+		/// </summary>
+		void limit();
+
+		std::vector<Link> m_links;
+		std::vector<size_t> m_path;
+		//inverse articulated inertia of a floating root
+		Matrix3x3 m_rootInverse;
+		//energy the tree may have at the next velocity step, kinetic energy after the last one and energy after it was placed
+		real m_energy = 0;
+		real m_kinetic = 0;
+		real m_placed = 0;
+		bool m_tracked = false;
+		bool m_energyLimit = false;
+		Vector2 m_gravity;
+		bool m_floating = false;
+		bool m_factored = false;
+		//the most a joint may turn or slide in one inner step of the tree and the most inner steps of a step
+		real m_turn = 0.1;
+		real m_maxSteps = 256;
+		//motion of the root over the velocity step and the velocity it ended with
+		Vector2 m_rootTravel;
+		real m_rootTurn = 0;
+		Vector2 m_rootVelocity;
+		real m_rootAngularVelocity = 0;
+		//momentum the tree should have after the position step without impulses, and impulses since the velocity step
+		Vector3 m_momentum;
+		Vector3 m_impulse;
+		bool m_stepped = false;
+	};
+}
+#endif
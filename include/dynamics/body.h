@@ -8,6 +8,7 @@
 
 namespace Physics2D
 {
+	class Articulation;
 	class Body
 	{
 	public:
@@ -79,8 +80,18 @@ namespace Physics2D
 
 		real restitution()const;
 		void setRestitution(const real& restitution);
+
+		/// <summary>
+		/// Articulation the body is a link of, null for free bodies. Links are moved by their articulation instead of World.
+		/// </summary>
+		/// <returns></returns>
+		Articulation* articulation()const;
+		size_t link()const;
+		void setArticulation(Articulation* articulation, const size_t& link);
 	private:
 		void calcInertia();
+		static real calcInertia(const Shape* shape, const real& mass);
+		static real calcArea(const Shape* shape);
 
 		int m_id;
 
@@ -104,6 +115,9 @@ namespace Physics2D
 		real m_friction = 0.2;
 		real m_restitution = 0.8;
 
+		Articulation* m_articulation = nullptr;
+		size_t m_link = 0;
+
 		BodyState m_bodyState;
 
 		
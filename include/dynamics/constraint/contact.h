@@ -1,14 +1,22 @@
 #ifndef PHYSICS2D_CONSTRAINT_CONTACT_H
 #define PHYSICS2D_CONSTRAINT_CONTACT_H
-#include <string>
+#include <cstdint>
 
 #include "include/dynamics/body.h"
-#include "include/utils/random.h"
 #include "include/collision/detector.h"
+#include "include/dynamics/constraint/graph.h"
+#include "include/dynamics/constraint/softness.h"
+#include "include/utils/worker_pool.h"
 namespace Physics2D
 {
-	using RelationID = long;
-	static RelationID generateRelation(Body* bodyA, Body* bodyB);
+	using RelationID = uint64_t;
+	/// <summary>
+	/// Pack ids of two bodies into one key, smaller id in high bits so that the key ignores argument order
+	/// </summary>
+	/// <param name="bodyA"></param>
+	/// <param name="bodyB"></param>
+	/// <returns></returns>
+	RelationID generateRelation(Body* bodyA, Body* bodyB);
 	struct VelocityConstraintPoint
 	{
 		Vector2 ra;
@@ -18,7 +26,12 @@ namespace Physics2D
 		Vector2 normal;
 		Vector2 tangent;
 		real bias = 0;
+		real separation = 0;
 		real restitution = 0.8;
+		//approaching velocity before the solve, kept from the step a speculative contact started holding the bodies back
+		real approach = 0;
+		//velocity the bodies part at on the step the contact touches after being speculative, restitution of approach
+		real bounce = 0;
 		real effectiveMassNormal = 0;
 		real effectiveMassTangent = 0;
 		real accumulatedNormalImpulse = 0;
@@ -30,7 +43,8 @@ namespace Physics2D
 	{
 		ContactConstraintPoint() = default;
 		RelationID relation = 0;
-		int contactId = RandomGenerator::unique(1, 99999);
+		//feature of the manifold point, zero for curved shapes
+		uint64_t feature = 0;
 		real friction = 0.2;
 		bool active = true;
 		Vector2 localA;
@@ -39,16 +53,259 @@ namespace Physics2D
 		Body* bodyB = nullptr;
 		VelocityConstraintPoint vcp;
 	};
+	/// <summary>
+	/// Contact points of one body pair, kept across steps for warm starting
+	/// </summary>
+	struct ContactPair
+	{
+		RelationID relation = 0;
+		std::vector<ContactConstraintPoint> contacts;
+	};
+	/// <summary>
+	/// Velocity iterations spent by the last solve. Islands are groups of bodies linked by contacts through movable bodies.
+	/// </summary>
+	struct IterationStatistics
+	{
+		size_t islands = 0;
+		//sum over islands
+		size_t iterations = 0;
+		int maxIterations = 0;
+	};
+	/// <summary>
+	/// Pairs are stored densely and found through an open addressing table from relation to slot.
+	/// Stale contacts and empty pairs are swap-removed, so bookkeeping never shifts or reallocates per step.
+	/// </summary>
 	class ContactMaintainer
 	{
 	public:
-		void solve(real dt);
+		/// <summary>
+		/// Solve colors one by one, batches of a color are spread over pool when given
+		/// </summary>
+		/// <param name="dt"></param>
+		/// <param name="pool"></param>
+		void solve(real dt, Utils::WorkerPool* pool = nullptr);
+		/// <summary>
+		/// Substep mode, driven by World::substep. Pack prepared contacts once per step, h is the substep length.
+		/// </summary>
+		/// <param name="h"></param>
+		void beginSubsteps(const real& h);
+		/// <summary>
+		/// One relaxed iteration. With bias: warm start, then push out of penetration as soft springs.
+		/// Without bias: remove velocity the soft push added, after positions were integrated.
+		/// </summary>
+		/// <param name="h"></param>
+		/// <param name="useBias"></param>
+		/// <param name="pool"></param>
+		void solveSubstep(const real& h, const bool& useBias, Utils::WorkerPool* pool = nullptr);
+		/// <summary>
+		/// Apply restitution to contacts that approached faster than threshold, then keep impulses for warm starting
+		/// </summary>
+		/// <param name="pool"></param>
+		void endSubsteps(Utils::WorkerPool* pool = nullptr);
+		/// <summary>
+		/// One nonlinear Gauss-Seidel iteration over contacts of last solve, after positions were integrated.
+		/// Does nothing unless m_positionCorrection is set.
+		/// </summary>
+		/// <param name="pool"></param>
+		void solvePosition(Utils::WorkerPool* pool = nullptr);
 		void add(const Collision& collision);
-		std::map<RelationID, std::vector<ContactConstraintPoint>> m_contactTable;
+		void clear();
+		const std::vector<ContactPair>& pairs()const;
+		const IterationStatistics& statistics()const;
 		void prepare(ContactConstraintPoint& ccp, const PointPair& pair, const Collision& collision);
 		real m_maxPenetration = 0.01;
 		real m_biasFactor = 0.2;
+		/// <summary>
+		/// Iterations of solve. With m_impulseTolerance above zero this is the cap, and an island stops iterating
+		/// once the largest impulse change of its contacts falls below tolerance after m_minVelocityIterations.
+		/// </summary>
+		int m_velocityIterations = 1;
+		int m_minVelocityIterations = 1;
+		real m_impulseTolerance = 0;
+		real m_contactHertz = 60;
+		real m_contactDampingRatio = 10;
+		real m_maxBiasVelocity = 3;
+		real m_restitutionThreshold = 1;
+		/// <summary>
+		/// Iteration mode: solve both normal impulses of two point manifolds at once
+		/// </summary>
+		bool m_blockSolve = false;
+		/// <summary>
+		/// Iteration mode: push contacts apart in solvePosition instead of adding bias velocity, so correction adds no energy.
+		/// m_maxPenetration is the slop left alone, m_biasFactor the fraction of the rest corrected per iteration.
+		/// </summary>
+		bool m_positionCorrection = false;
+		real m_maxLinearCorrection = 0.2;
 	private:
+		static constexpr size_t Lanes = 4;
+		//colors with fewer batches are not worth waking the workers
+		static constexpr size_t ParallelBatches = 32;
+		/// <summary>
+		/// Prepared contacts stored lane by lane, one simd register per field.
+		/// Lanes take contacts of one color, so gathered velocities can be scattered back without conflicts.
+		/// Unused lanes point to slot 0 and carry zero mass.
+		/// </summary>
+		struct ConstraintBatch
+		{
+			size_t count = 0;
+			ContactConstraintPoint* points[Lanes] = {};
+			int32_t slotA[Lanes] = {};
+			int32_t slotB[Lanes] = {};
+			real raX[Lanes] = {}, raY[Lanes] = {};
+			real rbX[Lanes] = {}, rbY[Lanes] = {};
+			real normalX[Lanes] = {}, normalY[Lanes] = {};
+			real tangentX[Lanes] = {}, tangentY[Lanes] = {};
+			real invMassA[Lanes] = {}, invInertiaA[Lanes] = {};
+			real invMassB[Lanes] = {}, invInertiaB[Lanes] = {};
+			real massNormal[Lanes] = {}, massTangent[Lanes] = {};
+			real restitution[Lanes] = {}, target[Lanes] = {}, friction[Lanes] = {};
+			real normalImpulse[Lanes] = {}, tangentImpulse[Lanes] = {};
+			real massScale[Lanes] = {}, impulseScale[Lanes] = {};
+			real relativeVelocity[Lanes] = {};
+			//island of each lane and impulse change of its last iteration
+			int32_t island[Lanes] = {};
+			real residual[Lanes] = {};
+			//false once islands of all lanes converged
+			bool active = true;
+		};
+		/// <summary>
+		/// Both contacts of a two point pair, solved as one 2x2 linear complementarity problem.
+		/// Impulses stay in the contacts, velocities come from the gathered slots.
+		/// </summary>
+		struct ContactBlock
+		{
+			ContactConstraintPoint* points[2] = {};
+			int32_t slotA = 0;
+			int32_t slotB = 0;
+			real invMassA = 0, invInertiaA = 0;
+			real invMassB = 0, invInertiaB = 0;
+			real target[2] = {};
+			//K = [k11 k12; k12 k22] maps normal impulses to normal velocities, normalMass is its inverse
+			real k11 = 0, k12 = 0, k22 = 0;
+			Matrix2x2 normalMass;
+			//false when K is ill-conditioned, the points are solved one after another instead
+			bool coupled = false;
+			int32_t island = 0;
+			real residual = 0;
+			bool active = true;
+		};
+		/// <summary>
+		/// Contact touching a link of an articulation. A link answers an impulse with its whole tree,
+		/// so these contacts take no color and are solved one by one after the batches, with effective masses from the articulation.
+		/// Links have slot 0 and keep their velocities in their bodies. Impulses stay in the contact.
+		/// </summary>
+		struct ArticulatedContact
+		{
+			ContactConstraintPoint* point = nullptr;
+			int32_t slotA = 0;
+			int32_t slotB = 0;
+			real target = 0;
+			real restitution = 0;
+			real massScale = 1;
+			real impulseScale = 0;
+			real relativeVelocity = 0;
+		};
+		/// <summary>
+		/// Color active contacts and pack each color into batches.
+		/// With blocks, pairs of exactly two contacts take one color as a whole and are packed into blocks.
+		/// Pairs with a link of an articulation are packed apart.
+		/// </summary>
+		void pack(real dt, const bool& blocks = false);
+		void pack(ContactConstraintPoint& ccp, const real& dt);
+		void solveBatch(ConstraintBatch& batch);
+		void solveBlock(ContactBlock& block);
+		/// <summary>
+		/// Returns change of the larger impulse
+		/// </summary>
+		/// <param name="contact"></param>
+		/// <returns></returns>
+		real solve(ArticulatedContact& contact);
+		/// <summary>
+		/// Relative velocity of the contact points along axis, links are read from their bodies and other bodies from their slots
+		/// </summary>
+		/// <param name="contact"></param>
+		/// <param name="axis"></param>
+		/// <returns></returns>
+		real relative(const ArticulatedContact& contact, const Vector2& axis)const;
+		/// <summary>
+		/// Impulse on body A and its opposite on body B, links pass it to their articulation
+		/// </summary>
+		/// <param name="contact"></param>
+		/// <param name="impulse"></param>
+		void apply(const ArticulatedContact& contact, const Vector2& impulse);
+		void forEachBatch(Utils::WorkerPool* pool, const std::function<void(ConstraintBatch&)>& task,
+			const std::function<void(ContactBlock&)>& blockTask = nullptr);
+		void gather();
+		void scatter();
+		/// <summary>
+		/// Write impulses back to contacts for next step and retire them
+		/// </summary>
+		void store();
+		void warmStart(ConstraintBatch& batch);
+		void warmStart(ContactBlock& block);
+		void warmStart(ArticulatedContact& contact);
+		/// <summary>
+		/// Soft coefficients of each lane from separation at current positions
+		/// </summary>
+		void soften(ConstraintBatch& batch, const real& h, const bool& useBias);
+		void soften(ArticulatedContact& contact, const real& h, const bool& useBias);
+		/// <summary>
+		/// Target velocity and soft coefficients of one contact from its separation at current positions
+		/// </summary>
+		void soften(const ContactConstraintPoint& ccp, const real& h, const bool& useBias, real& target, real& restitution, real& massScale, real& impulseScale)const;
+		void restitute(ConstraintBatch& batch);
+		void restitute(ArticulatedContact& contact);
+		/// <summary>
+		/// Union bodies of packed contacts into islands and number them densely
+		/// </summary>
+		void buildIslands();
+		/// <summary>
+		/// Collect residuals of the iteration, retire converged islands and deactivate batches left without work.
+		/// Returns true when every island converged.
+		/// </summary>
+		/// <param name="iterations"></param>
+		/// <returns></returns>
+		bool converge(const int& iterations);
+		void correct(ContactConstraintPoint& ccp);
+		/// <summary>
+		/// Slot of relation in table, or the empty slot where it would be inserted
+		/// </summary>
+		size_t probe(const RelationID& relation)const;
+		static size_t hash(const RelationID& relation);
+		ContactPair& fetch(const RelationID& relation);
+		void erase(const RelationID& relation);
+		void rehash(const size_t& capacity);
+		void compact();
+
+		static constexpr size_t Empty = SIZE_MAX;
+		std::vector<ContactPair> m_pairs;
+		//relation and index of its pair, index Empty means unused slot. capacity is a power of two
+		std::vector<std::pair<RelationID, size_t>> m_table;
+
+		ConstraintGraph m_graph;
+		Softness m_softness;
+		//contacts and slots of their bodies by color
+		std::vector<std::vector<std::tuple<ContactConstraintPoint*, int32_t, int32_t>>> m_colored;
+		std::vector<ConstraintBatch> m_batches;
+		//batches of color i are [m_colorBatches[i], m_colorBatches[i + 1])
+		std::vector<size_t> m_colorBatches;
+		std::vector<std::vector<ContactBlock>> m_coloredBlocks;
+		std::vector<ContactBlock> m_blocks;
+		//blocks of color i are [m_colorBlocks[i], m_colorBlocks[i + 1])
+		std::vector<size_t> m_colorBlocks;
+		std::vector<ArticulatedContact> m_articulated;
+		//velocities gathered once per solve and scattered back after all iterations
+		std::vector<real> m_velocityX;
+		std::vector<real> m_velocityY;
+		std::vector<real> m_angularVelocity;
+
+		//union find parent by body slot, then dense island of each root
+		std::vector<int32_t> m_islandParent;
+		std::vector<int32_t> m_islandIndex;
+		std::vector<real> m_islandResidual;
+		//iterations an island took, zero while still iterating
+		std::vector<int> m_islandIterations;
+		IterationStatistics m_statistics;
 	};
 	
 }
@@ -0,0 +1,54 @@
+#ifndef PHYSICS2D_CONSTRAINT_GRAPH_H
+#define PHYSICS2D_CONSTRAINT_GRAPH_H
+#include <cstdint>
+
+#include "include/dynamics/body.h"
+namespace Physics2D
+{
+	/// <summary>
+	/// Bodies linked by constraints, rebuilt every step.
+	/// Bodies get dense slots in order of first use. Slot 0 stands for no body.
+	/// Constraints are colored greedily so that constraints of one color share no movable body and can be solved in parallel.
+	/// Bodies without inverse mass and inertia never change velocity, they take part in no conflict.
+	/// </summary>
+	class ConstraintGraph
+	{
+	public:
+		static constexpr size_t MaxColors = 64;
+		/// <summary>
+		/// Color of constraints that could not be colored, they have to be solved one by one
+		/// </summary>
+		static constexpr size_t Overflow = MaxColors;
+		/// <summary>
+		/// Forget all bodies and colors, bodies is the expected number of distinct bodies
+		/// </summary>
+		/// <param name="bodies"></param>
+		void reset(const size_t& bodies);
+		/// <summary>
+		/// Slot of body, body is appended when first seen. Null body is slot 0.
+		/// </summary>
+		/// <param name="body"></param>
+		/// <returns></returns>
+		int32_t slot(Body* body);
+		/// <summary>
+		/// Lowest color that neither movable body of the constraint is using yet, or Overflow
+		/// </summary>
+		/// <param name="slotA"></param>
+		/// <param name="slotB"></param>
+		/// <returns></returns>
+		size_t color(const int32_t& slotA, const int32_t& slotB);
+		bool movable(const int32_t& slot)const;
+		const std::vector<Body*>& bodies()const;
+	private:
+		size_t probe(Body* body)const;
+		void rehash(const size_t& capacity);
+
+		std::vector<Body*> m_bodies;
+		//colors used by body in each slot, one bit per color
+		std::vector<uint64_t> m_colors;
+		std::vector<bool> m_movable;
+		//open addressing from body to its slot, at most half full
+		std::vector<std::pair<Body*, int32_t>> m_table;
+	};
+}
+#endif
@@ -0,0 +1,100 @@
+#ifndef PHYSICS2D_CONSTRAINT_ROPE_H
+#define PHYSICS2D_CONSTRAINT_ROPE_H
+#include "include/dynamics/body.h"
+#include "include/dynamics/constraint/softness.h"
+namespace Physics2D
+{
+	/// <summary>
+	/// Bodies linked one after another, link i joins bodies[i] and bodies[i + 1].
+	/// A null body at either end fixes that end to the world, its local point is then a world point.
+	/// Empty anchors mean centers of bodies, empty lengths mean distances at creation.
+	/// </summary>
+	struct RopePrimitive
+	{
+		std::vector<Body*> bodies;
+		//anchor of link i on bodies[i]
+		std::vector<Vector2> localPointsA;
+		//anchor of link i on bodies[i + 1]
+		std::vector<Vector2> localPointsB;
+		std::vector<real> lengths;
+		real biasFactor = 0.2;
+		//rigid links push as well as pull, otherwise a link only acts while stretched
+		bool rigid = false;
+	};
+	/// <summary>
+	/// Chain of distance links solved directly instead of by iterations.
+	/// Links only share bodies with their neighbours, so the effective mass matrix is tridiagonal
+	/// and the impulses making every link exact are found in O(n) by one forward and one backward sweep.
+	/// </summary>
+	class Rope
+	{
+	public:
+		Rope(const RopePrimitive& primitive);
+		/// <summary>
+		/// Anchors, normals and the tridiagonal effective mass from current positions, once per step or substep
+		/// </summary>
+		/// <param name="dt"></param>
+		void prepare(const real& dt);
+		/// <summary>
+		/// Impulses of all links at once so that relative velocities along links meet their bias
+		/// </summary>
+		/// <param name="dt"></param>
+		void solveVelocity(const real& dt);
+		/// <summary>
+		/// One linearized projection of link lengths after positions were integrated.
+		/// Does nothing unless position correction is set.
+		/// </summary>
+		/// <param name="dt"></param>
+		void solvePosition(const real& dt);
+		void setSoftness(const Softness& softness);
+		void clearSoftness();
+		void setPositionCorrection(const bool& positionCorrection);
+		const RopePrimitive& primitive()const;
+		/// <summary>
+		/// Current length of link minus its rest length
+		/// </summary>
+		/// <param name="link"></param>
+		/// <returns></returns>
+		real stretch(const size_t& link)const;
+	private:
+		static constexpr real LinearSlop = 0.005;
+		static constexpr real MaxLinearCorrection = 0.2;
+		struct Link
+		{
+			Vector2 ra;
+			Vector2 rb;
+			//from anchor on bodies[i] to anchor on bodies[i + 1]
+			Vector2 normal;
+			real bias = 0;
+			real accumulatedImpulse = 0;
+			//row of the effective mass matrix, lower couples with link i - 1
+			real diagonal = 0;
+			real lower = 0;
+			bool active = false;
+			//slack link left out of this solve because it would push
+			bool clamped = false;
+		};
+		Vector2 anchorA(const size_t& link)const;
+		Vector2 anchorB(const size_t& link)const;
+		/// <summary>
+		/// Fill anchors, normals and matrix rows of m_links from current positions, returns position errors in m_rhs
+		/// </summary>
+		void linearize();
+		/// <summary>
+		/// Solve the tridiagonal system of active, unclamped links in place of m_rhs, other rows give zero
+		/// </summary>
+		void factorSolve();
+		void apply(const size_t& link, const real& impulse);
+		static void massOf(Body* body, real& im, real& ii);
+
+		RopePrimitive m_primitive;
+		std::vector<Link> m_links;
+		//scratch of the sweeps
+		std::vector<real> m_rhs;
+		std::vector<real> m_upper;
+		bool m_soft = false;
+		bool m_positionCorrection = false;
+		Softness m_softness;
+	};
+}
+#endif
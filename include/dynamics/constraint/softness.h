@@ -0,0 +1,31 @@
+#ifndef PHYSICS2D_CONSTRAINT_SOFTNESS_H
+#define PHYSICS2D_CONSTRAINT_SOFTNESS_H
+#include "include/common/common.h"
+#include "include/math/math.h"
+namespace Physics2D
+{
+	/// <summary>
+	/// Coefficients of a soft constraint, a damped spring of hertz frequency and zeta damping ratio stepped with h.
+	/// Velocity impulse = -effectiveMass * massScale * (jv + biasRate * C) - impulseScale * accumulatedImpulse.
+	/// Default is a rigid constraint without position correction.
+	/// </summary>
+	struct Softness
+	{
+		real biasRate = 0;
+		real massScale = 1;
+		real impulseScale = 0;
+
+		static Softness make(const real& hertz, const real& zeta, const real& h)
+		{
+			if (hertz == 0)
+				return Softness();
+
+			const real omega = 2 * Constant::Pi * hertz;
+			const real a1 = 2 * zeta + h * omega;
+			const real a2 = h * omega * a1;
+			const real a3 = 1 / (1 + a2);
+			return { omega / a1, a2 * a3, a3 };
+		}
+	};
+}
+#endif
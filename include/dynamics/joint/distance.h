@@ -9,6 +9,8 @@ namespace Physics2D
 		Vector2 localPointA;
 		Vector2 targetPoint;
 		Vector2 normal;
+		//anchor relative to center of bodyA, updated by prepare
+		Vector2 ra;
 		real biasFactor = 0.2;
 		real bias = 0;
 		real minDistance = 0;
@@ -16,7 +18,7 @@ namespace Physics2D
 		real effectiveMass = 0;
 		real accumulatedImpulse = 0;
 	};
-	class DistanceJoint : public Joint
+	class DistanceJoint final : public Joint
 	{
 	public:
 		DistanceJoint()
@@ -37,6 +39,7 @@ namespace Physics2D
 			Body* bodyA = m_primitive.bodyA;
 			Vector2 pa = bodyA->toWorldPoint(m_primitive.localPointA);
 			Vector2 ra = pa - bodyA->position();
+			m_primitive.ra = ra;
 			Vector2 pb = m_primitive.targetPoint;
 			real im_a = m_primitive.bodyA->inverseMass();
 			real ii_a = m_primitive.bodyA->inverseInertia();
@@ -61,25 +64,31 @@ namespace Physics2D
 				m_primitive.bias = 0;
 				return;
 			}
-			real rn_a = m_primitive.normal.dot(ra);
+			real rn_a = ra.cross(m_primitive.normal);
 			m_primitive.effectiveMass = 1.0 / (im_a + ii_a * rn_a * rn_a);
- 			m_primitive.bias = m_primitive.biasFactor * c / dt;
+ 			m_primitive.bias = m_soft ? m_softness.biasRate * c : m_positionCorrection ? 0 : m_primitive.biasFactor * c / dt;
+			if (m_soft)
+			{
+				m_primitive.accumulatedImpulse = 0;
+				return;
+			}
 
 			Vector2 impulse = m_primitive.accumulatedImpulse * m_primitive.normal;
-			//m_primitive.bodyA->applyImpulse(impulse, ra);
-			
+			bodyA->applyImpulse(impulse, ra);
 		}
 		void solveVelocity(const real& dt) override
 		{
-			if (m_primitive.bias == 0)
+			if (m_primitive.normal.isOrigin())
 				return ;
-			Vector2 ra = m_primitive.bodyA->toWorldPoint(m_primitive.localPointA) - m_primitive.bodyA->position();
+			Vector2 ra = m_primitive.ra;
 			Vector2 va = m_primitive.bodyA->velocity() + Vector2::crossProduct(m_primitive.bodyA->angularVelocity(), ra);
 
 			Vector2 dv = va;
 			real jv = m_primitive.normal.dot(dv);
 			real jvb = -jv + m_primitive.bias;
 			real lambda_n = m_primitive.effectiveMass * jvb;
+			if (m_soft)
+				lambda_n = lambda_n * m_softness.massScale - m_softness.impulseScale * m_primitive.accumulatedImpulse;
 
 			real oldImpulse = m_primitive.accumulatedImpulse;
 			m_primitive.accumulatedImpulse = Math::max(oldImpulse + lambda_n, 0);
@@ -90,13 +99,49 @@ namespace Physics2D
 		}
 		void solvePosition(const real& dt) override
 		{
-			
+			if (!m_positionCorrection)
+				return;
+			Body* bodyA = m_primitive.bodyA;
+			Vector2 pa = bodyA->toWorldPoint(m_primitive.localPointA);
+			Vector2 ra = pa - bodyA->position();
+			Vector2 error = m_primitive.targetPoint - pa;
+			real length = error.length();
+			if (realEqual(length, 0))
+				return;
+
+			Vector2 normal = error / length;
+			real c = 0;
+			if (length < m_primitive.minDistance)
+			{
+				c = m_primitive.minDistance - length;
+				normal.negate();
+			}
+			else if (length > m_primitive.maxDistance)
+				c = length - m_primitive.maxDistance;
+			c = Math::clamp(c - LinearSlop, 0, MaxLinearCorrection);
+			if (c == 0)
+				return;
+
+			real im_a = bodyA->inverseMass();
+			real ii_a = bodyA->inverseInertia();
+			real rn_a = ra.cross(normal);
+			Vector2 impulse = c / (im_a + ii_a * rn_a * rn_a) * normal;
+			bodyA->position() += im_a * impulse;
+			bodyA->rotation() += ii_a * ra.cross(impulse);
 		}
 
 		DistanceJointPrimitive primitive()const
 		{
 			return m_primitive;
 		}
+		Body* bodyA()const override
+		{
+			return m_primitive.bodyA;
+		}
+		Body* bodyB()const override
+		{
+			return nullptr;
+		}
 	private:
 		DistanceJointPrimitive m_primitive;
 		real m_factor = 0.6;
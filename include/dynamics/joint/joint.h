@@ -1,6 +1,7 @@
 #ifndef PHYSICS2D_DYNAMICS_JOINT_JOINT_H
 #define PHYSICS2D_DYNAMICS_JOINT_JOINT_H
 #include "include/dynamics/body.h"
+#include "include/dynamics/constraint/softness.h"
 namespace Physics2D
 {
 	enum class JointType
@@ -19,15 +20,56 @@ namespace Physics2D
 	{
 	public:
 		Joint(){}
+		/// <summary>
+		/// Compute anchors, effective mass and bias from current positions. Called once per step in iteration mode,
+		/// where the impulse accumulated last step is applied again as warm start.
+		/// </summary>
+		/// <param name="dt"></param>
 		virtual void prepare(const real& dt) = 0;
 		virtual void solveVelocity(const real& dt) = 0;
 		virtual void solvePosition(const real& dt) = 0;
+		/// <summary>
+		/// Bodies linked by joint, null when that end is fixed to the world
+		/// </summary>
+		/// <returns></returns>
+		virtual Body* bodyA()const = 0;
+		virtual Body* bodyB()const = 0;
 		JointType type()const
 		{
 			return m_type;
 		}
+		/// <summary>
+		/// Solve as soft constraint instead of bias factor. prepare is called once per substep, so impulses do not carry over.
+		/// </summary>
+		/// <param name="softness"></param>
+		void setSoftness(const Softness& softness)
+		{
+			m_soft = true;
+			m_softness = softness;
+		}
+		void clearSoftness()
+		{
+			m_soft = false;
+		}
+		/// <summary>
+		/// Correct position error in solvePosition instead of by bias velocity
+		/// </summary>
+		/// <param name="positionCorrection"></param>
+		void setPositionCorrection(const bool& positionCorrection)
+		{
+			m_positionCorrection = positionCorrection;
+		}
 	protected:
+		//error ignored by position correction and largest step of one iteration
+		static constexpr real LinearSlop = 0.005;
+		static constexpr real MaxLinearCorrection = 0.2;
+		static constexpr real AngularSlop = 0.035;
+		static constexpr real MaxAngularCorrection = 0.14;
+
 		JointType m_type;
+		bool m_soft = false;
+		bool m_positionCorrection = false;
+		Softness m_softness;
 	};
 	
 }
@@ -16,7 +16,7 @@ namespace Physics2D
 		real accumulatedImpulse = 0;
 		real maxForce = 20000;
 	};
-	class MouseJoint : public Joint
+	class MouseJoint final : public Joint
 	{
 	public:
 		MouseJoint()
@@ -49,6 +49,14 @@ namespace Physics2D
 		{
 
 		}
+		Body* bodyA()const override
+		{
+			return m_primitive.bodyA;
+		}
+		Body* bodyB()const override
+		{
+			return nullptr;
+		}
 	private:
 		MouseJointPrimitive m_primitive;
 		real m_factor = 0.5;
@@ -9,6 +9,8 @@ namespace Physics2D
 		Vector2 localPointA;
 		Vector2 targetPoint;
 		Vector2 normal;
+		//anchor relative to center of bodyA, updated by prepare
+		Vector2 ra;
 		real damping = 0;
 		real stiffness = 1;
 		real bias = 0;
@@ -16,7 +18,7 @@ namespace Physics2D
 		real effectiveMass = 0;
 		real accumulatedImpulse = 0;
 	};
-	class PointJoint : public Joint
+	class PointJoint final : public Joint
 	{
 	public:
 		PointJoint()
@@ -38,27 +40,36 @@ namespace Physics2D
 			Body* bodyA = m_primitive.bodyA;
 			Vector2 pa = bodyA->toWorldPoint(m_primitive.localPointA);
 			Vector2 ra = pa - bodyA->position();
+			m_primitive.ra = ra;
 			Vector2 pb = m_primitive.targetPoint;
 			real im_a = m_primitive.bodyA->inverseMass();
 			real ii_a = m_primitive.bodyA->inverseInertia();
 			Vector2 error = pb - pa;
 			m_primitive.normal = error.normal();
 			real c = Math::max(error.length() - 0.01, 0);
-			real rn_a = m_primitive.normal.dot(ra);
+			real rn_a = ra.cross(m_primitive.normal);
 			m_primitive.effectiveMass = 1.0 / (im_a + ii_a * rn_a * rn_a);
-			m_primitive.bias = m_primitive.biasFactor * c / dt;
-			//m_primitive.bodyA->applyImpulse(m_primitive.accumulatedImpulse * m_primitive.normal, ra);
-			
+			m_primitive.bias = m_soft ? m_softness.biasRate * c : m_positionCorrection ? 0 : m_primitive.biasFactor * c / dt;
+			if (m_soft)
+			{
+				m_primitive.accumulatedImpulse = 0;
+				return;
+			}
+			bodyA->applyImpulse(m_primitive.accumulatedImpulse * m_primitive.normal, ra);
 		}
 		void solveVelocity(const real& dt) override
 		{
-			Vector2 ra = m_primitive.bodyA->toWorldPoint(m_primitive.localPointA) - m_primitive.bodyA->position();
+			if (m_primitive.bodyA == nullptr)
+				return;
+			Vector2 ra = m_primitive.ra;
 			Vector2 va = m_primitive.bodyA->velocity() + Vector2::crossProduct(m_primitive.bodyA->angularVelocity(), ra);
 
 			Vector2 dv = va;
 			real jv = m_primitive.normal.dot(dv);
 			real jvb = -jv + m_primitive.bias;
 			real lambda_n = m_primitive.effectiveMass * jvb;
+			if (m_soft)
+				lambda_n = lambda_n * m_softness.massScale - m_softness.impulseScale * m_primitive.accumulatedImpulse;
 
 			real oldImpulse = m_primitive.accumulatedImpulse;
 			m_primitive.accumulatedImpulse = Math::max(oldImpulse + lambda_n, 0);
@@ -69,13 +80,37 @@ namespace Physics2D
 		}
 		void solvePosition(const real& dt) override
 		{
-			
-			
+			if (!m_positionCorrection || m_primitive.bodyA == nullptr)
+				return;
+			Body* bodyA = m_primitive.bodyA;
+			Vector2 pa = bodyA->toWorldPoint(m_primitive.localPointA);
+			Vector2 ra = pa - bodyA->position();
+			Vector2 error = m_primitive.targetPoint - pa;
+			real length = error.length();
+			real c = Math::min(length - 0.01, MaxLinearCorrection);
+			if (c <= 0)
+				return;
+
+			Vector2 normal = error / length;
+			real im_a = bodyA->inverseMass();
+			real ii_a = bodyA->inverseInertia();
+			real rn_a = ra.cross(normal);
+			Vector2 impulse = c / (im_a + ii_a * rn_a * rn_a) * normal;
+			bodyA->position() += im_a * impulse;
+			bodyA->rotation() += ii_a * ra.cross(impulse);
 		}
 		PointJointPrimitive primitive()const
 		{
 			return m_primitive;
 		}
+		Body* bodyA()const override
+		{
+			return m_primitive.bodyA;
+		}
+		Body* bodyB()const override
+		{
+			return nullptr;
+		}
 	private:
 		PointJointPrimitive m_primitive;
 		real m_factor = 0.22;
@@ -7,7 +7,7 @@ namespace Physics2D
 	{
 		
 	};
-	class PulleyJoint : public Joint
+	class PulleyJoint final : public Joint
 	{
 	public:
 		PulleyJoint()
@@ -36,6 +36,14 @@ namespace Physics2D
 		{
 
 		}
+		Body* bodyA()const override
+		{
+			return nullptr;
+		}
+		Body* bodyB()const override
+		{
+			return nullptr;
+		}
 	private:
 		PulleyJointPrimitive m_primitive;
 	};
@@ -7,7 +7,7 @@ namespace Physics2D
 	{
 		
 	};
-	class RevoluteJoint : public Joint
+	class RevoluteJoint final : public Joint
 	{
 	public:
 		RevoluteJoint()
@@ -35,6 +35,14 @@ namespace Physics2D
 		{
 
 		}
+		Body* bodyA()const override
+		{
+			return nullptr;
+		}
+		Body* bodyB()const override
+		{
+			return nullptr;
+		}
 	private:
 		RevoluteJointPrimitive m_primitive;
 	};
@@ -10,6 +10,7 @@ namespace Physics2D
 		real referenceRotation = 0;
 		real effectiveMass = 0;
 		real bias = 0;
+		real accumulatedImpulse = 0;
 	};
 	struct OrientationJointPrimitive
 	{
@@ -18,8 +19,9 @@ namespace Physics2D
 		real referenceRotation = 0;
 		real bias = 0;
 		real effectiveMass = 0;
+		real accumulatedImpulse = 0;
 	};
-	class RotationJoint: public Joint
+	class RotationJoint final : public Joint
 	{
 	public:
 		RotationJoint()
@@ -44,12 +46,24 @@ namespace Physics2D
 			real inv_dt = 1.0 / dt;
 			m_primitive.effectiveMass = 1.0 / (ii_a + ii_b);
 			real c = m_primitive.bodyA->rotation() - m_primitive.bodyB->rotation() - m_primitive.referenceRotation;
-			m_primitive.bias = -m_factor * inv_dt * c;
+			m_primitive.bias = m_soft ? -m_softness.biasRate * c : m_positionCorrection ? 0 : -m_factor * inv_dt * c;
+			if (m_soft)
+			{
+				m_primitive.accumulatedImpulse = 0;
+				return;
+			}
+			m_primitive.bodyA->angularVelocity() += ii_a * m_primitive.accumulatedImpulse;
+			m_primitive.bodyB->angularVelocity() -= ii_b * m_primitive.accumulatedImpulse;
 		}
 		void solveVelocity(const real& dt) override
 		{
+			if (m_primitive.bodyA == nullptr || m_primitive.bodyB == nullptr)
+				return;
 			real dw = m_primitive.bodyA->angularVelocity() - m_primitive.bodyB->angularVelocity();
 			real impulse = m_primitive.effectiveMass * (-dw + m_primitive.bias);
+			if (m_soft)
+				impulse = impulse * m_softness.massScale - m_softness.impulseScale * m_primitive.accumulatedImpulse;
+			m_primitive.accumulatedImpulse += impulse;
 
 			m_primitive.bodyA->angularVelocity() += m_primitive.bodyA->inverseInertia() * impulse;
 			m_primitive.bodyB->angularVelocity() -= m_primitive.bodyB->inverseInertia() * impulse;
@@ -57,17 +71,35 @@ namespace Physics2D
 		}
 		void solvePosition(const real& dt) override
 		{
+			if (!m_positionCorrection || m_primitive.bodyA == nullptr || m_primitive.bodyB == nullptr)
+				return;
+			real ii_a = m_primitive.bodyA->inverseInertia();
+			real ii_b = m_primitive.bodyB->inverseInertia();
+			real c = m_primitive.bodyA->rotation() - m_primitive.bodyB->rotation() - m_primitive.referenceRotation;
+			if (std::fabs(c) < AngularSlop || realEqual(ii_a + ii_b, 0))
+				return;
 
+			real impulse = -Math::clamp(c, -MaxAngularCorrection, MaxAngularCorrection) / (ii_a + ii_b);
+			m_primitive.bodyA->rotation() += ii_a * impulse;
+			m_primitive.bodyB->rotation() -= ii_b * impulse;
 		}
 		RotationJointPrimitive primitive()const
 		{
 			return m_primitive;
 		}
+		Body* bodyA()const override
+		{
+			return m_primitive.bodyA;
+		}
+		Body* bodyB()const override
+		{
+			return m_primitive.bodyB;
+		}
 	private:
 		RotationJointPrimitive m_primitive;
 		real m_factor = 0.2;
 	};
-	class OrientationJoint : public Joint
+	class OrientationJoint final : public Joint
 	{
 
 	public:
@@ -100,32 +132,62 @@ namespace Physics2D
 			{
 				c = 0;
 				bodyA->rotation() = targetRotation;
+				m_primitive.accumulatedImpulse = 0;
 				return;
 			}
 			if (fuzzyRealEqual(c, -2 * Constant::Pi, 0.1))
 			{
 				c = 0;
 				bodyA->rotation() = targetRotation;
+				m_primitive.accumulatedImpulse = 0;
+				return;
+			}
+			m_primitive.bias = m_soft ? m_softness.biasRate * c : m_positionCorrection ? 0 : m_factor * inv_dt * c;
+			if (m_soft)
+			{
+				m_primitive.accumulatedImpulse = 0;
 				return;
 			}
-			m_primitive.bias = m_factor * inv_dt * c;
+			bodyA->angularVelocity() += ii_a * m_primitive.accumulatedImpulse;
 		}
 		void solveVelocity(const real& dt) override
 		{
+			if (m_primitive.bodyA == nullptr)
+				return;
 			real dw = m_primitive.bodyA->angularVelocity();
 			real impulse = m_primitive.effectiveMass * (-dw + m_primitive.bias);
+			if (m_soft)
+				impulse = impulse * m_softness.massScale - m_softness.impulseScale * m_primitive.accumulatedImpulse;
+			m_primitive.accumulatedImpulse += impulse;
 
 			m_primitive.bodyA->angularVelocity() += m_primitive.bodyA->inverseInertia() * impulse;
 
 		}
 		void solvePosition(const real& dt) override
 		{
+			if (!m_positionCorrection || m_primitive.bodyA == nullptr)
+				return;
+			Body* bodyA = m_primitive.bodyA;
+			real targetRotation = (m_primitive.targetPoint - bodyA->position()).theta();
+			real c = targetRotation - bodyA->rotation() - m_primitive.referenceRotation;
+			//a full turn is snapped in prepare
+			if (std::fabs(c) < AngularSlop || std::fabs(c) > Constant::Pi || realEqual(bodyA->inverseInertia(), 0))
+				return;
 
+			bodyA->rotation() += Math::clamp(c, -MaxAngularCorrection, MaxAngularCorrection);
 		}
 		OrientationJointPrimitive primitive()const
 		{
 			return m_primitive;
 		}
+		Body* bodyA()const override
+		{
+			return m_primitive.bodyA;
+		}
+		Body* bodyB()const override
+		{
+			return nullptr;
+		}
 	private:
 		OrientationJointPrimitive m_primitive;
 		real m_factor = 1.0;
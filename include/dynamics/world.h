@@ -7,18 +7,59 @@
 #include "include/dynamics/joint/joints.h"
 #include "include/utils/random.h"
 #include "include/dynamics/constraint/contact.h"
+#include "include/dynamics/constraint/graph.h"
+#include "include/dynamics/constraint/rope.h"
+#include "include/dynamics/articulation.h"
+#include "include/collision/continuous/ccd.h"
+#include "include/utils/worker_pool.h"
+#include <unordered_map>
 namespace Physics2D
 {
     class World
     {
 		public:
+            /// <summary>
+            /// Iteration: stepVelocity, contact solve and stepPosition are called by user, constraints correct position by bias factor.
+            /// Substep: substep integrates and solves several times per step, with one relaxed iteration of soft constraints each.
+            /// </summary>
+            enum class SolverMode
+            {
+                Iteration,
+                Substep
+            };
             World() : m_gravity(0, -1), m_linearVelocityDamping(0.9), m_angularVelocityDamping(0.9), m_bias(0.8),
     			m_enableGravity(true), m_linearVelocityThreshold(0.02), m_angularVelocityThreshold(0.02), m_airFrictionCoefficient(0.7),
     			m_velocityIteration(1), m_positionIteration(1)
             {}
             ~World();
-            void stepVelocity(const real& dt);
-            void stepPosition(const real& dt);
+            /// <summary>
+            /// Integrate forces into velocities, then solve joints and ropes.
+            /// Joints are colored by shared bodies, joints of one color are spread over pool when given
+            /// </summary>
+            /// <param name="dt"></param>
+            /// <param name="pool"></param>
+            void stepVelocity(const real& dt, Utils::WorkerPool* pool = nullptr);
+            /// <summary>
+            /// Integrate positions, then run position iterations over joints and the contacts of contactMaintainer when given.
+            /// Bullets and bodies fast enough to pass through a shape in one step are swept and stop at their impacts,
+            /// which are resolved in time order across the world.
+            /// </summary>
+            /// <param name="dt"></param>
+            /// <param name="pool"></param>
+            /// <param name="contactMaintainer"></param>
+            void stepPosition(const real& dt, Utils::WorkerPool* pool = nullptr, ContactMaintainer* contactMaintainer = nullptr);
+            /// <summary>
+            /// Whole step in substep mode, after contacts of this step are added to contactMaintainer
+            /// </summary>
+            /// <param name="dt"></param>
+            /// <param name="contactMaintainer"></param>
+            /// <param name="pool"></param>
+            void substep(const real& dt, ContactMaintainer& contactMaintainer, Utils::WorkerPool* pool = nullptr);
+            /// <summary>
+            /// Whole step without constraints. Bodies and articulations are integrated as in stepVelocity and stepPosition,
+            /// bullets and fast bodies are swept, velocities of dynamic bodies and bullets are damped.
+            /// </summary>
+            /// <param name="dt"></param>
             void step(const real& dt);
             
 
@@ -53,6 +94,19 @@ namespace Physics2D
             PulleyJoint* createJoint(const PulleyJointPrimitive& primitive);
             RevoluteJoint* createJoint(const RevoluteJointPrimitive& primitive);
             OrientationJoint* createJoint(const OrientationJointPrimitive& primitive);
+            /// <summary>
+            /// Chain of links solved directly after the joints of each iteration, long ropes stay exact at any iteration count
+            /// </summary>
+            /// <param name="primitive"></param>
+            /// <returns></returns>
+            Rope* createRope(const RopePrimitive& primitive);
+            /// <summary>
+            /// Tree of links rooted at root, links are added through the returned articulation.
+            /// Articulations are integrated along with bodies, contacts reach them through ContactMaintainer.
+            /// </summary>
+            /// <param name="root"></param>
+            /// <returns></returns>
+            Articulation* createArticulation(Body* root);
 			
             real bias() const;
             void setBias(const real &bias);
@@ -63,13 +117,215 @@ namespace Physics2D
             real positionIteration() const;
             void setPositionIteration(const real &positionIteration);
 
+            /// <summary>
+            /// Joints correct position error in stepPosition instead of by bias velocity
+            /// </summary>
+            /// <returns></returns>
+            bool positionCorrection()const;
+            void setPositionCorrection(const bool& positionCorrection);
+
+            SolverMode solverMode()const;
+            void setSolverMode(const SolverMode& solverMode);
+
+            int substeps()const;
+            void setSubsteps(const int& substeps);
+
+            real jointHertz()const;
+            void setJointHertz(const real& jointHertz);
+
+            real jointDampingRatio()const;
+            void setJointDampingRatio(const real& jointDampingRatio);
+
             Integrator integrator()const;
             void setIntegrator(const Integrator& integrator);
 
+            /// <summary>
+            /// Broadphase of the bodies, optional. Fast bodies fit their leaves to the boxes they sweep through once per step
+            /// and take the bodies they may hit from it, without it they try every body they may hit.
+            /// </summary>
+            /// <returns></returns>
+            DBVH* broadphase()const;
+            void setBroadphase(DBVH* broadphase);
+
             std::vector<std::unique_ptr<Body>>& bodyList();
     	
             std::vector<std::unique_ptr<Joint>>& jointList();
+
+            std::vector<std::unique_ptr<Rope>>& ropeList();
+
+            std::vector<std::unique_ptr<Articulation>>& articulationList();
         private:
+            void integrateVelocity(const real& h);
+            /// <summary>
+            /// Sweep bullets and fast bodies through h in time order of their impacts, then integrate the rest of h of every body
+            /// </summary>
+            /// <param name="h"></param>
+            /// <param name="pool"></param>
+            void integratePosition(const real& h, Utils::WorkerPool* pool = nullptr);
+            /// <summary>
+            /// Time of impact of a swept body within h. Versions of both bodies at the time it was found tell whether it still holds.
+            /// </summary>
+            struct ImpactEvent
+            {
+                real time = 0;
+                Body* body = nullptr;
+                Body* other = nullptr;
+                size_t version = 0;
+                size_t otherVersion = 0;
+                PointPair closest;
+                bool operator<(const ImpactEvent& other) const
+                {
+                    //reversed for min-heap
+                    return time > other.time;
+                }
+            };
+            /// <summary>
+            /// Body moved apart from the others while impacts are resolved: the time of h its pose is at,
+            /// and a version bumped on every impact that changes its velocity
+            /// </summary>
+            struct Motion
+            {
+                static constexpr size_t None = static_cast<size_t>(-1);
+                real time = 0;
+                size_t version = 0;
+                int impacts = 0;
+                bool swept = false;
+                //index in m_requests while its impacts are to be found again
+                size_t request = None;
+            };
+            /// <summary>
+            /// Buffers of one worker finding impacts
+            /// </summary>
+            struct Scan
+            {
+                std::vector<Body*> candidates;
+                std::vector<DBVH::Node*> nodes;
+            };
+            /// <summary>
+            /// Pop impacts of m_events in time order and resolve them.
+            /// An impact bumps versions of its bodies, so their other events are dropped when popped,
+            /// then events are found again for them and for bullets whose sweeps cross their new ones.
+            /// With pool, impacts that share no body and can not reach each other before the end of h are resolved together.
+            /// Results are then deterministic for any number of workers, but not always identical to a run without pool:
+            /// impacts passed on to third bodies wait for the next batch instead of strict time order.
+            /// </summary>
+            /// <param name="h"></param>
+            /// <param name="pool"></param>
+            void solveImpacts(const real& h, Utils::WorkerPool* pool);
+            /// <summary>
+            /// Sweep body through the rest of h from now on. Bullets are swept against all other bodies,
+            /// other fast bodies against static and kinematic ones. With a broadphase its leaf is fitted to the sweep.
+            /// </summary>
+            /// <param name="body"></param>
+            /// <param name="h"></param>
+            void addSwept(Body* body, const real& h);
+            /// <summary>
+            /// Find the impacts of a swept body again from now on, at the next schedule
+            /// </summary>
+            /// <param name="body"></param>
+            /// <param name="now"></param>
+            void request(Body* body, const real& now);
+            /// <summary>
+            /// Find the earliest impact of every requested body and push them to m_events in order of request.
+            /// Bodies are only read while impacts are found, so requests are spread over pool.
+            /// </summary>
+            /// <param name="h"></param>
+            /// <param name="pool"></param>
+            void schedule(const real& h, Utils::WorkerPool* pool);
+            /// <summary>
+            /// Earliest impact of a swept body after now, each pair is swept from the later time of its two bodies.
+            /// Event is left without other if there is none.
+            /// </summary>
+            /// <param name="body"></param>
+            /// <param name="now"></param>
+            /// <param name="h"></param>
+            /// <param name="scan"></param>
+            /// <param name="event"></param>
+            void findImpact(Body* body, const real& now, const real& h, Scan& scan, ImpactEvent& event)const;
+            /// <summary>
+            /// Move bodies of event to its time and apply the impact. Others that are not tracked are placed there and put back.
+            /// Touches the bodies of event and their motions only.
+            /// </summary>
+            /// <param name="event"></param>
+            void resolve(const ImpactEvent& event);
+            /// <summary>
+            /// Request impacts again for bodies of a resolved impact, and for bullets that may now meet them earlier
+            /// </summary>
+            /// <param name="event"></param>
+            /// <param name="h"></param>
+            void reschedule(const ImpactEvent& event, const real& h);
+            /// <summary>
+            /// Box bodies of event can reach until the end of h, after the impact changed their velocities
+            /// </summary>
+            /// <param name="event"></param>
+            /// <param name="h"></param>
+            /// <returns></returns>
+            AABB reachable(const ImpactEvent& event, const real& h);
+            /// <summary>
+            /// Event shares no body with any event of m_batch and can not reach them before the end of h
+            /// </summary>
+            /// <param name="event"></param>
+            /// <param name="region">box event can reach</param>
+            /// <returns></returns>
+            bool independent(const ImpactEvent& event, const AABB& region)const;
+            Motion& track(Body* body);
+            /// <summary>
+            /// Move a tracked body along its velocity to time of h
+            /// </summary>
+            /// <param name="body"></param>
+            /// <param name="time"></param>
+            void moveTo(Body* body, const real& time);
+            real timeOf(Body* body)const;
+            size_t versionOf(Body* body)const;
+            /// <summary>
+            /// Impulses of an impact with restitution and friction between body and other, both placed at the time of impact.
+            /// Points come from the manifold of the pair, normal from their closest points.
+            /// </summary>
+            /// <param name="body"></param>
+            /// <param name="other"></param>
+            /// <param name="closest"></param>
+            /// <param name="offset">how far other was moved to the time of impact</param>
+            void impact(Body* body, Body* other, const PointPair& closest, const Vector2& offset);
+            /// <summary>
+            /// Body moves farther than half of its smallest extent in h
+            /// </summary>
+            /// <param name="body"></param>
+            /// <param name="h"></param>
+            /// <returns></returns>
+            bool isFast(Body* body, const real& h)const;
+            /// <summary>
+            /// Bodies body may hit while sweeping through region, in candidates of scan.
+            /// Leaves of the broadphase are where the others were last fitted, so a slow body moving into region from beyond
+            /// the margin of its leaf is left to discrete contact.
+            /// </summary>
+            /// <param name="body"></param>
+            /// <param name="region"></param>
+            /// <param name="scan"></param>
+            void findCandidates(Body* body, const AABB& region, Scan& scan)const;
+            void clearForces();
+            /// <summary>
+            /// Joints of one color grouped by type, each group is solved by one loop of direct calls.
+            /// Types without a group of their own are kept in others and called through Joint.
+            /// </summary>
+            struct JointBatch
+            {
+                std::vector<DistanceJoint*> distance;
+                std::vector<PointJoint*> point;
+                std::vector<RotationJoint*> rotation;
+                std::vector<OrientationJoint*> orientation;
+                std::vector<Joint*> others;
+                void clear();
+                size_t size()const;
+            };
+            void colorJoints();
+            /// <summary>
+            /// Call task with every joint as pointer to its concrete type, color by color
+            /// </summary>
+            /// <typeparam name="Task"></typeparam>
+            /// <param name="pool"></param>
+            /// <param name="task"></param>
+            template<typename Task>
+            void solveJoints(Utils::WorkerPool* pool, const Task& task);
 
             Vector2 m_gravity;
             real m_linearVelocityDamping;
@@ -85,8 +341,36 @@ namespace Physics2D
     		bool m_enableGravity;
             std::vector<std::unique_ptr<Body>> m_bodyList;
             std::vector<std::unique_ptr<Joint>> m_jointList;
+            std::vector<std::unique_ptr<Rope>> m_ropeList;
+            std::vector<std::unique_ptr<Articulation>> m_articulationList;
             Integrator m_integrator;
 
+            SolverMode m_solverMode = SolverMode::Iteration;
+            int m_substeps = 4;
+            real m_jointHertz = 60;
+            real m_jointDampingRatio = 2;
+            bool m_positionCorrection = false;
+
+            ConstraintGraph m_jointGraph;
+            //joints by color, last one holds joints that could not be colored
+            std::vector<JointBatch> m_jointColors;
+            //bodies swept in this integration, and the static and kinematic bodies all of them are swept against
+            std::vector<Body*> m_fastBodies;
+            std::vector<Body*> m_obstacles;
+            //bodies that have left the start of h, pending impacts and impacts resolved together with their reach
+            std::unordered_map<Body*, Motion> m_motions;
+            std::vector<ImpactEvent> m_events;
+            std::vector<ImpactEvent> m_batch;
+            std::vector<AABB> m_batchRegions;
+            //bodies whose impacts are to be found with the time to start from, what was found for them and buffers per worker
+            std::vector<std::pair<Body*, real>> m_requests;
+            std::vector<ImpactEvent> m_found;
+            std::vector<Scan> m_scans;
+            //leaves of the broadphase crossing the sweeps changed by an impact
+            std::vector<DBVH::Node*> m_nodes;
+            DBVH* m_broadphase = nullptr;
+            static constexpr int MaxImpacts = 4;
+
     		
     		
     };
@@ -165,6 +165,21 @@ namespace Physics2D
 		Vector2 calculateEllipseProjectionPoint(const real& a, const real& b, const Vector2& direction);
 		Vector2 calculateCapsuleProjectionPoint(const real& width, const real& height, const Vector2& direction);
 		bool triangleContainsOrigin(const Vector2& a, const Vector2& b, const Vector2& c);
+		/// <summary>
+		/// Triangulate simple polygon by ear clipping. Winding and closing vertex of source are optional.
+		/// Return indices of source vertices, three per triangle in counter-clockwise order.
+		/// </summary>
+		/// <param name="vertices"></param>
+		/// <returns></returns>
+		std::vector<size_t> triangulate(const std::vector<Vector2>& vertices);
+		/// <summary>
+		/// Split simple polygon into convex polygons.
+		/// Triangulate first, then greedily remove diagonals while the merged polygon stays convex (Hertel-Mehlhorn).
+		/// Every result is counter-clockwise and closed by duplicating its first vertex.
+		/// </summary>
+		/// <param name="vertices"></param>
+		/// <returns></returns>
+		std::vector<std::vector<Vector2>> convexDecomposition(const std::vector<Vector2>& vertices);
 	};
 }
 #endif
@@ -2,6 +2,7 @@
 #define PHYSICS2D_SHAPE_H
 #include "include/math/linear/linear.h"
 #include "include/common/common.h"
+#include "include/collision/broadphase/static_tree.h"
 
 namespace Physics2D
 {
@@ -17,7 +18,10 @@ namespace Physics2D
             	Capsule,
                 Edge,
                 Curve,
-                Sector
+                Sector,
+                Compound,
+                Chain,
+                Heightfield
                 };
             Type type()const
             {
@@ -27,8 +31,21 @@ namespace Physics2D
             virtual ~Shape() {};
             virtual bool contains(const Vector2& point, const real& epsilon = Constant::GeometryEpsilon) = 0;
             virtual Vector2 center()const = 0;
+            /// <summary>
+            /// Rounding radius around the shape, every point within skin of the shape is solid.
+            /// Mass properties ignore it, so keep it small compared to the shape.
+            /// </summary>
+            real skin()const
+            {
+                return m_skin;
+            }
+            void setSkin(const real& skin)
+            {
+                m_skin = Math::max(skin, 0);
+            }
         protected:
             Type m_type;
+            real m_skin = 0;
     };
 
     /// <summary>
@@ -40,7 +57,24 @@ namespace Physics2D
 		std::shared_ptr<Shape> shape;
         Vector2 transform;
         real rotation = 0;
+        /// <summary>
+        /// Index of the last polygon support vertex, seeding the next hill-climbing search.
+        /// </summary>
+        mutable size_t supportIndex = 0;
+        /// <summary>
+        /// If set, support functions leave out the rounding radius and return the core shape.
+        /// Circle reduces to its center and capsule to its inner segment.
+        /// </summary>
+        bool core = false;
         Vector2 translate(const Vector2& source)const;
+        /// <summary>
+        /// Rounding radius left out by core, including skin and the radius of circle or capsule
+        /// </summary>
+        real radius()const;
+        /// <summary>
+        /// Place primitive given in local space of this primitive into the space of this primitive's parent
+        /// </summary>
+        ShapePrimitive compose(const ShapePrimitive& local)const;
     };
     class Point: public Shape
     {
@@ -58,6 +92,7 @@ namespace Physics2D
     };
     /// <summary>
     /// Convex polygon, not concave!
+    /// By convention the last vertex duplicates the first one to close the polygon.
     /// </summary>
     class Polygon: public Shape
     {
@@ -66,13 +101,19 @@ namespace Physics2D
             Polygon();
     	
             const std::vector<Vector2>& vertices() const;
+            /// <summary>
+            /// Outward unit normal of edge i -> i + 1, precomputed whenever vertices change.
+            /// </summary>
+            const std::vector<Vector2>& normals() const;
             void append(const std::initializer_list<Vector2>& vertices);
             void append(const Vector2& vertex);
             Vector2 center()const override;
             void scale(const real& factor) override;
             bool contains(const Vector2& point, const real& epsilon = Constant::GeometryEpsilon) override;
         protected:
+            void updateNormals();
             std::vector<Vector2> m_vertices;
+            std::vector<Vector2> m_normals;
     };
     class Rectangle: public Polygon
     {
@@ -216,6 +257,116 @@ namespace Physics2D
         real m_endRadian;
         real m_radius;
     };
+    /// <summary>
+    /// Rigid set of convex children, each placed by its own transform in local space of compound.
+    /// A static tree over the AABBs of children narrows down which children can touch.
+    /// Concave polygons are split into convex children by convex decomposition.
+    /// </summary>
+    class Compound : public Shape
+    {
+    public:
+        Compound();
+        bool contains(const Vector2& point, const real& epsilon = Constant::GeometryEpsilon) override;
+        void scale(const real& factor) override;
+        Vector2 center() const override;
+
+        void append(const std::shared_ptr<Shape>& shape, const Vector2& position = { 0, 0 }, const real& rotation = 0);
+        /// <summary>
+        /// Decompose concave polygon into convex polygons and append them as children.
+        /// Vertices are in local space of compound, winding and closing vertex are optional.
+        /// </summary>
+        /// <param name="vertices"></param>
+        void appendConcave(const std::vector<Vector2>& vertices);
+        void clear();
+        const std::vector<ShapePrimitive>& children()const;
+        const StaticTree& tree()const;
+    private:
+        void updateTree();
+        std::vector<ShapePrimitive> m_children;
+        StaticTree m_tree;
+    };
+    /// <summary>
+    /// Open polyline or closed loop of segments, mainly for terrain.
+    /// Solid side is on the left of the vertex order, so a counter-clockwise loop is solid inside like polygon.
+    /// Neighbor vertices of a segment are its ghost vertices, used to smooth collision across joints.
+    /// A static tree over segment AABBs keeps queries local.
+    /// </summary>
+    class Chain : public Shape
+    {
+    public:
+        struct Segment
+        {
+            Vector2 start;
+            Vector2 end;
+            std::optional<Vector2> previous;
+            std::optional<Vector2> next;
+        };
+        Chain();
+        bool contains(const Vector2& point, const real& epsilon = Constant::GeometryEpsilon) override;
+        void scale(const real& factor) override;
+        Vector2 center() const override;
+
+        void set(const std::vector<Vector2>& vertices, bool loop = false);
+        const std::vector<Vector2>& vertices()const;
+        bool loop()const;
+        size_t segmentCount()const;
+        Segment segment(const size_t& index)const;
+        const StaticTree& tree()const;
+    private:
+        void updateTree();
+        std::vector<Vector2> m_vertices;
+        bool m_loop = false;
+        StaticTree m_tree;
+    };
+    /// <summary>
+    /// Terrain sampled at regular intervals along x, sample i is at (left + i * spacing, heights[i]).
+    /// Solid side is below the heights. Column i is the segment between sample i and i + 1,
+    /// so columns touched by an AABB are found directly from its x range.
+    /// </summary>
+    class Heightfield : public Shape
+    {
+    public:
+        Heightfield();
+        bool contains(const Vector2& point, const real& epsilon = Constant::GeometryEpsilon) override;
+        void scale(const real& factor) override;
+        Vector2 center() const override;
+
+        void set(const std::vector<real>& heights, const real& spacing, const real& left = 0);
+        /// <summary>
+        /// Edit one sample in place for deformable ground. Bounds of heights are kept up to date.
+        /// </summary>
+        /// <param name="index"></param>
+        /// <param name="height"></param>
+        void setHeight(const size_t& index, const real& height);
+        const std::vector<real>& heights()const;
+        real spacing()const;
+        real left()const;
+        real right()const;
+        real minHeight()const;
+        real maxHeight()const;
+        Vector2 sample(const size_t& index)const;
+        size_t segmentCount()const;
+        /// <summary>
+        /// Segment of column, running from right to left to keep solid side on the left like chain.
+        /// </summary>
+        /// <param name="index"></param>
+        /// <returns></returns>
+        Chain::Segment segment(const size_t& index)const;
+        /// <summary>
+        /// Range [first, last) of columns overlapped by [minX, maxX] in local space.
+        /// </summary>
+        /// <param name="minX"></param>
+        /// <param name="maxX"></param>
+        /// <returns></returns>
+        std::tuple<size_t, size_t> columns(const real& minX, const real& maxX)const;
+    private:
+        void updateBounds();
+        std::vector<real> m_heights;
+        real m_spacing = 1;
+        real m_left = 0;
+        real m_minHeight = 0;
+        real m_maxHeight = 0;
+    };
 
 }
 #endif
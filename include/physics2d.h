@@ -4,6 +4,7 @@
 #include "include/collision/algorithm/sat.h"
 #include "include/collision/algorithm/gjk.h"
 #include "include/collision/detector.h"
+#include "include/collision/manifold_cache.h"
 #include "include/collision/collider.h"
 #include "include/common/common.h"
 #include "include/geometry/shape.h"
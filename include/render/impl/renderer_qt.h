@@ -466,6 +466,29 @@ namespace Physics2D
 				renderSector(painter, camera, shape, pen);
 				break;
 			}
+			case Shape::Type::Compound:
+			{
+				for (const ShapePrimitive& child : static_cast<const Compound*>(shape.shape.get())->children())
+					renderShape(painter, camera, shape.compose(child), pen);
+				break;
+			}
+			case Shape::Type::Chain:
+			{
+				const Chain* chain = static_cast<const Chain*>(shape.shape.get());
+				for (size_t i = 0; i < chain->segmentCount(); i++)
+				{
+					const Chain::Segment segment = chain->segment(i);
+					renderLine(painter, camera, shape.translate(segment.start), shape.translate(segment.end), pen);
+				}
+				break;
+			}
+			case Shape::Type::Heightfield:
+			{
+				const Heightfield* heightfield = static_cast<const Heightfield*>(shape.shape.get());
+				for (size_t i = 0; i < heightfield->segmentCount(); i++)
+					renderLine(painter, camera, shape.translate(heightfield->sample(i)), shape.translate(heightfield->sample(i + 1)), pen);
+				break;
+			}
 			default:
 				break;
 			}
@@ -0,0 +1,51 @@
+#ifndef PHYSICS2D_UTILS_WORKER_POOL_H
+#define PHYSICS2D_UTILS_WORKER_POOL_H
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "include/common/common.h"
+namespace Physics2D::Utils
+{
+	/// <summary>
+	/// Fixed set of persistent worker threads for data parallel loops.
+	/// The calling thread takes part as worker 0.
+	/// </summary>
+	class WorkerPool
+	{
+	public:
+		using Task = std::function<void(size_t begin, size_t end, size_t worker)>;
+
+		explicit WorkerPool(size_t threads = std::thread::hardware_concurrency());
+		~WorkerPool();
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+		/// <summary>
+		/// Number of workers, including the calling thread
+		/// </summary>
+		/// <returns></returns>
+		size_t size()const;
+		/// <summary>
+		/// Split [0, count) into contiguous ranges, one per worker, and block until all ranges are done.
+		/// Range of worker i is [count * i / n, count * (i + 1) / n), so the split only depends on count and worker number.
+		/// Not reentrant: task must not call forEach of the same pool.
+		/// </summary>
+		/// <param name="count"></param>
+		/// <param name="task"></param>
+		void forEach(const size_t& count, const Task& task);
+	private:
+		void run(size_t worker);
+
+		std::vector<std::thread> m_threads;
+		std::mutex m_mutex;
+		std::condition_variable m_start;
+		std::condition_variable m_done;
+		const Task* m_task = nullptr;
+		size_t m_count = 0;
+		size_t m_workers = 0;
+		size_t m_pending = 0;
+		size_t m_generation = 0;
+		bool m_stop = false;
+	};
+}
+#endif
@@ -1,5 +1,47 @@
 #include "include/collision/algorithm/clip.h"
 namespace Physics2D
 {
+	size_t ContactClipper::clip(Vector2* segment, const Vector2& normal, const real& offset)
+	{
+		const real distance0 = normal.dot(segment[0]) - offset;
+		const real distance1 = normal.dot(segment[1]) - offset;
+		Vector2 result[2];
+		size_t count = 0;
 
-}
\ No newline at end of file
+		if (distance0 <= 0)
+			result[count++] = segment[0];
+		if (distance1 <= 0)
+			result[count++] = segment[1];
+
+		//end points are on different sides, keep the intersection point
+		if (distance0 * distance1 < 0)
+			result[count++] = segment[0] + (segment[1] - segment[0]) * (distance0 / (distance0 - distance1));
+
+		for (size_t i = 0; i < count; i++)
+			segment[i] = result[i];
+		return count;
+	}
+
+	size_t ContactClipper::findIncidentEdge(const Vector2* normals, const size_t& count, const Vector2& normal)
+	{
+		size_t index = 0;
+		real min = Constant::Max;
+		for (size_t i = 0; i < count; i++)
+		{
+			const real dot = normals[i].dot(normal);
+			if (dot < min)
+			{
+				min = dot;
+				index = i;
+			}
+		}
+		return index;
+	}
+
+	uint32_t ContactClipper::feature(const size_t& edgeA, const size_t& edgeB, const size_t& side)
+	{
+		//top bit marks the feature as known, edges get 15 bits each
+		return 1u << 31 | static_cast<uint32_t>(side & 1) << 30 |
+			(static_cast<uint32_t>(edgeA) & 0x7FFF) << 15 | (static_cast<uint32_t>(edgeB) & 0x7FFF);
+	}
+}
@@ -1,4 +1,7 @@
 #include "include/collision/algorithm/gjk.h"
+#ifdef PHYSICS2D_SSE2
+#include <immintrin.h>
+#endif
 
 
 namespace Physics2D
@@ -111,36 +114,106 @@ namespace Physics2D
 		return std::make_tuple(found, simplex);
 	}
 
-	Simplex GJK::epa(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB, const Simplex& src,
-	                 const size_t& iteration, const real& epsilon)
+	std::tuple<Simplex, size_t> GJK::epa(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB, const Simplex& src,
+	                                     const size_t& iteration, const real& epsilon)
 	{
+		struct PolytopeEdge
+		{
+			size_t a = 0;
+			size_t b = 0;
+			Vector2 normal;
+			real distance = 0;
+			bool operator<(const PolytopeEdge& other) const
+			{
+				//reversed for min-heap
+				return distance > other.distance;
+			}
+		};
+
+		std::vector<Minkowski> polytope;
+		if (src.vertices.size() == 4)
+			polytope.assign(src.vertices.begin(), src.vertices.end() - 1);
+		else
+			polytope = src.vertices;
+
+		assert(polytope.size() >= 2);
+
+		real area = 0;
+		if (polytope.size() == 3)
+			area = (polytope[1].result - polytope[0].result).cross(polytope[2].result - polytope[0].result);
+
+		//degenerated triangle, keep the longest segment
+		if (polytope.size() == 3 && realEqual(area, 0))
+		{
+			size_t first = 0, second = 1;
+			real length = 0;
+			for (size_t i = 0; i < 3; i++)
+			{
+				const size_t j = (i + 1) % 3;
+				const real temp = (polytope[j].result - polytope[i].result).lengthSquare();
+				if (temp > length)
+				{
+					length = temp;
+					first = i;
+					second = j;
+				}
+			}
+			polytope = { polytope[first], polytope[second] };
+		}
+		const bool ccw = area >= 0;
+
+		std::vector<PolytopeEdge> heap;
+		auto push = [&](const size_t& a, const size_t& b)
+		{
+			const Vector2 edge = polytope[b].result - polytope[a].result;
+			if (edge.isOrigin())
+				return;
+			PolytopeEdge target;
+			target.a = a;
+			target.b = b;
+			target.normal = ccw ? Vector2(edge.y, -edge.x).normal() : Vector2(-edge.y, edge.x).normal();
+			target.distance = target.normal.dot(polytope[a].result);
+			heap.emplace_back(target);
+			std::push_heap(heap.begin(), heap.end());
+		};
+
+		for (size_t i = 0; i < polytope.size(); i++)
+			push(i, (i + 1) % polytope.size());
+
+		//segment contains origin, expand on both sides
+		if (polytope.size() == 2)
+			push(1, 0);
+
+		Simplex result;
+		if (heap.empty())
+		{
+			result.vertices = { polytope[0], polytope[1] };
+			return std::make_tuple(result, 0);
+		}
+
 		size_t iter = 0;
-		Simplex edge;
-		Simplex simplex = src;
-		Vector2 normal;
-		Minkowski p;
-		while (iter <= iteration)
+		while (iter < iteration)
 		{
+			const PolytopeEdge closest = heap.front();
 
-			auto [index1, index2] = findEdgeClosestToOrigin(simplex);
+			const Minkowski p = support(shapeA, shapeB, closest.normal);
+			const real projection = p.result.dot(closest.normal);
 
-			//fmt::print("closest edge: ({0}, {1}), ({2}, {3})\n", simplex.vertices[index1].result.x, simplex.vertices[index1].result.y, simplex.vertices[index2].result.x, simplex.vertices[index2].result.y);
-			normal = calculateDirectionByEdge(simplex.vertices[index1].result, simplex.vertices[index2].result, false).
-				normal();
-			
-			if (GeometryAlgorithm2D::isPointOnSegment(simplex.vertices[index1].result, simplex.vertices[index2].result, { 0, 0 }))
-				normal.negate();
-			
-			//new minkowski point
-			p = support(shapeA, shapeB, normal);
-
-			if (simplex.contains(p) || simplex.fuzzyContains(p, epsilon))
+			if (p == polytope[closest.a] || p == polytope[closest.b] ||
+				projection - closest.distance <= Math::max(epsilon * projection, Constant::GeometryEpsilon))
 				break;
 
-			simplex.insert(index1, p);
+			std::pop_heap(heap.begin(), heap.end());
+			heap.pop_back();
+
+			polytope.emplace_back(p);
+			push(closest.a, polytope.size() - 1);
+			push(polytope.size() - 1, closest.b);
 			iter++;
 		}
-		return simplex;
+		const PolytopeEdge& closest = heap.front();
+		result.vertices = { polytope[closest.a], polytope[closest.b] };
+		return std::make_tuple(result, iter);
 	}
 
 	PenetrationInfo GJK::dumpInfo(const PenetrationSource& source)
@@ -149,7 +222,7 @@ namespace Physics2D
 		Vector2 edge1 = source.a1 - source.b1;
 		Vector2 edge2 = source.a2 - source.b2;
 		Vector2 normal = calculateDirectionByEdge(edge1, edge2, false).normal();
-		real originToEdge = abs(normal.dot(edge1));
+		real originToEdge = std::abs(normal.dot(edge1));
 		result.normal = normal * -1;
 		result.penetration = originToEdge;
 		return result;
@@ -209,26 +282,15 @@ namespace Physics2D
 		{
 		case Shape::Type::Polygon:
 		{
-			const Polygon* polygon = dynamic_cast<const Polygon*>(shape.shape.get());
-			Vector2 p0 = polygon->vertices()[0];
-			real max = 0;
-			target = polygon->vertices()[0];
-			for (const Vector2& vertex : polygon->vertices())
-			{
-				real result = Vector2::dotProduct(vertex - p0, rot_dir);
-
-				if (max < result)
-				{
-					max = result;
-					target = vertex;
-				}
-			}
+			const Polygon* polygon = static_cast<const Polygon*>(shape.shape.get());
+			shape.supportIndex = findFarthestIndex(polygon, rot_dir, shape.supportIndex);
+			target = polygon->vertices()[shape.supportIndex];
 			break;
 		}
 		case Shape::Type::Circle:
 		{
-			const Circle* circle = dynamic_cast<const Circle*>(shape.shape.get());
-			return direction.normal() * circle->radius() + shape.transform;
+			//core of circle is its center, radius is added below
+			break;
 		}
 		case Shape::Type::Ellipse:
 		{
@@ -239,19 +301,25 @@ namespace Physics2D
 		case Shape::Type::Edge:
 		{
 			const Edge* edge = dynamic_cast<const Edge*>(shape.shape.get());
-			real dot1 = Vector2::dotProduct(edge->startPoint(), direction);
-			real dot2 = Vector2::dotProduct(edge->endPoint(), direction);
+			real dot1 = Vector2::dotProduct(edge->startPoint(), rot_dir);
+			real dot2 = Vector2::dotProduct(edge->endPoint(), rot_dir);
 			target = dot1 > dot2 ? edge->startPoint() : edge->endPoint();
 			break;
 		}
 		case Shape::Type::Point:
 		{
-			return dynamic_cast<const Point*>(shape.shape.get())->position();
+			target = static_cast<const Point*>(shape.shape.get())->position();
+			break;
 		}
 		case Shape::Type::Capsule:
 		{
-			const Capsule* capsule = dynamic_cast<const Capsule*>(shape.shape.get());
-			target = GeometryAlgorithm2D::calculateCapsuleProjectionPoint(capsule->width(), capsule->height(), rot_dir);
+			//core of capsule is the segment between centers of its caps, radius is added below
+			const Capsule* capsule = static_cast<const Capsule*>(shape.shape.get());
+			const real half = std::abs(capsule->width() - capsule->height()) * 0.5;
+			if (capsule->width() >= capsule->height())
+				target.set(rot_dir.x >= 0 ? half : -half, 0);
+			else
+				target.set(0, rot_dir.y >= 0 ? half : -half);
 			break;
 		}
 		case Shape::Type::Sector:
@@ -260,6 +328,56 @@ namespace Physics2D
 
 			break;
 		}
+		case Shape::Type::Compound:
+		{
+			//support of convex hull of all children
+			const Compound* compound = static_cast<const Compound*>(shape.shape.get());
+			real max = Constant::NegativeMin;
+			for (const ShapePrimitive& child : compound->children())
+			{
+				const Vector2 point = findFarthestPoint(shape.compose(child), direction);
+				const real dot = point.dot(direction);
+				if (dot > max)
+				{
+					max = dot;
+					target = point;
+				}
+			}
+			if (!shape.core && shape.shape->skin() > 0)
+				target += direction.normal() * shape.shape->skin();
+			return target;
+		}
+		case Shape::Type::Chain:
+		{
+			const Chain* chain = static_cast<const Chain*>(shape.shape.get());
+			real max = Constant::NegativeMin;
+			for (const Vector2& vertex : chain->vertices())
+			{
+				const real dot = vertex.dot(rot_dir);
+				if (dot > max)
+				{
+					max = dot;
+					target = vertex;
+				}
+			}
+			break;
+		}
+		case Shape::Type::Heightfield:
+		{
+			const Heightfield* heightfield = static_cast<const Heightfield*>(shape.shape.get());
+			real max = Constant::NegativeMin;
+			for (size_t i = 0; i < heightfield->heights().size(); i++)
+			{
+				const Vector2 vertex = heightfield->sample(i);
+				const real dot = vertex.dot(rot_dir);
+				if (dot > max)
+				{
+					max = dot;
+					target = vertex;
+				}
+			}
+			break;
+		}
 		default:
 			break;
 		}
@@ -267,9 +385,97 @@ namespace Physics2D
 		rot.setAngle(shape.rotation);
 		target = rot.multiply(target);
 		target += shape.transform;
+		if (!shape.core)
+		{
+			const real radius = shape.radius();
+			if (radius > 0)
+				target += direction.normal() * radius;
+		}
 		return target;
 	}
 
+	size_t GJK::findFarthestIndex(const Polygon* polygon, const Vector2& direction, const size_t& seed)
+	{
+		const std::vector<Vector2>& vertices = polygon->vertices();
+		assert(!vertices.empty());
+		//skip the duplicated closing vertex
+		const size_t count = vertices.size() > 1 ? vertices.size() - 1 : 1;
+
+		//small polygon: brute-force scan, keep the first vertex if projections are equal
+		if (count <= 16)
+		{
+			size_t index = 0;
+			real max = Constant::NegativeMin;
+			size_t i = 0;
+#ifdef PHYSICS2D_SSE2
+			const __m128d dx = _mm_set1_pd(direction.x);
+			const __m128d dy = _mm_set1_pd(direction.y);
+			const __m128d two = _mm_set1_pd(2.0);
+			__m128d current = _mm_set_pd(1.0, 0.0);
+			__m128d best = _mm_set1_pd(Constant::NegativeMin);
+			__m128d bestIndex = _mm_setzero_pd();
+			for (; i + 1 < count; i += 2)
+			{
+				const __m128d a = _mm_loadu_pd(&vertices[i].x);
+				const __m128d b = _mm_loadu_pd(&vertices[i + 1].x);
+				const __m128d dot = _mm_add_pd(_mm_mul_pd(_mm_unpacklo_pd(a, b), dx),
+				                               _mm_mul_pd(_mm_unpackhi_pd(a, b), dy));
+				const __m128d mask = _mm_cmpgt_pd(dot, best);
+				best = _mm_or_pd(_mm_and_pd(mask, dot), _mm_andnot_pd(mask, best));
+				bestIndex = _mm_or_pd(_mm_and_pd(mask, current), _mm_andnot_pd(mask, bestIndex));
+				current = _mm_add_pd(current, two);
+			}
+			alignas(16) real lanes[2];
+			alignas(16) real indices[2];
+			_mm_store_pd(lanes, best);
+			_mm_store_pd(indices, bestIndex);
+			for (size_t lane = 0; lane < 2; lane++)
+			{
+				const size_t laneIndex = static_cast<size_t>(indices[lane]);
+				if (lanes[lane] > max || (lanes[lane] == max && laneIndex < index))
+				{
+					max = lanes[lane];
+					index = laneIndex;
+				}
+			}
+#endif
+			for (; i < count; i++)
+			{
+				const real result = vertices[i].dot(direction);
+				if (result > max)
+				{
+					max = result;
+					index = i;
+				}
+			}
+			return index;
+		}
+
+		//large convex polygon: projection along the boundary is unimodal, climb towards the maximum.
+		//collinear vertices make plateaus, the seed may sit inside the minimum one, so equal projections
+		//are walked across in both directions and only a strictly greater one moves the result
+		size_t index = seed < count ? seed : 0;
+		real max = vertices[index].dot(direction);
+		for (const bool forward : { true, false })
+		{
+			size_t candidate = index;
+			for (size_t step = 1; step < count; step++)
+			{
+				candidate = forward ? (candidate + 1 == count ? 0 : candidate + 1)
+				                    : (candidate == 0 ? count - 1 : candidate - 1);
+				const real result = vertices[candidate].dot(direction);
+				if (result < max)
+					break;
+				if (result > max)
+				{
+					max = result;
+					index = candidate;
+				}
+			}
+		}
+		return index;
+	}
+
 	std::optional<Minkowski> GJK::adjustSimplex(Simplex& simplex, const size_t& closest_1, const size_t& closest_2)
 	{
 		switch (simplex.vertices.size())
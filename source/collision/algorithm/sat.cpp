@@ -67,15 +67,17 @@ namespace Physics2D
 		Circle* circleA = dynamic_cast<Circle*>(shapeA.shape.get());
 		Circle* circleB = dynamic_cast<Circle*>(shapeB.shape.get());
 		Vector2 ba = shapeA.transform - shapeB.transform;
-		real dp = circleA->radius() + circleB->radius();
+		const real radiusA = circleA->radius() + circleA->skin();
+		const real radiusB = circleB->radius() + circleB->skin();
+		real dp = radiusA + radiusB;
 		real length = ba.length();
 		if (length <= dp)
 		{
 			result.normal = ba.normal();
 			result.penetration = dp - length;
 			result.isColliding = true;
-			result.pointPair[0].pointA = shapeA.transform - circleA->radius() * result.normal;
-			result.pointPair[0].pointB = shapeB.transform + circleB->radius() * result.normal;
+			result.pointPair[0].pointA = shapeA.transform - radiusA * result.normal;
+			result.pointPair[0].pointB = shapeB.transform + radiusB * result.normal;
 		}
 		return result;
 	}
@@ -85,154 +87,207 @@ namespace Physics2D
 		assert(shapeA.shape->type() == Shape::Type::Circle);
 		assert(shapeB.shape->type() == Shape::Type::Polygon);
 
-		Circle* circleA = dynamic_cast<Circle*>(shapeA.shape.get());
-		Polygon* polygonB = dynamic_cast<Polygon*>(shapeB.shape.get());
+		const Circle* circleA = static_cast<const Circle*>(shapeA.shape.get());
+		const Polygon* polygonB = static_cast<const Polygon*>(shapeB.shape.get());
+		const std::vector<Vector2>& vertices = polygonB->vertices();
+		const std::vector<Vector2>& normals = polygonB->normals();
+		//skin of polygon rounds its core, so test the core against the circle grown by it
+		const real radiusA = circleA->radius() + circleA->skin();
+		const real radius = radiusA + polygonB->skin();
 
-		uint16_t collidingAxis = 0;
 		SATResult result;
-		
-		//circle sat test
-		
-		//finding circle axis
-		real minLength = Constant::Max;
-		Vector2 closest;
-		for (auto& elem : polygonB->vertices())
+
+		//find the face of maximum separation in local space of polygon
+		const Vector2 center = Matrix2x2(-shapeB.rotation).multiply(shapeA.transform - shapeB.transform);
+		real separation = Constant::NegativeMin;
+		size_t index = 0;
+		for (size_t i = 0; i < normals.size(); i++)
 		{
-			Vector2 vertex = shapeB.translate(elem);
-			real length = (vertex - shapeA.transform).lengthSquare();
-			if (minLength > length)
+			const real value = normals[i].dot(center - vertices[i]);
+			if (value > radius)
+				return result;
+			if (value > separation)
 			{
-				minLength = length;
-				closest = vertex;
+				separation = value;
+				index = i;
 			}
 		}
-		Vector2 normal = closest.normal();
 
-		ProjectedSegment segmentCircle = axisProjection(shapeA, circleA, normal);
-		ProjectedSegment segmentPolygon = axisProjection(shapeB, polygonB, normal);
-		
-		auto [finalSegment, length] = ProjectedSegment::intersect(segmentCircle, segmentPolygon);
-		
-		if (length > 0)
-			collidingAxis++;
+		const Vector2& v1 = vertices[index];
+		const Vector2& v2 = vertices[index + 1];
+		Vector2 normal = normals[index];
+		Vector2 closest = center - normal * separation;
 
-		if (result.penetration > length)
+		//center is outside, check vertex regions of reference face
+		if (separation > 0)
 		{
-			result.penetration = length;
-			result.normal = normal;
-		}
-		ProjectedPoint circlePoint, polygonPoint;
-		circlePoint = segmentCircle.max == finalSegment.max ? finalSegment.max : finalSegment.min;
-		polygonPoint = segmentPolygon.max == finalSegment.max ? finalSegment.max : finalSegment.min;
-		
-		ProjectedSegment segment;
-		bool onPolygon = false;
-		
-		//polygon sat test
-		for(int i = 0;i < polygonB->vertices().size() - 1;i++)
-		{
-			Vector2 v1 = shapeB.translate(polygonB->vertices()[i]);
-			Vector2 v2 = shapeB.translate(polygonB->vertices()[i + 1]);
-			Vector2 edge = v1 - v2;
-			Vector2 normal = edge.perpendicular().normal();
-
-
-			ProjectedSegment segmentC = axisProjection(shapeA, circleA, normal);
-			ProjectedSegment segmentP = axisProjection(shapeB, polygonB, normal);
-
-			auto [tempSegment, len] = ProjectedSegment::intersect(segmentC, segmentP);
-			if (len > 0)
-				collidingAxis++;
-
-			if(result.penetration > len && len > 0)
+			if ((center - v1).dot(v2 - v1) <= 0)
 			{
-				result.penetration = len;
-				result.normal = normal;
-				segment = tempSegment;
-				circlePoint = segmentC.max == tempSegment.max ? tempSegment.max : tempSegment.min;
+				if ((center - v1).lengthSquare() > radius * radius)
+					return result;
+				normal = (center - v1).normal();
+				closest = v1;
+			}
+			else if ((center - v2).dot(v1 - v2) <= 0)
+			{
+				if ((center - v2).lengthSquare() > radius * radius)
+					return result;
+				normal = (center - v2).normal();
+				closest = v2;
 			}
-			
 		}
-		if (collidingAxis == polygonB->vertices().size())
-			result.isColliding = true;
-		
-		result.pointPair[0].pointA = circlePoint.vertex;
-		result.pointPair[0].pointB = circlePoint.vertex + -result.normal * result.penetration;
-
 
+		result.normal = Matrix2x2(shapeB.rotation).multiply(normal);
+		result.penetration = radius - normal.dot(center - closest);
+		result.pointPair[0].pointA = shapeA.transform - radiusA * result.normal;
+		result.pointPair[0].pointB = shapeB.translate(closest) + polygonB->skin() * result.normal;
+		result.contactsCount = 1;
+		result.isColliding = true;
 		return result;
 	}
 
-	SATResult SAT::polygonVsPolygon(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB)
+	SATResult SAT::polygonVsPolygon(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB, const real& margin)
 	{
 		assert(shapeA.shape->type() == Shape::Type::Polygon);
 		assert(shapeB.shape->type() == Shape::Type::Polygon);
 
-		Polygon* polyA = dynamic_cast<Polygon*>(shapeA.shape.get());
-		Polygon* polyB = dynamic_cast<Polygon*>(shapeB.shape.get());
-		
-		SATResult result;
+		const Polygon* polyA = static_cast<const Polygon*>(shapeA.shape.get());
+		const Polygon* polyB = static_cast<const Polygon*>(shapeB.shape.get());
+		const ConvexOutline outlineA{ polyA->vertices().data(), polyA->normals().data(), polyA->normals().size(), polyA->skin() };
+		const ConvexOutline outlineB{ polyB->vertices().data(), polyB->normals().data(), polyB->normals().size(), polyB->skin() };
+		return outlineVsOutline(shapeA, outlineA, shapeB, outlineB, false, margin);
+	}
 
-		auto test = [](const ShapePrimitive& polygonA, const ShapePrimitive& polygonB)
-		{
-			Polygon* polyA = dynamic_cast<Polygon*>(polygonA.shape.get());
-			Polygon* polyB = dynamic_cast<Polygon*>(polygonB.shape.get());
-			
-			Vector2 finalNormal;
-			real minLength = Constant::Max;
-			int collidingAxis = 0;
-			ProjectedSegment segment;
-
-			ProjectedPoint targetAPoint, targetBPoint;
-			for(int i = 0;i < polyA->vertices().size() - 1;i++)
-			{
-				Vector2 v1 = polygonA.translate(polyA->vertices()[i]);
-				Vector2 v2 = polygonA.translate(polyA->vertices()[i + 1]);
-				Vector2 edge = v1 - v2;
-				Vector2 normal = edge.perpendicular().normal();
+	SATResult SAT::polygonVsSegment(const ShapePrimitive& shapeA, const Vector2& start, const Vector2& end, const bool& segmentReference, const real& margin)
+	{
+		assert(shapeA.shape->type() == Shape::Type::Polygon);
+
+		const Polygon* polyA = static_cast<const Polygon*>(shapeA.shape.get());
+		const ConvexOutline outlineA{ polyA->vertices().data(), polyA->normals().data(), polyA->normals().size(), polyA->skin() };
+
+		//segment as a polygon of two opposite edges
+		const Vector2 normal = Vector2(end.y - start.y, start.x - end.x).normal();
+		const Vector2 vertices[3] = { start, end, start };
+		const Vector2 normals[2] = { normal, -normal };
+		const ConvexOutline outlineB{ vertices, normals, segmentReference ? size_t(1) : size_t(2) };
+		return outlineVsOutline(shapeA, outlineA, ShapePrimitive(), outlineB, segmentReference, margin);
+	}
 
-				ProjectedSegment segmentA = axisProjection(polygonA, polyA, normal);
-				ProjectedSegment segmentB = axisProjection(polygonB, polyB, normal);
+	SATResult SAT::circleVsSegment(const ShapePrimitive& shapeA, const Vector2& start, const Vector2& end)
+	{
+		assert(shapeA.shape->type() == Shape::Type::Circle);
 
-				auto [finalSegment, length] = ProjectedSegment::intersect(segmentA, segmentB);
-				if (length > 0)
-					collidingAxis++;
+		const real radius = shapeA.radius();
+		SATResult result;
 
-				ProjectedPoint polyAPoint, polyBPoint;
-				polyAPoint = segmentA.max == finalSegment.max ? finalSegment.max : finalSegment.min;
-				polyBPoint = segmentB.max == finalSegment.max ? finalSegment.max : finalSegment.min;
-				
+		const Vector2 closest = GeometryAlgorithm2D::pointToLineSegment(start, end, shapeA.transform);
+		const Vector2 diff = shapeA.transform - closest;
+		const real length = diff.length();
+		if (length > radius)
+			return result;
+
+		//center lies on segment, fall back to segment normal
+		result.normal = realEqual(length, 0) ? Vector2(end.y - start.y, start.x - end.x).normal() : diff / length;
+		result.penetration = radius - length;
+		result.pointPair[0].pointA = shapeA.transform - radius * result.normal;
+		result.pointPair[0].pointB = closest;
+		result.contactsCount = 1;
+		result.isColliding = true;
+		return result;
+	}
 
-				if(minLength > length)
+	SATResult SAT::outlineVsOutline(const ShapePrimitive& shapeA, const ConvexOutline& outlineA, const ShapePrimitive& shapeB, const ConvexOutline& outlineB, const bool& referenceB, const real& margin)
+	{
+		SATResult result;
+
+		//find the edge normal of outline 1 that separates outline 2 the most, in local space of outline 2
+		auto findMaxSeparation = [](const ShapePrimitive& shape1, const ConvexOutline& outline1, const ShapePrimitive& shape2, const ConvexOutline& outline2)
+		{
+			const Matrix2x2 rotation(shape1.rotation - shape2.rotation);
+			const Vector2 translation = Matrix2x2(-shape2.rotation).multiply(shape1.transform - shape2.transform);
+			real maxSeparation = Constant::NegativeMin;
+			size_t index = 0;
+			for (size_t i = 0; i < outline1.count; i++)
+			{
+				const Vector2 normal = rotation.multiply(outline1.normals[i]);
+				const Vector2 vertex = rotation.multiply(outline1.vertices[i]) + translation;
+				real separation = Constant::Max;
+				for (size_t j = 0; j < outline2.count; j++)
+					separation = Math::min(separation, normal.dot(outline2.vertices[j] - vertex));
+
+				if (separation > maxSeparation)
 				{
-					minLength = length;
-					finalNormal = normal;
-					targetAPoint = polyAPoint;
-					targetBPoint = polyBPoint;
+					maxSeparation = separation;
+					index = i;
 				}
 			}
-
-			return std::make_tuple(finalNormal, minLength, collidingAxis, targetAPoint, targetBPoint);
+			return std::make_tuple(maxSeparation, index);
 		};
 
-		auto [normal1, length1, axis1, polyAPoint1, polyBPoint1] = test(shapeA, shapeB);
-		auto [normal2, length2, axis2, polyBPoint2, polyAPoint2] = test(shapeB, shapeA);
-		if ((axis1 + axis2) == polyA->vertices().size() + polyB->vertices().size() - 2)
-			result.isColliding = true;
-
-		if(length1 < length2)
+		//outlines are rounded by their radius, cores may be apart by their sum and still touch.
+		//speculative points are kept up to margin beyond that
+		const real radius = outlineA.radius + outlineB.radius;
+		const real reach = radius + margin;
+		auto [separationA, edgeA] = referenceB ? std::make_tuple(Constant::NegativeMin, size_t(0)) : findMaxSeparation(shapeA, outlineA, shapeB, outlineB);
+		if (separationA > reach)
+			return result;
+		auto [separationB, edgeB] = findMaxSeparation(shapeB, outlineB, shapeA, outlineA);
+		if (separationB > reach)
+			return result;
+
+		//prefer outline A as reference unless outline B is clearly better, to avoid flip-flopping
+		const bool flip = referenceB || separationB > separationA + Constant::GeometryEpsilon;
+		const ShapePrimitive& reference = flip ? shapeB : shapeA;
+		const ShapePrimitive& incident = flip ? shapeA : shapeB;
+		const ConvexOutline& outlineReference = flip ? outlineB : outlineA;
+		const ConvexOutline& outlineIncident = flip ? outlineA : outlineB;
+		const size_t edge = flip ? edgeB : edgeA;
+
+		const Vector2 refNormal = Matrix2x2(reference.rotation).multiply(outlineReference.normals[edge]);
+		const size_t incidentEdge = ContactClipper::findIncidentEdge(outlineIncident.normals, outlineIncident.count, Matrix2x2(-incident.rotation).multiply(refNormal));
+
+		Vector2 segment[2] = { incident.translate(outlineIncident.vertices[incidentEdge]), incident.translate(outlineIncident.vertices[incidentEdge + 1]) };
+		const Vector2 v1 = reference.translate(outlineReference.vertices[edge]);
+		const Vector2 v2 = reference.translate(outlineReference.vertices[edge + 1]);
+		const Vector2 tangent = (v2 - v1).normal();
+		//middle of the shorter edge, tells the side of a lone point
+		const Vector2 middle = (v2 - v1).lengthSquare() < (segment[1] - segment[0]).lengthSquare() ?
+			(v1 + v2) * 0.5 : (segment[0] + segment[1]) * 0.5;
+
+		//clip incident edge by side planes of reference edge
+		if (ContactClipper::clip(segment, -tangent, -tangent.dot(v1)) < 2)
+			return result;
+		if (ContactClipper::clip(segment, tangent, tangent.dot(v2)) < 2)
+			return result;
+
+		const real frontOffset = refNormal.dot(v1);
+		result.normal = flip ? refNormal : -refNormal;
+		result.penetration = margin > 0 ? Constant::NegativeMin : 0;
+		for (const Vector2& point : segment)
 		{
-			result.penetration = length1;
-			result.normal = normal1;
-			//do clipping
+			const real separation = refNormal.dot(point) - frontOffset;
+			if (separation > reach)
+				continue;
+
+			//move both core points out to the rounded surfaces
+			PointPair& pair = result.pointPair[result.contactsCount++];
+			const Vector2 projected = point - refNormal * separation;
+			pair.pointA = (flip ? point : projected) - result.normal * outlineA.radius;
+			pair.pointB = (flip ? projected : point) + result.normal * outlineB.radius;
+			result.penetration = Math::max(result.penetration, radius - separation);
 		}
-		else
+		result.isColliding = result.contactsCount > 0;
+
+		//points are told apart by their order along a tangent of the pair, not by which shape is reference
+		const Vector2 axis = result.normal.perpendicular();
+		const size_t edgeOfA = flip ? incidentEdge : edge;
+		const size_t edgeOfB = flip ? edge : incidentEdge;
+		for (size_t i = 0; i < result.contactsCount; i++)
 		{
-			result.penetration = length2;
-			result.normal = normal2;
-			//do clipping
+			const real position = axis.dot(result.pointPair[i].pointA);
+			const real other = result.contactsCount == 2 ? axis.dot(result.pointPair[1 - i].pointA) : axis.dot(middle);
+			result.pointPair[i].feature = ContactClipper::feature(edgeOfA, edgeOfB, position < other ? 0 : 1);
 		}
-
 		return result;
 	}
 
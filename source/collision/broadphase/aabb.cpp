@@ -1,4 +1,5 @@
 #include "include/collision/broadphase/aabb.h"
+#include "include/geometry/shape.h"
 
 
 #include "include/collision/algorithm/gjk.h"
@@ -149,7 +150,52 @@ namespace Physics2D
 			aabb.height = p2.y * 2.0;
 			break;
 		}
+		case Shape::Type::Compound:
+		{
+			const Compound* compound = static_cast<const Compound*>(shape.shape.get());
+			ShapePrimitive local;
+			local.shape = shape.shape;
+			local.rotation = shape.rotation;
+			bool first = true;
+			for (const ShapePrimitive& child : compound->children())
+			{
+				const AABB box = fromShape(local.compose(child));
+				aabb = first ? box : unite(aabb, box);
+				first = false;
+			}
+			break;
+		}
+		case Shape::Type::Chain:
+		{
+			//rotated box of the root of segment tree, avoids walking every vertex
+			const Chain* chain = static_cast<const Chain*>(shape.shape.get());
+			if (chain->tree().nodes().empty())
+				break;
+			const AABB& root = chain->tree().nodes()[0].aabb;
+			const real c = std::abs(Math::cosx(shape.rotation));
+			const real s = std::abs(Math::sinx(shape.rotation));
+			aabb.position = Matrix2x2(shape.rotation).multiply(root.position);
+			aabb.width = c * root.width + s * root.height;
+			aabb.height = s * root.width + c * root.height;
+			break;
+		}
+		case Shape::Type::Heightfield:
+		{
+			const Heightfield* heightfield = static_cast<const Heightfield*>(shape.shape.get());
+			const Vector2 center = heightfield->center();
+			const real width = heightfield->right() - heightfield->left();
+			const real height = heightfield->maxHeight() - heightfield->minHeight();
+			const real c = std::abs(Math::cosx(shape.rotation));
+			const real s = std::abs(Math::sinx(shape.rotation));
+			aabb.position = Matrix2x2(shape.rotation).multiply(center);
+			aabb.width = c * width + s * height;
+			aabb.height = s * width + c * height;
+			break;
+		}
 		}
+		//capsule takes its skin from support points already
+		if (shape.shape->type() != Shape::Type::Capsule)
+			aabb.expand(shape.shape->skin() * 2);
 		aabb.position += shape.transform;
 		aabb.expand(factor);
 		return aabb;
@@ -58,31 +58,10 @@ namespace Physics2D
 	{
 		if (node == nullptr)
 			return;
-		AABB aabb = AABB::fromBody(node->pair.body);
+		AABB aabb = node->pair.aabb;
 		aabb.expand(m_leafFactor);
 		node->pair.aabb = aabb;
 
-		auto getCost = [&](Node* target, const AABB& aabb)
-		{
-			Node* lowCostNode = nullptr;
-			real costValue = Constant::Max;
-			for (auto const& [key, val] : m_leaves)
-			{
-				assert(val != nullptr);
-				if(val == target)
-					continue;
-				real cost = 0;
-				totalCost(val, aabb, cost);
-				if (costValue > cost)
-				{
-					costValue = cost;
-					lowCostNode = val;
-				}
-			}
-
-			return lowCostNode;
-		};
-
 		if (m_root == nullptr)
 		{
 			m_root = node;
@@ -98,16 +77,11 @@ namespace Physics2D
 
 		if (m_root->isRoot())
 		{
-			auto target = getCost(node, aabb);
+			Node* target = sibling(aabb);
 			merge(target, node);
 			balance(m_root);
 
-			for (auto const& [key, val] : m_leaves)
-			{
-				if (val == node)
-					continue;
-				update(val);
-			}
+			update(target);
 		}
 	}
 
@@ -120,25 +94,6 @@ namespace Physics2D
 		aabb.expand(m_leafFactor);
 		Pair pair(aabb, body);
 		
-		auto getCost = [&](const AABB& aabb)
-		{
-			Node* lowCostNode = nullptr;
-			real costValue = Constant::Max;
-			for (auto const& [key, val] : m_leaves)
-			{
-				assert(val != nullptr);
-				real cost = 0;
-				totalCost(val, aabb, cost);
-				if(costValue > cost)
-				{
-					costValue = cost;
-					lowCostNode = val;
-				}
-			}
-
-			return lowCostNode;
-		};
-
 		if (m_root == nullptr)
 		{
 			m_root = new Node(pair);
@@ -155,7 +110,7 @@ namespace Physics2D
 
 		if (m_root->isRoot())
 		{
-			auto target = getCost(pair.aabb);
+			Node* target = sibling(pair.aabb);
 			merge(target, pair);
 			
 			balance(m_root);
@@ -166,6 +121,11 @@ namespace Physics2D
 		}
 	}
 	void DBVH::update(Body* body)
+	{
+		assert(body != nullptr);
+		update(body, AABB::fromBody(body));
+	}
+	void DBVH::update(Body* body, const AABB& aabb)
 	{
 		assert(body != nullptr);
 
@@ -174,11 +134,12 @@ namespace Physics2D
 			return;
 		
 		
-		AABB thin = AABB::fromBody(body);
+		AABB thin = aabb;
 		thin.expand(0.1);
 		if(!thin.isSubset(iter->second->pair.aabb))
 		{
 			Node* node = extract(body);
+			node->pair.aabb = aabb;
 			insert(node);
 		}
 
@@ -312,6 +273,12 @@ namespace Physics2D
 		if (abs(leftHeight - rightHeight) <= 1)
 			return;
 
+		//rotation keeps the leaves under the top node, only the two nodes swapped need to be refitted, lower one first
+		auto refit = [](Node* lower, Node* upper)
+		{
+			lower->pair.aabb = AABB::unite(lower->left->pair.aabb, lower->right->pair.aabb);
+			upper->pair.aabb = AABB::unite(upper->left->pair.aabb, upper->right->pair.aabb);
+		};
 		auto LL = [&](Node* node)
 		{
 			if (node == nullptr || node->isRoot())
@@ -330,6 +297,7 @@ namespace Physics2D
 
 				parent->parent = node;
 				m_root = node;
+				refit(parent, node);
 				return;
 			}
 			Node* parent = node->parent;
@@ -347,6 +315,7 @@ namespace Physics2D
 
 			parent->left = right;
 			right->parent = parent;
+			refit(parent, node);
 		};
 		auto RR = [&](Node* node)
 		{
@@ -367,6 +336,7 @@ namespace Physics2D
 				parent->parent = node;
 
 				m_root = node;
+				refit(parent, node);
 				return;
 			}
 			
@@ -385,6 +355,7 @@ namespace Physics2D
 
 			parent->right = left;
 			left->parent = parent;
+			refit(parent, node);
 		};
 		if (leftHeight > rightHeight) //left unbalance
 		{
@@ -487,14 +458,20 @@ namespace Physics2D
 		return AABB::unite(node->pair.aabb, aabb).surfaceArea() - node->pair.aabb.surfaceArea();
 	}
 
-	void DBVH::totalCost(Node* node, const AABB& aabb, real& cost)const
+	DBVH::Node* DBVH::sibling(const AABB& aabb) const
 	{
-		if (node == nullptr)
-			return;
-
-		const real temp = deltaCost(node, aabb);
-		cost += temp;
-		totalCost(node->parent, aabb, cost);
+		//descend to the child growing least, O(depth) instead of costing every leaf
+		Node* node = m_root;
+		while (node != nullptr && !node->isLeaf())
+		{
+			if (node->left == nullptr || node->right == nullptr)
+			{
+				node = node->left != nullptr ? node->left : node->right;
+				continue;
+			}
+			node = deltaCost(node->left, aabb) <= deltaCost(node->right, aabb) ? node->left : node->right;
+		}
+		return node;
 	}
 
 	void DBVH::Node::separate(Node* node)
@@ -0,0 +1,84 @@
+#include "include/collision/broadphase/static_tree.h"
+
+namespace Physics2D
+{
+	void StaticTree::build(const std::vector<AABB>& boxes)
+	{
+		m_nodes.clear();
+		if (boxes.empty())
+			return;
+
+		m_nodes.reserve(boxes.size() * 2 - 1);
+		std::vector<size_t> indices(boxes.size());
+		for (size_t i = 0; i < indices.size(); i++)
+			indices[i] = i;
+		build(indices, 0, indices.size(), boxes);
+	}
+
+	void StaticTree::query(const AABB& aabb, std::vector<size_t>& result) const
+	{
+		if (m_nodes.empty())
+			return;
+
+		std::vector<int> stack;
+		stack.reserve(32);
+		stack.emplace_back(0);
+		while (!stack.empty())
+		{
+			const Node& node = m_nodes[stack.back()];
+			stack.pop_back();
+			if (!node.aabb.collide(aabb))
+				continue;
+
+			if (node.isLeaf())
+			{
+				result.emplace_back(node.index);
+				continue;
+			}
+			stack.emplace_back(node.right);
+			stack.emplace_back(node.left);
+		}
+	}
+
+	const std::vector<StaticTree::Node>& StaticTree::nodes() const
+	{
+		return m_nodes;
+	}
+
+	void StaticTree::clear()
+	{
+		m_nodes.clear();
+	}
+
+	int StaticTree::build(std::vector<size_t>& indices, const size_t& begin, const size_t& end, const std::vector<AABB>& boxes)
+	{
+		const int current = static_cast<int>(m_nodes.size());
+		m_nodes.emplace_back();
+
+		AABB aabb = boxes[indices[begin]];
+		for (size_t i = begin + 1; i < end; i++)
+			aabb.unite(boxes[indices[i]]);
+		m_nodes[current].aabb = aabb;
+
+		if (end - begin == 1)
+		{
+			m_nodes[current].index = static_cast<int>(indices[begin]);
+			return current;
+		}
+
+		//split at the median of box centers along the longest axis
+		const bool horizontal = aabb.width >= aabb.height;
+		const size_t middle = begin + (end - begin) / 2;
+		std::nth_element(indices.begin() + begin, indices.begin() + middle, indices.begin() + end,
+			[&](const size_t& lhs, const size_t& rhs)
+			{
+				return horizontal ? boxes[lhs].position.x < boxes[rhs].position.x : boxes[lhs].position.y < boxes[rhs].position.y;
+			});
+
+		const int left = build(indices, begin, middle, boxes);
+		const int right = build(indices, middle, end, boxes);
+		m_nodes[current].left = left;
+		m_nodes[current].right = right;
+		return current;
+	}
+}
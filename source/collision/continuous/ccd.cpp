@@ -2,263 +2,216 @@
 
 namespace Physics2D
 {
-	std::tuple<CCD::BroadphaseTrajectory, AABB> CCD::buildTrajectoryAABB(Body* body, const Vector2& target, const real& dt)
+	AABB CCD::sweep(Body* body, const real& dt)
 	{
 		assert(body != nullptr);
-		std::vector<AABBShot> trajectory;
-		AABB result;
-		AABB startBox = AABB::fromBody(body);
-		Body::PhysicsAttribute start = body->physicsAttribute();
-		body->stepPosition(dt);
-		
-		Body::PhysicsAttribute end = body->physicsAttribute();
-		AABB endBox = AABB::fromBody(body);
-
-		if(startBox == endBox && start.velocity.lengthSquare() < Constant::MaxVelocity && abs(start.angularVelocity) < Constant::MaxAngularVelocity)
-		{
-			trajectory.emplace_back(AABBShot( startBox, body->physicsAttribute(), 0));
-			trajectory.emplace_back(AABBShot( endBox, body->physicsAttribute(), dt ));
-			return std::make_tuple(trajectory, result);
-		}
-		
-
-		result.unite(startBox).unite(endBox);
-		
-		body->setPhysicsAttribute(start);
-		
-		real slice = 40;
-		real step = dt / slice;
-		for(real i = dt / slice;i <= dt;)
-		{
-			body->stepPosition(step);
-			AABB aabb = AABB::fromBody(body);
-			trajectory.emplace_back(AABBShot{aabb, body->physicsAttribute(), i});
-			result.unite(aabb);
-			i += step;
-			if ((aabb.position - target).lengthSquare() >= (target - start.position).lengthSquare())
-				break;
-		}
-		body->setPhysicsAttribute(start);
-		return std::make_tuple(trajectory, result);
+		return sweep(body, body->physicsAttribute(), dt);
 	}
-	std::tuple<CCD::BroadphaseTrajectory, AABB> CCD::buildTrajectoryAABB(Body* body, const real& dt)
+	AABB CCD::sweep(Body* body, const Body::PhysicsAttribute& start, const real& dt)
 	{
 		assert(body != nullptr);
-		std::vector<AABBShot> trajectory;
-		AABB result;
-		AABB startBox = AABB::fromBody(body);
-		Body::PhysicsAttribute start = body->physicsAttribute();
-		body->stepPosition(dt);
-
-		Body::PhysicsAttribute end = body->physicsAttribute();
-		AABB endBox = AABB::fromBody(body);
-
-		if (startBox == endBox && start.velocity.lengthSquare() < Constant::MaxVelocity && abs(start.angularVelocity) < Constant::MaxAngularVelocity)
-		{
-			trajectory.emplace_back(AABBShot(startBox, body->physicsAttribute(), 0));
-			trajectory.emplace_back(AABBShot(endBox, body->physicsAttribute(), dt));
-			return std::make_tuple(trajectory, result);
-		}
-
-
-		result.unite(startBox).unite(endBox);
-
-		body->setPhysicsAttribute(start);
-
-		real slice = 40;
-		real step = dt / slice;
-		for (real i = dt / slice; i <= dt;)
+		Body::PhysicsAttribute end = start;
+		end.step(dt);
+		if (realEqual(start.angularVelocity, 0))
 		{
-			body->stepPosition(step);
-			AABB aabb = AABB::fromBody(body);
-			trajectory.emplace_back(AABBShot{ aabb, body->physicsAttribute(), i });
-			result.unite(aabb);
-			i += step;
+			ShapePrimitive primitive;
+			primitive.shape = body->shape();
+			primitive.transform = start.position;
+			primitive.rotation = start.rotation;
+			AABB result = AABB::fromShape(primitive);
+			AABB moved = result;
+			moved.position += end.position - start.position;
+			return result.unite(moved);
 		}
-		body->setPhysicsAttribute(start);
-		return std::make_tuple(trajectory, result);
+		AABB begin, finish;
+		begin.width = begin.height = finish.width = finish.height = reach(body) * 2;
+		begin.position = start.position;
+		finish.position = end.position;
+		return begin.unite(finish);
 	}
-	std::optional<CCD::IndexSection> CCD::findBroadphaseRoot(Body* body1, const BroadphaseTrajectory& trajectory1, Body* body2, const BroadphaseTrajectory& trajectory2, const real& dt)
+	std::optional<real> CCD::timeOfImpact(Body* body1, Body* body2, const real& dt, PointPair* closest)
 	{
 		assert(body1 != nullptr && body2 != nullptr);
-		bool isBody1CCD = trajectory1.size() > 2;
-		bool isBody2CCD = trajectory2.size() > 2;
-		if (isBody1CCD && isBody2CCD)
-		{
-			AABB traj1 = AABB::unite(trajectory1[0].aabb, trajectory1[trajectory1.size() - 1].aabb);
-			AABB traj2 = AABB::unite(trajectory2[0].aabb, trajectory2[trajectory2.size() - 1].aabb);
-			if (!traj1.collide(traj2))
-				return std::nullopt;
-			size_t length = trajectory1.size() > trajectory2.size() ? trajectory2.size() : trajectory1.size();
-			IndexSection result;
-
-			for (auto i = 0; i < length - 1; i++)
-			{
-				AABB temp1 = AABB::unite(trajectory1[i].aabb, trajectory1[i + 1].aabb);
-				AABB temp2 = AABB::unite(trajectory2[i].aabb, trajectory2[i + 1].aabb);
-				if (temp1.collide(temp2))
-				{
-					result.forward = i;
-					break;
-				}
-			}
-
-			return result.forward == -1 ? std::nullopt :
-				std::optional(result);
-		}
-		else if (!isBody1CCD || !isBody2CCD)
-		{
-			const BroadphaseTrajectory* trajStatic = nullptr;
-			const BroadphaseTrajectory* trajDynamic = nullptr;
-			if (isBody1CCD)
-			{
-				trajStatic = &trajectory2;
-				trajDynamic = &trajectory1;
-			}
-			else if (isBody2CCD)
-			{
-				trajStatic = &trajectory1;
-				trajDynamic = &trajectory2;
-			}
-
-			AABB traj1 = AABB::unite(trajStatic->at(0).aabb, trajStatic->at(1).aabb);
-			AABB traj2 = AABB::unite(trajDynamic->at(0).aabb, trajDynamic->at(trajDynamic->size() - 1).aabb);
-			if (!traj1.collide(traj2))
-				return std::nullopt;
-			
-			IndexSection result;
-			size_t length = trajDynamic->size();
-			bool forwardFound = false;
-			bool backwardFound = false;
-			for (size_t i = 0, j = length - 1; i < length - 1; i++, j--)
-			{
-				AABB tempForward = AABB::unite(trajDynamic->at(i).aabb, trajDynamic->at(i + 1).aabb);
-				AABB tempBackward = AABB::unite(trajDynamic->at(j).aabb, trajDynamic->at(j - 1).aabb);
-				if (tempForward.collide(traj1) && !forwardFound)
-				{
-					result.forward = i;
-					forwardFound = true;
-				}
-				if (tempBackward.collide(traj1) && !backwardFound)
-				{
-					result.backward = j;
-					backwardFound = true;
-				}
-				if (forwardFound && backwardFound)
-					break;
-			}
-			return result.forward == -1 ? std::nullopt :
-				std::optional(result);
-		}		
-		return std::nullopt;
-		
+		return timeOfImpact(body1, body1->physicsAttribute(), body2, body2->physicsAttribute(), dt, closest);
 	}
-	std::optional<real> CCD::findNarrowphaseRoot(Body* body1, const BroadphaseTrajectory& trajectory1, Body* body2, const BroadphaseTrajectory& trajectory2, const IndexSection& index, const real& dt)
+	std::optional<real> CCD::timeOfImpact(Body* body1, const Body::PhysicsAttribute& start1, Body* body2, const Body::PhysicsAttribute& start2,
+		const real& dt, PointPair* closest)
 	{
 		assert(body1 != nullptr && body2 != nullptr);
-		bool isBody1CCD = trajectory1.size() > 2;
-		bool isBody2CCD = trajectory2.size() > 2;
-		if (isBody1CCD && isBody2CCD)
-		{
+		if (body1 == body2)
 			return std::nullopt;
 
-		}
-		else if (!isBody1CCD || !isBody2CCD)
-		{
-			Body* dynamicBody = nullptr;
-			Body::PhysicsAttribute origin1 = body1->physicsAttribute();
-			Body::PhysicsAttribute origin2 = body2->physicsAttribute();
+		std::vector<ShapePrimitive> pieces1, pieces2;
+		pieces(body1, start1, body2, start2, dt, pieces1);
+		pieces(body2, start2, body1, start1, dt, pieces2);
+		const real rotation = std::abs(start1.angularVelocity) * reach(body1) + std::abs(start2.angularVelocity) * reach(body2);
 
-			real startTimestep = 0;
-			real endTimestep = 0;
-			if (isBody1CCD)
-			{
-				dynamicBody = body1;
-				body1->setPhysicsAttribute(trajectory1[index.forward].attribute);
-				startTimestep = trajectory1[index.forward].time;
-				endTimestep = trajectory1[index.backward].time;
-			}
-			else if (isBody2CCD)
-			{
-				dynamicBody = body2;
-				body2->setPhysicsAttribute(trajectory2[index.forward].attribute);
-				startTimestep = trajectory2[index.forward].time;
-				endTimestep = trajectory2[index.backward].time;
-			}
-			//slice maybe 25~70. It depends on how thin the sticks you set
-			const real slice = 30.0;
-			real step = (endTimestep - startTimestep) / slice;
-			real forwardSteps = 0;
-			Body::PhysicsAttribute lastAttribute;
-			//forwarding
-			bool isFound = false;
-			while (startTimestep + forwardSteps <= endTimestep)
-			{
-				lastAttribute = dynamicBody->physicsAttribute();
-				dynamicBody->stepPosition(step);
-				forwardSteps += step;
-				if (const bool result = Detector::collide(body1, body2); result)
-				{
-					forwardSteps -= step;
-					dynamicBody->setPhysicsAttribute(lastAttribute);
-					isFound = true;
-					break;
-				}
-			}
-
-			if (!isFound)
+		auto place = [](const Body::PhysicsAttribute& attribute, const std::shared_ptr<Shape>& shape)
+		{
+			ShapePrimitive primitive;
+			primitive.shape = shape;
+			primitive.transform = attribute.position;
+			primitive.rotation = attribute.rotation;
+			return primitive;
+		};
+
+		//pairs of pieces already touching belong to discrete contact
+		std::vector<std::pair<size_t, size_t>> candidates;
+		const ShapePrimitive pose1 = place(start1, body1->shape());
+		const ShapePrimitive pose2 = place(start2, body2->shape());
+		for (size_t i = 0; i < pieces1.size(); i++)
+		{
+			const ShapePrimitive a = pose1.compose(pieces1[i]);
+			for (size_t j = 0; j < pieces2.size(); j++)
 			{
-				body1->setPhysicsAttribute(origin1);
-				body2->setPhysicsAttribute(origin2);
-				return std::nullopt;
+				const ShapePrimitive b = pose2.compose(pieces2[j]);
+				if (AABB::collide(AABB::fromShape(a), AABB::fromShape(b)) && std::get<0>(GJK::gjk(a, b)))
+					continue;
+				candidates.emplace_back(i, j);
 			}
+		}
+		if (candidates.empty())
+			return std::nullopt;
 
-			//retracing
-			step /= 2.0;
-			const real epsilon = 0.01;
-			while (startTimestep + forwardSteps <= endTimestep)
+		real time = 0;
+		PointPair nearest;
+		for (int iteration = 0; iteration < MaxIterations; iteration++)
+		{
+			Body::PhysicsAttribute attribute1 = start1, attribute2 = start2;
+			attribute1.step(time);
+			attribute2.step(time);
+			const ShapePrimitive current1 = place(attribute1, body1->shape());
+			const ShapePrimitive current2 = place(attribute2, body2->shape());
+
+			//every piece pair stays apart while its separating plane does, the nearest plane to be crossed limits the advance
+			real advance = Constant::Max;
+			real nearestDistance = Constant::Max;
+			for (size_t k = 0; k < candidates.size();)
 			{
-				lastAttribute = dynamicBody->physicsAttribute();
-				dynamicBody->stepPosition(step);
-				forwardSteps += step;
-				if (const auto result = Detector::detect(body1, body2); result.isColliding)
+				const auto [i, j] = candidates[k];
+				const PointPair pair = GJK::distance(current1.compose(pieces1[i]), current2.compose(pieces2[j]));
+				const Vector2 gap = pair.pointB - pair.pointA;
+				const real distance = gap.length();
+				if (distance < Target + Tolerance)
 				{
-					if (std::abs(result.penetration) < epsilon)
+					if (iteration > 0)
 					{
-						body1->setPhysicsAttribute(origin1);
-						body2->setPhysicsAttribute(origin2);
-						return std::optional(startTimestep + forwardSteps);
+						if (closest != nullptr)
+							*closest = pair;
+						return time;
 					}
+					//close enough at the start for speculative contacts
+					candidates[k] = candidates.back();
+					candidates.pop_back();
+					continue;
+				}
 
-					forwardSteps -= step;
-					dynamicBody->setPhysicsAttribute(lastAttribute);
-					step /= 2.0;
+				if (distance < nearestDistance)
+				{
+					nearestDistance = distance;
+					nearest = pair;
 				}
+				const real approach = (start1.velocity - start2.velocity).dot(gap / distance) + rotation;
+				if (approach > Constant::GeometryEpsilon)
+					advance = Math::min(advance, (distance - Target) / approach);
+				k++;
 			}
-		}
+			if (realEqual(advance, Constant::Max))
+				return std::nullopt;
 
-		return std::nullopt;
+			time += advance;
+			if (time > dt)
+				return std::nullopt;
+		}
+		//still apart, so stopping early is safe, the nearest pair of the last iteration is near enough
+		if (closest != nullptr)
+			*closest = nearest;
+		return time;
 	}
 	std::optional<std::vector<CCD::CCDPair>> CCD::query(DBVH::Node* root, Body* body, const real& dt)
 	{
 		std::vector<CCDPair> queryList;
 		assert(root->isRoot() && body != nullptr);
-		auto [trajectoryCCD, aabbCCD] = buildTrajectoryAABB(body, dt);
 		std::vector<DBVH::Node*> potential;
-		DBVH::queryNodes(root, aabbCCD, potential, body);
+		DBVH::queryNodes(root, sweep(body, dt), potential, body);
 		for(DBVH::Node * element: potential)
 		{
-			auto [trajectoryElement, aabbElement] = buildTrajectoryAABB(element->pair.body, dt);
-			auto [newCCDTrajectory, newAABB] = buildTrajectoryAABB(body, element->pair.body->position(), dt);
-			auto result = findBroadphaseRoot(body, newCCDTrajectory, element->pair.body, trajectoryElement, dt);
-			if(result.has_value())
-			{
-				auto toi = findNarrowphaseRoot(body, newCCDTrajectory, element->pair.body, trajectoryElement, result.value(), dt);
-				if (toi.has_value())
-					queryList.emplace_back(CCDPair(toi.value(), element->pair.body));
-			}
+			if (auto toi = timeOfImpact(body, element->pair.body, dt); toi.has_value())
+				queryList.emplace_back(CCDPair(toi.value(), element->pair.body));
 		}
 		return !queryList.empty() ? std::optional(queryList)
 			: std::nullopt;
 	}
+	void CCD::pieces(Body* body, const Body::PhysicsAttribute& pose, Body* other, const Body::PhysicsAttribute& otherStart,
+		const real& dt, std::vector<ShapePrimitive>& output)
+	{
+		const std::shared_ptr<Shape>& shape = body->shape();
+		const Shape::Type type = shape->type();
+		if (type == Shape::Type::Compound)
+		{
+			const Compound* compound = static_cast<const Compound*>(shape.get());
+			output.insert(output.end(), compound->children().begin(), compound->children().end());
+			return;
+		}
+		if (type != Shape::Type::Chain && type != Shape::Type::Heightfield)
+		{
+			ShapePrimitive primitive;
+			primitive.shape = shape;
+			output.emplace_back(primitive);
+			return;
+		}
+
+		//segments near the sweep of other relative to terrain, terrain is not expected to spin
+		AABB region = sweep(other, otherStart, dt);
+		AABB shifted = region;
+		shifted.position -= pose.velocity * dt;
+		region.unite(shifted);
+		const Matrix2x2 toLocal(-pose.rotation);
+		real minX = Constant::Max, minY = Constant::Max, maxX = -Constant::Max, maxY = -Constant::Max;
+		for (const real& x : { -0.5, 0.5 })
+		{
+			for (const real& y : { -0.5, 0.5 })
+			{
+				const Vector2 corner = toLocal.multiply(region.position + Vector2(x * region.width, y * region.height) - pose.position);
+				minX = Math::min(minX, corner.x);
+				minY = Math::min(minY, corner.y);
+				maxX = Math::max(maxX, corner.x);
+				maxY = Math::max(maxY, corner.y);
+			}
+		}
+		AABB local;
+		local.position.set((minX + maxX) * 0.5, (minY + maxY) * 0.5);
+		local.width = maxX - minX;
+		local.height = maxY - minY;
+
+		auto append = [&output](const Chain::Segment& segment)
+		{
+			auto edge = std::make_shared<Edge>();
+			edge->set(segment.start, segment.end);
+			ShapePrimitive primitive;
+			primitive.shape = edge;
+			output.emplace_back(primitive);
+		};
+		if (type == Shape::Type::Chain)
+		{
+			const Chain* chain = static_cast<const Chain*>(shape.get());
+			std::vector<size_t> indices;
+			chain->tree().query(local, indices);
+			for (const size_t& index : indices)
+				append(chain->segment(index));
+			return;
+		}
+		const Heightfield* heightfield = static_cast<const Heightfield*>(shape.get());
+		if (minY > heightfield->maxHeight())
+			return;
+		const auto [first, last] = heightfield->columns(minX, maxX);
+		for (size_t index = first; index < last; index++)
+			append(heightfield->segment(index));
+	}
+	real CCD::reach(Body* body)
+	{
+		const AABB aabb = AABB::fromBody(body);
+		return Vector2(std::abs(aabb.position.x - body->position().x) + aabb.width * 0.5,
+			std::abs(aabb.position.y - body->position().y) + aabb.height * 0.5).length();
+	}
 }
@@ -1,4 +1,8 @@
 #include "include/collision/detector.h"
+#include "include/collision/manifold_cache.h"
+#ifdef PHYSICS2D_AVX2
+#include <immintrin.h>
+#endif
 namespace Physics2D
 {
 	
@@ -20,6 +24,11 @@ namespace Physics2D
 		if (!a.collide(b))
 			return false;
 
+		if (isTerrain(shapeA.shape->type()) || isTerrain(shapeB.shape->type()))
+			return !detectChain(bodyA, bodyB).empty();
+
+		if (shapeA.shape->type() == Shape::Type::Compound || shapeB.shape->type() == Shape::Type::Compound)
+			return !detectCompound(bodyA, bodyB).empty();
 
 		auto [isColliding, simplex] = GJK::gjk(shapeA, shapeB);
 
@@ -55,6 +64,52 @@ namespace Physics2D
 		if (!a.collide(b))
 			return result;
 
+		const bool isChain = isTerrain(shapeA.shape->type()) || isTerrain(shapeB.shape->type());
+		if (isChain || shapeA.shape->type() == Shape::Type::Compound || shapeB.shape->type() == Shape::Type::Compound)
+		{
+			//report the deepest one of all touching child pairs
+			for (auto& collision : isChain ? detectChain(bodyA, bodyB) : detectCompound(bodyA, bodyB))
+				if (!result.isColliding || collision.penetration > result.penetration)
+					result = collision;
+			return result;
+		}
+		//clipped like the speculative manifold of the pair, so that its points keep their features once touching
+		return detectConvex(bodyA, shapeA, bodyB, shapeB);
+	}
+
+	Collision Detector::detect(Body* bodyA, const ShapePrimitive& shapeA, Body* bodyB, const ShapePrimitive& shapeB)
+	{
+		Collision result;
+		result.bodyA = bodyA;
+		result.bodyB = bodyB;
+
+		//rounded shapes: while cores are apart, contact comes from closest points of cores minus radii
+		const real radiusA = shapeA.radius();
+		const real radiusB = shapeB.radius();
+		if (radiusA + radiusB > 0)
+		{
+			ShapePrimitive coreA = shapeA, coreB = shapeB;
+			coreA.core = true;
+			coreB.core = true;
+			const PointPair closest = GJK::distance(coreA, coreB);
+			const Vector2 gap = closest.pointA - closest.pointB;
+			const real length = gap.length();
+			//the gap must be a separating axis of cores, otherwise cores overlap and need epa
+			if (length > Constant::GeometryEpsilon && GJK::support(coreA, coreB, -gap).result.dot(gap) > 0)
+			{
+				if (length >= radiusA + radiusB)
+					return result;
+				result.isColliding = true;
+				result.normal = gap / length;
+				result.penetration = radiusA + radiusB - length;
+				PointPair pair;
+				pair.pointA = closest.pointA - result.normal * radiusA;
+				pair.pointB = closest.pointB + result.normal * radiusB;
+				result.contactList.emplace_back(pair);
+				return result;
+			}
+		}
+
 		auto [isColliding, simplex] = GJK::gjk(shapeA, shapeB);
 
 		if (shapeA.transform.fuzzyEqual(shapeB.transform) && !isColliding)
@@ -66,20 +121,268 @@ namespace Physics2D
 		
 		if (isColliding)
 		{
-			auto oldSimplex = simplex;
-			simplex = GJK::epa(shapeA, shapeB, simplex);
-			PenetrationSource source = GJK::dumpSource(simplex);
+			auto [polytope, iterations] = GJK::epa(shapeA, shapeB, simplex);
+			PenetrationSource source = GJK::dumpSource(polytope);
 
 			
 			const auto info = GJK::dumpInfo(source);
 			result.normal = info.normal;
 			result.penetration = info.penetration;
+			result.epaIterations = iterations;
 			result.contactList.emplace_back(GJK::dumpPoints(source));
 		}
 		assert(result.contactList.size() != 3);
 		return result;
 	}
 
+	std::vector<Collision> Detector::detectCompound(Body* bodyA, Body* bodyB)
+	{
+		std::vector<Collision> result;
+
+		if (bodyA == nullptr || bodyB == nullptr || bodyA == bodyB)
+			return result;
+
+		ShapePrimitive shapeA, shapeB;
+		shapeA.shape = bodyA->shape();
+		shapeA.rotation = bodyA->rotation();
+		shapeA.transform = bodyA->position();
+
+		shapeB.shape = bodyB->shape();
+		shapeB.rotation = bodyB->rotation();
+		shapeB.transform = bodyB->position();
+
+		std::vector<ShapePrimitive> childrenA, childrenB;
+		collectChildren(shapeA, AABB::fromShape(shapeB), childrenA);
+		for (const ShapePrimitive& childA : childrenA)
+		{
+			childrenB.clear();
+			collectChildren(shapeB, AABB::fromShape(childA), childrenB);
+			for (const ShapePrimitive& childB : childrenB)
+			{
+				Collision collision = detectConvex(bodyA, childA, bodyB, childB);
+				if (!collision.isColliding)
+					continue;
+				//children are not numbered here, their features could collide. match them by distance
+				for (PointPair& pair : collision.contactList)
+					pair.feature = 0;
+				result.emplace_back(collision);
+			}
+		}
+		return result;
+	}
+
+	void Detector::collectChildren(const ShapePrimitive& shape, const AABB& region, std::vector<ShapePrimitive>& output)
+	{
+		if (shape.shape->type() != Shape::Type::Compound)
+		{
+			if (AABB::fromShape(shape).collide(region))
+				output.emplace_back(shape);
+			return;
+		}
+
+		const Compound* compound = static_cast<const Compound*>(shape.shape.get());
+		std::vector<size_t> indices;
+		compound->tree().query(localRegion(shape, region), indices);
+		for (const size_t& index : indices)
+			output.emplace_back(shape.compose(compound->children()[index]));
+	}
+
+	bool Detector::isTerrain(const Shape::Type& type)
+	{
+		return type == Shape::Type::Chain || type == Shape::Type::Heightfield;
+	}
+
+	AABB Detector::localRegion(const ShapePrimitive& shape, const AABB& region)
+	{
+		const real c = std::abs(Math::cosx(shape.rotation));
+		const real s = std::abs(Math::sinx(shape.rotation));
+		AABB local;
+		local.position = Matrix2x2(-shape.rotation).multiply(region.position - shape.transform);
+		local.width = c * region.width + s * region.height;
+		local.height = s * region.width + c * region.height;
+		return local;
+	}
+
+	std::vector<Collision> Detector::detectChain(Body* bodyA, Body* bodyB)
+	{
+		std::vector<Collision> result;
+
+		if (bodyA == nullptr || bodyB == nullptr || bodyA == bodyB)
+			return result;
+
+		//collisions are built with the chain as B, then flipped if chain is A
+		const bool flip = isTerrain(bodyA->shape()->type());
+		Body* chainBody = flip ? bodyA : bodyB;
+		Body* otherBody = flip ? bodyB : bodyA;
+		if (!isTerrain(chainBody->shape()->type()) || isTerrain(otherBody->shape()->type()))
+			return result;
+
+		ShapePrimitive chainShape, otherShape;
+		chainShape.shape = chainBody->shape();
+		chainShape.rotation = chainBody->rotation();
+		chainShape.transform = chainBody->position();
+
+		otherShape.shape = otherBody->shape();
+		otherShape.rotation = otherBody->rotation();
+		otherShape.transform = otherBody->position();
+
+		const Chain* chain = chainShape.shape->type() == Shape::Type::Chain ? static_cast<const Chain*>(chainShape.shape.get()) : nullptr;
+		const Heightfield* heightfield = chain == nullptr ? static_cast<const Heightfield*>(chainShape.shape.get()) : nullptr;
+		std::vector<ShapePrimitive> others;
+		collectChildren(otherShape, AABB::fromShape(chainShape), others);
+
+		std::vector<size_t> indices;
+		for (const ShapePrimitive& other : others)
+		{
+			//only segments near the other shape reach the narrowphase, heightfield columns come directly from x range
+			indices.clear();
+			const AABB region = localRegion(chainShape, AABB::fromShape(other));
+			if (chain != nullptr)
+			{
+				chain->tree().query(region, indices);
+				std::sort(indices.begin(), indices.end());
+			}
+			else
+			{
+				const auto [first, last] = heightfield->columns(region.position.x - region.width * 0.5, region.position.x + region.width * 0.5);
+				if (region.position.y - region.height * 0.5 > heightfield->maxHeight())
+					continue;
+				for (size_t index = first; index < last; index++)
+					indices.emplace_back(index);
+			}
+			for (const size_t& index : indices)
+			{
+				const Chain::Segment segment = chain != nullptr ? chain->segment(index) : heightfield->segment(index);
+				Collision collision = detectSegment(otherBody, other, chainBody, chainShape, segment);
+				if (!collision.isColliding)
+					continue;
+
+				//segments are clipped alike, the segment index keeps their features apart
+				for (PointPair& pair : collision.contactList)
+					if (pair.feature != 0)
+						pair.feature |= uint64_t(index + 1) << 32;
+
+				if (flip)
+				{
+					std::swap(collision.bodyA, collision.bodyB);
+					collision.normal.negate();
+					for (PointPair& pair : collision.contactList)
+						std::swap(pair.pointA, pair.pointB);
+				}
+				result.emplace_back(collision);
+			}
+		}
+		return result;
+	}
+
+	Collision Detector::detectSegment(Body* body, const ShapePrimitive& shape, Body* chainBody, const ShapePrimitive& chainShape, const Chain::Segment& segment)
+	{
+		Collision result;
+		result.bodyA = body;
+		result.bodyB = chainBody;
+
+		const Vector2 start = chainShape.translate(segment.start);
+		const Vector2 end = chainShape.translate(segment.end);
+		const Vector2 normal = Vector2(end.y - start.y, start.x - end.x).normal();
+
+		//one-sided, shapes behind the segment belong to the solid side
+		if (normal.dot(shape.translate(shape.shape->center()) - start) < 0)
+			return result;
+
+		switch (shape.shape->type())
+		{
+		case Shape::Type::Circle:
+			fromSATResult(SAT::circleVsSegment(shape, start, end), result, false);
+			break;
+		case Shape::Type::Polygon:
+			fromSATResult(SAT::polygonVsSegment(shape, start, end), result, false);
+			break;
+		default:
+		{
+			auto edge = std::make_shared<Edge>();
+			edge->set(start, end);
+			ShapePrimitive edgeShape;
+			edgeShape.shape = edge;
+			result = detect(body, shape, chainBody, edgeShape);
+			break;
+		}
+		}
+		if (!result.isColliding)
+			return result;
+
+		const Vector2& direction = result.normal;
+		if (direction.dot(normal) <= 0)
+		{
+			result = Collision();
+			return result;
+		}
+
+		//ghost vertices: a contact leaning over a joint that it touches is kept only if the joint is convex and the normal
+		//stays inside the cone of both segment normals. Otherwise polygons fall back to the segment face, other shapes
+		//are left to the neighbor segment.
+		const Vector2 tangent = (end - start).normal();
+		auto touches = [&](const Vector2& vertex)
+		{
+			for (const PointPair& pair : result.contactList)
+				if (pair.pointB.fuzzyEqual(vertex, Constant::GeometryEpsilon))
+					return true;
+			return false;
+		};
+		bool keep = true;
+		if (direction.dot(tangent) < -Constant::GeometryEpsilon && segment.previous.has_value() && touches(start))
+		{
+			const Vector2 previous = chainShape.translate(*segment.previous);
+			const Vector2 previousNormal = Vector2(start.y - previous.y, previous.x - start.x).normal();
+			keep = (start - previous).cross(end - start) > 0 && previousNormal.cross(direction) >= 0;
+		}
+		if (direction.dot(tangent) > Constant::GeometryEpsilon && segment.next.has_value() && touches(end))
+		{
+			const Vector2 next = chainShape.translate(*segment.next);
+			const Vector2 nextNormal = Vector2(next.y - end.y, end.x - next.x).normal();
+			keep = (end - start).cross(next - end) > 0 && direction.cross(nextNormal) >= 0;
+		}
+		if (keep)
+			return result;
+
+		result = Collision();
+		result.bodyA = body;
+		result.bodyB = chainBody;
+		if (shape.shape->type() == Shape::Type::Polygon)
+			fromSATResult(SAT::polygonVsSegment(shape, start, end, true), result, false);
+		return result;
+	}
+
+	Collision Detector::detectConvex(Body* bodyA, const ShapePrimitive& shapeA, Body* bodyB, const ShapePrimitive& shapeB)
+	{
+		const Shape::Type typeA = shapeA.shape->type();
+		const Shape::Type typeB = shapeB.shape->type();
+		Collision result;
+		result.bodyA = bodyA;
+		result.bodyB = bodyB;
+
+		if (typeA == Shape::Type::Circle && typeB == Shape::Type::Circle)
+			fromSATResult(SAT::circleVsCircle(shapeA, shapeB), result, false);
+		else if (typeA == Shape::Type::Circle && typeB == Shape::Type::Polygon)
+			fromSATResult(SAT::circleVsPolygon(shapeA, shapeB), result, false);
+		else if (typeA == Shape::Type::Polygon && typeB == Shape::Type::Circle)
+			fromSATResult(SAT::circleVsPolygon(shapeB, shapeA), result, true);
+		else if (typeA == Shape::Type::Polygon && typeB == Shape::Type::Polygon)
+			fromSATResult(SAT::polygonVsPolygon(shapeA, shapeB), result, false);
+		else if (typeA == Shape::Type::Polygon && typeB == Shape::Type::Edge)
+		{
+			const Edge* edge = static_cast<const Edge*>(shapeB.shape.get());
+			fromSATResult(SAT::polygonVsSegment(shapeA, shapeB.translate(edge->startPoint()), shapeB.translate(edge->endPoint())), result, false);
+		}
+		else if (typeA == Shape::Type::Edge && typeB == Shape::Type::Polygon)
+		{
+			const Edge* edge = static_cast<const Edge*>(shapeA.shape.get());
+			fromSATResult(SAT::polygonVsSegment(shapeB, shapeA.translate(edge->startPoint()), shapeA.translate(edge->endPoint())), result, true);
+		}
+		else
+			return detect(bodyA, shapeA, bodyB, shapeB);
+		return result;
+	}
+
 	std::optional<PointPair> Detector::distance(Body* bodyA, Body* bodyB)
 	{
 		if (bodyA == nullptr || bodyB == nullptr)
@@ -99,4 +402,360 @@ namespace Physics2D
 
 		return std::optional<PointPair>(GJK::distance(shapeA, shapeB));
 	}
+
+	Collision Detector::speculate(Body* bodyA, Body* bodyB, const real& dt)
+	{
+		Collision result;
+
+		if (bodyA == nullptr || bodyB == nullptr || bodyA == bodyB)
+			return result;
+
+		if (bodyA->type() == Body::BodyType::Static && bodyB->type() == Body::BodyType::Static)
+			return result;
+
+		//bullets are swept by World and stop at their time of impact instead
+		if (bodyA->type() == Body::BodyType::Bullet || bodyB->type() == Body::BodyType::Bullet)
+			return result;
+
+		//distance to the hull of a compound or chain would stop bodies in its concave parts
+		const Shape::Type typeA = bodyA->shape()->type();
+		const Shape::Type typeB = bodyB->shape()->type();
+		if (typeA == Shape::Type::Compound || typeB == Shape::Type::Compound || isTerrain(typeA) || isTerrain(typeB))
+			return result;
+
+		result.bodyA = bodyA;
+		result.bodyB = bodyB;
+
+		//upper bound of how much the gap can close in dt, using aabb corners as reach of rotation
+		const AABB a = AABB::fromBody(bodyA);
+		const AABB b = AABB::fromBody(bodyB);
+		auto reach = [](Body* body, const AABB& aabb)
+		{
+			return Vector2(std::abs(aabb.position.x - body->position().x) + aabb.width * 0.5,
+				std::abs(aabb.position.y - body->position().y) + aabb.height * 0.5).length();
+		};
+		const real margin = ((bodyA->velocity() - bodyB->velocity()).length() +
+			std::abs(bodyA->angularVelocity()) * reach(bodyA, a) +
+			std::abs(bodyB->angularVelocity()) * reach(bodyB, b)) * dt;
+
+		const real gapX = std::abs(a.position.x - b.position.x) - (a.width + b.width) * 0.5;
+		const real gapY = std::abs(a.position.y - b.position.y) - (a.height + b.height) * 0.5;
+		if (Math::max(gapX, gapY) > margin)
+			return result;
+
+		ShapePrimitive shapeA, shapeB;
+		shapeA.shape = bodyA->shape();
+		shapeA.rotation = bodyA->rotation();
+		shapeA.transform = bodyA->position();
+
+		shapeB.shape = bodyB->shape();
+		shapeB.rotation = bodyB->rotation();
+		shapeB.transform = bodyB->position();
+
+		//a single closest point of two faces lies anywhere along them and would spin the bodies,
+		//clip them as reference and incident face instead. vertex approaches clip to nothing and take the closest points
+		SATResult sat;
+		bool swap = false;
+		if (typeA == Shape::Type::Polygon && typeB == Shape::Type::Polygon)
+			sat = SAT::polygonVsPolygon(shapeA, shapeB, margin);
+		else if (typeA == Shape::Type::Polygon && typeB == Shape::Type::Edge)
+		{
+			const Edge* edge = static_cast<const Edge*>(shapeB.shape.get());
+			sat = SAT::polygonVsSegment(shapeA, shapeB.translate(edge->startPoint()), shapeB.translate(edge->endPoint()), false, margin);
+		}
+		else if (typeA == Shape::Type::Edge && typeB == Shape::Type::Polygon)
+		{
+			const Edge* edge = static_cast<const Edge*>(shapeA.shape.get());
+			sat = SAT::polygonVsSegment(shapeB, shapeA.translate(edge->startPoint()), shapeA.translate(edge->endPoint()), false, margin);
+			swap = true;
+		}
+		if (sat.isColliding)
+		{
+			fromSATResult(sat, result, swap);
+			return result;
+		}
+
+		const PointPair pair = GJK::distance(shapeA, shapeB);
+		const Vector2 gap = pair.pointA - pair.pointB;
+		const real separation = gap.length();
+		if (separation < Constant::GeometryEpsilon || separation > margin)
+			return result;
+
+		result.isColliding = true;
+		result.normal = gap / separation;
+		result.penetration = -separation;
+		result.contactList.emplace_back(pair);
+		return result;
+	}
+
+	std::vector<Collision> Detector::detect(const std::vector<std::pair<Body*, Body*>>& pairs, Utils::WorkerPool* pool, const real& speculativeTime, ManifoldCache* cache)
+	{
+		std::vector<Collision> output(pairs.size());
+		std::vector<size_t> circleCircle, circlePolygon, polygonPolygon, composite, general;
+		circleCircle.reserve(pairs.size());
+		//compound and chain pairs may produce one collision per touching child or segment
+		std::vector<std::vector<Collision>> compositeOutput;
+		//pairs whose manifold came from cache, they skip narrowphase and are not stored again
+		std::vector<bool> fetched(pairs.size(), false);
+		std::vector<Collision> cached;
+
+		for (size_t i = 0; i < pairs.size(); i++)
+		{
+			Body* bodyA = pairs[i].first;
+			Body* bodyB = pairs[i].second;
+			if (bodyA == nullptr || bodyB == nullptr || bodyA == bodyB)
+				continue;
+
+			const Shape::Type typeA = bodyA->shape()->type();
+			const Shape::Type typeB = bodyB->shape()->type();
+			const bool isComposite = typeA == Shape::Type::Compound || typeB == Shape::Type::Compound || isTerrain(typeA) || isTerrain(typeB);
+			if (cache != nullptr && cache->fetch(bodyA, bodyB, cached))
+			{
+				fetched[i] = true;
+				if (isComposite)
+				{
+					composite.emplace_back(i);
+					compositeOutput.emplace_back(std::move(cached));
+					cached.clear();
+				}
+				else if (!cached.empty())
+					output[i] = cached[0];
+				continue;
+			}
+			if (isComposite)
+			{
+				composite.emplace_back(i);
+				compositeOutput.emplace_back();
+			}
+			else if (typeA == Shape::Type::Circle && typeB == Shape::Type::Circle)
+				circleCircle.emplace_back(i);
+			else if (typeA == Shape::Type::Polygon && typeB == Shape::Type::Polygon)
+				polygonPolygon.emplace_back(i);
+			else if ((typeA == Shape::Type::Circle && typeB == Shape::Type::Polygon) ||
+				(typeA == Shape::Type::Polygon && typeB == Shape::Type::Circle))
+				circlePolygon.emplace_back(i);
+			else
+				general.emplace_back(i);
+		}
+
+		//split a bucket into ranges whose bounds are multiples of grain, so that the same pairs
+		//always share a simd lane group no matter how many workers there are
+		auto dispatch = [pool](const size_t& count, const size_t& grain, const std::function<void(size_t, size_t)>& kernel)
+		{
+			if (pool == nullptr)
+			{
+				kernel(0, count);
+				return;
+			}
+			pool->forEach((count + grain - 1) / grain, [&](size_t begin, size_t end, size_t)
+				{
+					kernel(begin * grain, std::min(end * grain, count));
+				});
+		};
+
+		dispatch(circleCircle.size(), 4, [&](size_t begin, size_t end) { circleVsCircleBatch(pairs, circleCircle, begin, end, output); });
+		dispatch(circlePolygon.size(), 1, [&](size_t begin, size_t end) { circleVsPolygonBatch(pairs, circlePolygon, begin, end, output); });
+		dispatch(polygonPolygon.size(), 1, [&](size_t begin, size_t end) { polygonVsPolygonBatch(pairs, polygonPolygon, begin, end, output); });
+		dispatch(general.size(), 1, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+					output[general[i]] = detect(pairs[general[i]].first, pairs[general[i]].second);
+			});
+		dispatch(composite.size(), 1, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					if (fetched[composite[i]])
+						continue;
+					Body* bodyA = pairs[composite[i]].first;
+					Body* bodyB = pairs[composite[i]].second;
+					const bool isChain = isTerrain(bodyA->shape()->type()) || isTerrain(bodyB->shape()->type());
+					compositeOutput[i] = isChain ? detectChain(bodyA, bodyB) : detectCompound(bodyA, bodyB);
+				}
+			});
+
+		//speculative contacts depend on velocity, only exact results are cached
+		if (cache != nullptr)
+		{
+			for (size_t i = 0, k = 0; i < pairs.size(); i++)
+			{
+				const bool isComposite = k < composite.size() && composite[k] == i;
+				if (fetched[i] || pairs[i].first == nullptr || pairs[i].second == nullptr || pairs[i].first == pairs[i].second)
+				{
+					k += isComposite;
+					continue;
+				}
+				cached.clear();
+				if (isComposite)
+					cached = compositeOutput[k++];
+				else if (output[i].isColliding)
+					cached.emplace_back(output[i]);
+				cache->store(pairs[i].first, pairs[i].second, cached);
+			}
+			cache->prune();
+		}
+
+		if (speculativeTime > 0)
+		{
+			dispatch(pairs.size(), 1, [&](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; i++)
+						if (!output[i].isColliding)
+							output[i] = speculate(pairs[i].first, pairs[i].second, speculativeTime);
+				});
+		}
+
+		std::vector<Collision> result;
+		result.reserve(output.size());
+		for (size_t i = 0, k = 0; i < output.size(); i++)
+		{
+			if (k < composite.size() && composite[k] == i)
+			{
+				for (Collision& collision : compositeOutput[k++])
+					result.emplace_back(std::move(collision));
+				continue;
+			}
+			if (output[i].isColliding)
+				result.emplace_back(std::move(output[i]));
+		}
+		return result;
+	}
+
+	void Detector::circleVsCircleBatch(const PairList& pairs, const std::vector<size_t>& indices, size_t begin, size_t end, std::vector<Collision>& output)
+	{
+		const size_t count = end - begin;
+		if (count == 0)
+			return;
+
+		//gather into structure of arrays so that several pairs can be tested per instruction
+		std::vector<real> ax(count), ay(count), ar(count), bx(count), by(count), br(count);
+		std::vector<real> nx(count), ny(count), penetration(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			const auto& [bodyA, bodyB] = pairs[indices[begin + i]];
+			ax[i] = bodyA->position().x;
+			ay[i] = bodyA->position().y;
+			ar[i] = static_cast<const Circle*>(bodyA->shape().get())->radius() + bodyA->shape()->skin();
+			bx[i] = bodyB->position().x;
+			by[i] = bodyB->position().y;
+			br[i] = static_cast<const Circle*>(bodyB->shape().get())->radius() + bodyB->shape()->skin();
+		}
+
+		size_t i = 0;
+#ifdef PHYSICS2D_AVX2
+		const __m256d zero = _mm256_setzero_pd();
+		const __m256d one = _mm256_set1_pd(1.0);
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(&ax[i]), _mm256_loadu_pd(&bx[i]));
+			const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(&ay[i]), _mm256_loadu_pd(&by[i]));
+			const __m256d length = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+			const __m256d radius = _mm256_add_pd(_mm256_loadu_pd(&ar[i]), _mm256_loadu_pd(&br[i]));
+
+			//coincident centers fall back to normal (0, 1)
+			const __m256d degenerate = _mm256_cmp_pd(length, zero, _CMP_EQ_OQ);
+			const __m256d inverse = _mm256_div_pd(one, _mm256_blendv_pd(length, one, degenerate));
+			_mm256_storeu_pd(&nx[i], _mm256_blendv_pd(_mm256_mul_pd(dx, inverse), zero, degenerate));
+			_mm256_storeu_pd(&ny[i], _mm256_blendv_pd(_mm256_mul_pd(dy, inverse), one, degenerate));
+			_mm256_storeu_pd(&penetration[i], _mm256_sub_pd(radius, length));
+		}
+#endif
+		for (; i < count; i++)
+		{
+			const real dx = ax[i] - bx[i];
+			const real dy = ay[i] - by[i];
+			const real length = std::sqrt(dx * dx + dy * dy);
+			const bool degenerate = length == 0;
+			const real inverse = 1 / (degenerate ? 1 : length);
+			nx[i] = degenerate ? 0 : dx * inverse;
+			ny[i] = degenerate ? 1 : dy * inverse;
+			penetration[i] = ar[i] + br[i] - length;
+		}
+
+		for (i = 0; i < count; i++)
+		{
+			if (penetration[i] < 0)
+				continue;
+
+			const size_t index = indices[begin + i];
+			Collision& collision = output[index];
+			collision.bodyA = pairs[index].first;
+			collision.bodyB = pairs[index].second;
+			collision.isColliding = true;
+			collision.normal.set(nx[i], ny[i]);
+			collision.penetration = penetration[i];
+			PointPair pair;
+			pair.pointA.set(ax[i] - ar[i] * nx[i], ay[i] - ar[i] * ny[i]);
+			pair.pointB.set(bx[i] + br[i] * nx[i], by[i] + br[i] * ny[i]);
+			collision.contactList.emplace_back(pair);
+		}
+	}
+
+	void Detector::circleVsPolygonBatch(const PairList& pairs, const std::vector<size_t>& indices, size_t begin, size_t end, std::vector<Collision>& output)
+	{
+		ShapePrimitive shapeCircle, shapePolygon;
+		for (size_t i = begin; i < end; i++)
+		{
+			const size_t index = indices[i];
+			Body* bodyA = pairs[index].first;
+			Body* bodyB = pairs[index].second;
+			const bool swap = bodyA->shape()->type() == Shape::Type::Polygon;
+			Body* circle = swap ? bodyB : bodyA;
+			Body* polygon = swap ? bodyA : bodyB;
+
+			shapeCircle.shape = circle->shape();
+			shapeCircle.rotation = circle->rotation();
+			shapeCircle.transform = circle->position();
+
+			shapePolygon.shape = polygon->shape();
+			shapePolygon.rotation = polygon->rotation();
+			shapePolygon.transform = polygon->position();
+
+			Collision& collision = output[index];
+			collision.bodyA = bodyA;
+			collision.bodyB = bodyB;
+			fromSATResult(SAT::circleVsPolygon(shapeCircle, shapePolygon), collision, swap);
+		}
+	}
+
+	void Detector::polygonVsPolygonBatch(const PairList& pairs, const std::vector<size_t>& indices, size_t begin, size_t end, std::vector<Collision>& output)
+	{
+		ShapePrimitive shapeA, shapeB;
+		for (size_t i = begin; i < end; i++)
+		{
+			const size_t index = indices[i];
+			Body* bodyA = pairs[index].first;
+			Body* bodyB = pairs[index].second;
+
+			shapeA.shape = bodyA->shape();
+			shapeA.rotation = bodyA->rotation();
+			shapeA.transform = bodyA->position();
+
+			shapeB.shape = bodyB->shape();
+			shapeB.rotation = bodyB->rotation();
+			shapeB.transform = bodyB->position();
+
+			Collision& collision = output[index];
+			collision.bodyA = bodyA;
+			collision.bodyB = bodyB;
+			fromSATResult(SAT::polygonVsPolygon(shapeA, shapeB), collision, false);
+		}
+	}
+
+	void Detector::fromSATResult(const SATResult& sat, Collision& collision, bool swap)
+	{
+		collision.isColliding = sat.isColliding;
+		if (!sat.isColliding)
+			return;
+
+		collision.normal = swap ? -sat.normal : sat.normal;
+		collision.penetration = sat.penetration;
+		for (size_t i = 0; i < sat.contactsCount; i++)
+		{
+			PointPair pair = sat.pointPair[i];
+			if (swap)
+				std::swap(pair.pointA, pair.pointB);
+			collision.contactList.emplace_back(pair);
+		}
+	}
 }
\ No newline at end of file
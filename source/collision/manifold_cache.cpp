@@ -0,0 +1,115 @@
+#include "include/collision/manifold_cache.h"
+
+namespace Physics2D
+{
+	ManifoldCache::ManifoldCache(const real& linearTolerance, const real& angularTolerance)
+		: m_linearTolerance(linearTolerance), m_angularTolerance(angularTolerance)
+	{
+	}
+
+	real ManifoldCache::linearTolerance() const
+	{
+		return m_linearTolerance;
+	}
+
+	void ManifoldCache::setLinearTolerance(const real& tolerance)
+	{
+		m_linearTolerance = tolerance;
+	}
+
+	real ManifoldCache::angularTolerance() const
+	{
+		return m_angularTolerance;
+	}
+
+	void ManifoldCache::setAngularTolerance(const real& tolerance)
+	{
+		m_angularTolerance = tolerance;
+	}
+
+	bool ManifoldCache::fetch(Body* bodyA, Body* bodyB, std::vector<Collision>& output)
+	{
+		output.clear();
+		auto iter = m_entries.find({ bodyA, bodyB });
+		if (iter == m_entries.end())
+			return false;
+
+		Entry& entry = iter->second;
+		if (entry.shapeA != bodyA->shape().get() || entry.shapeB != bodyB->shape().get())
+			return false;
+
+		//compare with the transform the manifold was computed at, so that slow drift still triggers detection
+		auto [position, rotation] = relativeTransform(bodyA, bodyB);
+		if ((position - entry.relativePosition).lengthSquare() > m_linearTolerance * m_linearTolerance ||
+			std::abs(rotation - entry.relativeRotation) > m_angularTolerance)
+			return false;
+
+		entry.touched = true;
+		for (const Collision& local : entry.collisions)
+		{
+			Collision collision = local;
+			collision.normal = Matrix2x2(collision.bodyA->rotation()).multiply(local.normal);
+			for (PointPair& pair : collision.contactList)
+			{
+				pair.pointA = collision.bodyA->toWorldPoint(pair.pointA);
+				pair.pointB = collision.bodyB->toWorldPoint(pair.pointB);
+			}
+			output.emplace_back(collision);
+		}
+		return true;
+	}
+
+	void ManifoldCache::store(Body* bodyA, Body* bodyB, const std::vector<Collision>& collisions)
+	{
+		Entry& entry = m_entries[{ bodyA, bodyB }];
+		entry.shapeA = bodyA->shape().get();
+		entry.shapeB = bodyB->shape().get();
+		std::tie(entry.relativePosition, entry.relativeRotation) = relativeTransform(bodyA, bodyB);
+		entry.touched = true;
+
+		//points in local space of their own body, normal in local space of body A.
+		//assign over old entries to reuse their storage
+		entry.collisions.resize(collisions.size());
+		for (size_t i = 0; i < collisions.size(); i++)
+		{
+			Collision& collision = entry.collisions[i];
+			collision = collisions[i];
+			collision.normal = Matrix2x2(-collision.bodyA->rotation()).multiply(collision.normal);
+			for (PointPair& pair : collision.contactList)
+			{
+				pair.pointA = collision.bodyA->toLocalPoint(pair.pointA);
+				pair.pointB = collision.bodyB->toLocalPoint(pair.pointB);
+			}
+		}
+	}
+
+	void ManifoldCache::prune()
+	{
+		for (auto iter = m_entries.begin(); iter != m_entries.end();)
+		{
+			if (!iter->second.touched)
+			{
+				iter = m_entries.erase(iter);
+				continue;
+			}
+			iter->second.touched = false;
+			++iter;
+		}
+	}
+
+	void ManifoldCache::clear()
+	{
+		m_entries.clear();
+	}
+
+	size_t ManifoldCache::size() const
+	{
+		return m_entries.size();
+	}
+
+	std::tuple<Vector2, real> ManifoldCache::relativeTransform(Body* bodyA, Body* bodyB)
+	{
+		const Vector2 position = Matrix2x2(-bodyA->rotation()).multiply(bodyB->position() - bodyA->position());
+		return { position, bodyB->rotation() - bodyA->rotation() };
+	}
+}
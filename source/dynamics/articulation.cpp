@@ -0,0 +1,501 @@
+#include "include/dynamics/articulation.h"
+
+namespace Physics2D
+{
+	//spatial velocity about the world origin of body
+	static Vector3 motionOf(Body* body)
+	{
+		const Vector2 center = body->position();
+		const real omega = body->angularVelocity();
+		return Vector3(omega, body->velocity().x + omega * center.y, body->velocity().y - omega * center.x);
+	}
+	//velocity of world point moving with spatial velocity
+	static Vector2 pointVelocity(const Vector3& motion, const Vector2& point)
+	{
+		return Vector2(motion.y - motion.x * point.y, motion.z + motion.x * point.x);
+	}
+	//spatial force about the world origin of force at world point
+	static Vector3 forceAt(const Vector2& force, const Vector2& point, const real& torque = 0)
+	{
+		return Vector3(torque + point.cross(force), force.x, force.y);
+	}
+	//spatial cross products, planar parts of v x m and v x* f
+	static Vector3 crossMotion(const Vector3& v, const Vector3& m)
+	{
+		return Vector3(0, v.z * m.x - v.x * m.z, v.x * m.y - v.y * m.x);
+	}
+	static Vector3 crossForce(const Vector3& v, const Vector3& f)
+	{
+		return Vector3(v.y * f.z - v.z * f.y, -v.x * f.z, v.x * f.y);
+	}
+	static Matrix3x3 outer(const Vector3& v)
+	{
+		return Matrix3x3(v * v.x, v * v.y, v * v.z);
+	}
+	//spatial inertia about the world origin of body
+	static Matrix3x3 inertiaOf(Body* body)
+	{
+		const real m = body->mass();
+		const Vector2 c = body->position();
+		return Matrix3x3(body->inertia() + m * c.lengthSquare(), -m * c.y, m * c.x,
+			-m * c.y, m, 0,
+			m * c.x, 0, m);
+	}
+
+	Articulation::Articulation(Body* root)
+	{
+		assert(root != nullptr);
+		Link link;
+		link.body = root;
+		m_floating = root->type() == Body::BodyType::Dynamic;
+		root->setArticulation(this, 0);
+		m_links.emplace_back(link);
+	}
+	size_t Articulation::addRevolute(const size_t& parent, Body* body, const Vector2& localPointA, const Vector2& localPointB)
+	{
+		Body* parentBody = m_links[parent].body;
+		Link link;
+		link.parent = parent;
+		link.body = body;
+		link.type = ArticulationJointType::Revolute;
+		link.localPointA = localPointA;
+		link.localPointB = localPointB;
+		link.reference = body->rotation() - parentBody->rotation();
+		link.velocity = body->angularVelocity() - parentBody->angularVelocity();
+		return add(link);
+	}
+	size_t Articulation::addPrismatic(const size_t& parent, Body* body, const Vector2& localPointA, const Vector2& localPointB, const Vector2& localAxis)
+	{
+		Body* parentBody = m_links[parent].body;
+		Link link;
+		link.parent = parent;
+		link.body = body;
+		link.type = ArticulationJointType::Prismatic;
+		link.localPointA = localPointA;
+		link.localPointB = localPointB;
+		link.localAxis = localAxis.normal();
+		link.reference = body->rotation() - parentBody->rotation();
+
+		const Vector2 axis = Matrix2x2(parentBody->rotation()).multiply(link.localAxis);
+		const Vector2 pa = parentBody->toWorldPoint(localPointA);
+		const Vector2 pb = body->toWorldPoint(localPointB);
+		link.position = (pb - pa).dot(axis);
+		link.velocity = (pointVelocity(motionOf(body), pb) - pointVelocity(motionOf(parentBody), pb)).dot(axis);
+		return add(link);
+	}
+	size_t Articulation::add(Link link)
+	{
+		assert(link.parent < m_links.size());
+		assert(link.body->type() == Body::BodyType::Dynamic);
+		const size_t index = m_links.size();
+		link.body->setArticulation(this, index);
+		m_links.emplace_back(link);
+		place();
+		propagate();
+		return index;
+	}
+	void Articulation::stepVelocity(const real& h, const Vector2& gravity)
+	{
+		if (!m_factored)
+			factor();
+		propagate();
+		m_gravity = gravity;
+		if (m_energyLimit)
+			limit();
+
+		//joint accelerations taken once per step diverge on fast chains, the tree moves in inner steps of its own.
+		//links are put back afterwards and keep the motion as travel, contacts see them where they were placed
+		Body* root = m_links[0].body;
+		const Vector2 rootPosition = root->position();
+		const real rootRotation = root->rotation();
+		for (Link& link : m_links)
+			link.travel = link.position;
+		m_momentum = momentum();
+		m_impulse.clear();
+		m_stepped = true;
+
+		real remaining = h;
+		while (remaining > 0)
+		{
+			//no joint turns or slides more than m_turn in one inner step, the last ones of a step are made even.
+			//slow trees take the whole step at once, their links then move by the velocity contacts leave them
+			real fastest = std::fabs(root->angularVelocity());
+			for (size_t i = 1; i < m_links.size(); i++)
+				fastest = Math::max(fastest, std::fabs(m_links[i].velocity));
+			real step = fastest * remaining > m_turn ? m_turn / fastest : remaining;
+			step = Math::max(step, h / m_maxSteps);
+			step = remaining / std::ceil(remaining / step - Constant::GeometryEpsilon);
+			remaining = remaining - step > Constant::GeometryEpsilon * step ? remaining - step : 0;
+
+			//velocity products of the inner step start alone gain energy on fast chains.
+			//a half step finds the midpoint velocity, the full step is taken again with products of it
+			const Vector2 rootVelocity = root->velocity();
+			const real rootAngularVelocity = root->angularVelocity();
+			for (Link& link : m_links)
+				link.start = link.velocity;
+			for (const real& part : { step / 2, step })
+			{
+				accelerate(part);
+				if (m_floating)
+				{
+					//the center of a spinning root also gets the velocity product term over the step
+					const Vector3 velocityChange = m_links[0].acceleration * part;
+					const Vector2 classical = Vector2::crossProduct(root->angularVelocity(), root->velocity()) * part;
+					root->velocity() = rootVelocity + pointVelocity(velocityChange, root->position()) + classical;
+					root->angularVelocity() = rootAngularVelocity + velocityChange.x;
+				}
+				propagate();
+			}
+			m_momentum += external() * step;
+			root->position() += root->velocity() * step;
+			root->rotation() += root->angularVelocity() * step;
+			for (size_t i = 1; i < m_links.size(); i++)
+				m_links[i].position += m_links[i].velocity * step;
+			place();
+			factor();
+			propagate();
+		}
+
+		m_rootTravel = root->position() - rootPosition;
+		m_rootTurn = root->rotation() - rootRotation;
+		m_rootVelocity = root->velocity();
+		m_rootAngularVelocity = root->angularVelocity();
+		root->position() = rootPosition;
+		root->rotation() = rootRotation;
+		for (Link& link : m_links)
+		{
+			std::swap(link.travel, link.position);
+			link.travel -= link.position;
+			link.start = link.velocity;
+		}
+		place();
+		propagate();
+		if (m_energyLimit)
+		{
+			m_energy += h * power();
+			m_kinetic = kineticEnergy(Vector3());
+		}
+	}
+	void Articulation::stepPosition(const real& h)
+	{
+		//impulses since the velocity step changed the energy the tree may keep
+		if (m_energyLimit)
+			m_energy += kineticEnergy(Vector3()) - m_kinetic;
+
+		//the travel of the velocity step, plus what impulses since then changed over the whole step.
+		//a fixed root only moves at the velocity it was given, static roots have none
+		Body* root = m_links[0].body;
+		root->position() += m_rootTravel + (root->velocity() - m_rootVelocity) * h;
+		root->rotation() += m_rootTurn + (root->angularVelocity() - m_rootAngularVelocity) * h;
+		for (size_t i = 1; i < m_links.size(); i++)
+			m_links[i].position += m_links[i].travel + (m_links[i].velocity - m_links[i].start) * h;
+		//without another velocity step links move at their velocity again
+		m_rootTravel.clear();
+		m_rootTurn = 0;
+		m_rootVelocity.clear();
+		m_rootAngularVelocity = 0;
+		for (Link& link : m_links)
+		{
+			link.travel = 0;
+			link.start = 0;
+		}
+		place();
+		propagate();
+		if (m_floating && m_stepped)
+		{
+			//momentum of a floating tree only changes by forces and impulses. the explicit steps lose some of it
+			//while links swing about, the root takes back the difference as the whole tree moving rigidly
+			Matrix3x3 inertia;
+			for (const Link& link : m_links)
+				inertia += inertiaOf(link.body);
+			Matrix3x3::invert(inertia);
+			moveRoot(inertia.multiply(m_momentum + m_impulse - momentum()));
+			propagate();
+		}
+		m_stepped = false;
+		if (m_energyLimit)
+			m_placed = kineticEnergy(Vector3()) + potentialEnergy();
+	}
+	void Articulation::applyImpulse(const size_t& link, const Vector2& impulse, const Vector2& point)
+	{
+		if (!m_factored)
+			factor();
+		for (Link& other : m_links)
+			other.residual = 0;
+		const Vector3 rootChange = rootResponse(link, forceAt(impulse, point));
+		m_impulse += forceAt(impulse, point);
+
+		//links off the path have no u of their own, they only follow their parents
+		m_links[0].acceleration = rootChange;
+		for (size_t i = 1; i < m_links.size(); i++)
+		{
+			Link& other = m_links[i];
+			const Vector3& parentChange = m_links[other.parent].acceleration;
+			const real velocityChange = (other.residual - other.inertiaMotion.dot(parentChange)) / other.pivot;
+			other.acceleration = parentChange + other.motion * velocityChange;
+			other.velocity += velocityChange;
+		}
+		if (m_floating)
+			moveRoot(rootChange);
+		propagate();
+	}
+	real Articulation::inverseMass(const size_t& link, const Vector2& point, const Vector2& direction)
+	{
+		if (!m_factored)
+			factor();
+		Vector3 change = rootResponse(link, forceAt(direction, point));
+		for (size_t i = m_path.size(); i-- > 0;)
+		{
+			const Link& other = m_links[m_path[i]];
+			change += other.motion * ((other.residual - other.inertiaMotion.dot(change)) / other.pivot);
+		}
+		return direction.dot(pointVelocity(change, point));
+	}
+	size_t Articulation::links() const
+	{
+		return m_links.size();
+	}
+	Body* Articulation::body(const size_t& link) const
+	{
+		return m_links[link].body;
+	}
+	ArticulationJointType Articulation::jointType(const size_t& link) const
+	{
+		return m_links[link].type;
+	}
+	real Articulation::jointPosition(const size_t& link) const
+	{
+		return m_links[link].position;
+	}
+	real Articulation::jointVelocity(const size_t& link) const
+	{
+		return m_links[link].velocity;
+	}
+	real& Articulation::jointForce(const size_t& link)
+	{
+		return m_links[link].force;
+	}
+	bool Articulation::energyLimit() const
+	{
+		return m_energyLimit;
+	}
+	void Articulation::setEnergyLimit(const bool& energyLimit)
+	{
+		m_energyLimit = energyLimit;
+		m_tracked = false;
+	}
+	void Articulation::accelerate(const real& h)
+	{
+		//velocity products and articulated bias forces, root to leaves
+		for (size_t i = 0; i < m_links.size(); i++)
+		{
+			Link& link = m_links[i];
+			Body* body = link.body;
+			if (i > 0)
+				link.bias = crossMotion(link.spatialVelocity, link.motion * link.velocity);
+			const Vector3 external = forceAt(body->mass() * m_gravity + body->forces(), body->position(), body->torques());
+			link.articulatedForce = crossForce(link.spatialVelocity, link.inertia.multiply(link.spatialVelocity)) - external;
+		}
+		//leaves to root, pA of parent gains pA + (IA - U U^T / D) c + U u / D of child
+		for (size_t i = m_links.size(); i-- > 1;)
+		{
+			Link& link = m_links[i];
+			link.residual = link.force - link.motion.dot(link.articulatedForce);
+			const Vector3 inertiaBias = link.articulatedInertia.multiply(link.bias) - link.inertiaMotion * (link.inertiaMotion.dot(link.bias) / link.pivot);
+			m_links[link.parent].articulatedForce += link.articulatedForce + inertiaBias + link.inertiaMotion * (link.residual / link.pivot);
+		}
+		//accelerations root to leaves
+		Link& root = m_links[0];
+		root.acceleration.clear();
+		if (m_floating)
+			root.acceleration = m_rootInverse.multiply(root.articulatedForce) * -1;
+		for (size_t i = 1; i < m_links.size(); i++)
+		{
+			Link& link = m_links[i];
+			const Vector3 acceleration = m_links[link.parent].acceleration + link.bias;
+			const real jointAcceleration = (link.residual - link.inertiaMotion.dot(acceleration)) / link.pivot;
+			link.acceleration = acceleration + link.motion * jointAcceleration;
+			link.velocity = link.start + jointAcceleration * h;
+		}
+	}
+	void Articulation::place()
+	{
+		for (size_t i = 1; i < m_links.size(); i++)
+		{
+			Link& link = m_links[i];
+			Body* parent = m_links[link.parent].body;
+			Body* body = link.body;
+			Vector2 joint = parent->toWorldPoint(link.localPointA);
+			if (link.type == ArticulationJointType::Revolute)
+			{
+				body->rotation() = parent->rotation() + link.reference + link.position;
+				//rotation about the joint point
+				link.motion.set(1, joint.y, -joint.x);
+			}
+			else
+			{
+				const Vector2 axis = Matrix2x2(parent->rotation()).multiply(link.localAxis);
+				joint += link.position * axis;
+				body->rotation() = parent->rotation() + link.reference;
+				link.motion.set(0, axis.x, axis.y);
+			}
+			body->position() = joint - Matrix2x2(body->rotation()).multiply(link.localPointB);
+		}
+		m_factored = false;
+	}
+	void Articulation::propagate()
+	{
+		m_links[0].spatialVelocity = motionOf(m_links[0].body);
+		for (size_t i = 1; i < m_links.size(); i++)
+		{
+			Link& link = m_links[i];
+			link.spatialVelocity = m_links[link.parent].spatialVelocity + link.motion * link.velocity;
+			link.body->angularVelocity() = link.spatialVelocity.x;
+			link.body->velocity() = pointVelocity(link.spatialVelocity, link.body->position());
+		}
+	}
+	void Articulation::factor()
+	{
+		for (Link& link : m_links)
+		{
+			link.inertia = inertiaOf(link.body);
+			link.articulatedInertia = link.inertia;
+		}
+		//leaves to root, IA of parent gains IA - U U^T / D of child
+		for (size_t i = m_links.size(); i-- > 1;)
+		{
+			Link& link = m_links[i];
+			link.inertiaMotion = link.articulatedInertia.multiply(link.motion);
+			link.pivot = link.motion.dot(link.inertiaMotion);
+			Matrix3x3 reduced = outer(link.inertiaMotion);
+			reduced /= -link.pivot;
+			reduced += link.articulatedInertia;
+			m_links[link.parent].articulatedInertia += reduced;
+		}
+		if (m_floating)
+		{
+			m_rootInverse = m_links[0].articulatedInertia;
+			Matrix3x3::invert(m_rootInverse);
+		}
+		m_factored = true;
+	}
+	Vector3 Articulation::rootResponse(const size_t& link, const Vector3& impulse)
+	{
+		//an impulse enters the bias force with opposite sign, velocity products vanish over an instant
+		Vector3 force = impulse * -1;
+		m_path.clear();
+		for (size_t i = link; i != 0; i = m_links[i].parent)
+		{
+			Link& other = m_links[i];
+			other.residual = -other.motion.dot(force);
+			force += other.inertiaMotion * (other.residual / other.pivot);
+			m_path.emplace_back(i);
+		}
+		if (!m_floating)
+			return Vector3();
+		return m_rootInverse.multiply(force) * -1;
+	}
+	Vector3 Articulation::frame() const
+	{
+		if (!m_floating)
+			return m_links[0].spatialVelocity;
+		//velocity of the tree frozen into one rigid body of the same momentum
+		Matrix3x3 inertia;
+		Vector3 momentum;
+		for (const Link& link : m_links)
+		{
+			inertia += link.inertia;
+			momentum += link.inertia.multiply(link.spatialVelocity);
+		}
+		Matrix3x3::invert(inertia);
+		return inertia.multiply(momentum);
+	}
+	Vector3 Articulation::momentum() const
+	{
+		Vector3 momentum;
+		for (const Link& link : m_links)
+			momentum += inertiaOf(link.body).multiply(link.spatialVelocity);
+		return momentum;
+	}
+	Vector3 Articulation::external() const
+	{
+		Vector3 force;
+		for (const Link& link : m_links)
+		{
+			Body* body = link.body;
+			force += forceAt(body->mass() * m_gravity + body->forces(), body->position(), body->torques());
+		}
+		return force;
+	}
+	real Articulation::kineticEnergy(const Vector3& frame) const
+	{
+		real energy = 0;
+		for (size_t i = m_floating ? 0 : 1; i < m_links.size(); i++)
+		{
+			const Vector3 velocity = m_links[i].spatialVelocity - frame;
+			energy += 0.5 * velocity.dot(m_links[i].inertia.multiply(velocity));
+		}
+		return energy;
+	}
+	real Articulation::potentialEnergy() const
+	{
+		real energy = 0;
+		for (size_t i = m_floating ? 0 : 1; i < m_links.size(); i++)
+			energy -= m_links[i].body->mass() * m_gravity.dot(m_links[i].body->position());
+		return energy;
+	}
+	real Articulation::power() const
+	{
+		real power = 0;
+		for (size_t i = m_floating ? 0 : 1; i < m_links.size(); i++)
+		{
+			const Link& link = m_links[i];
+			Body* body = link.body;
+			power += forceAt(body->forces(), body->position(), body->torques()).dot(link.spatialVelocity) + link.force * link.velocity;
+		}
+		return power;
+	}
+	void Articulation::limit()
+	{
+		//a moving fixed root works on the tree, energy is not tracked then
+		if (!m_floating && !m_links[0].spatialVelocity.isOrigin())
+		{
+			m_tracked = false;
+			return;
+		}
+		//energy above what the tree had plus work of forces and impulses is taken from motion relative to the frame
+		const real energy = kineticEnergy(Vector3()) + potentialEnergy();
+		//position correction and anything else acting since the tree was placed is not the integration
+		if (m_tracked)
+			m_energy += energy - m_placed;
+		if (m_tracked && energy > m_energy)
+		{
+			const Vector3 frame = this->frame();
+			const real relative = kineticEnergy(frame);
+			if (relative > 0)
+			{
+				const real scale = std::sqrt(Math::max(relative - (energy - m_energy), 0) / relative);
+				for (size_t i = 1; i < m_links.size(); i++)
+					m_links[i].velocity *= scale;
+				if (m_floating)
+				{
+					Link& root = m_links[0];
+					const Vector3 velocity = frame + (root.spatialVelocity - frame) * scale;
+					root.body->angularVelocity() = velocity.x;
+					root.body->velocity() = pointVelocity(velocity, root.body->position());
+				}
+				propagate();
+			}
+		}
+		//energy lost to the integration is kept, later steps may gain it back
+		if (!m_tracked)
+			m_energy = energy;
+		m_tracked = true;
+	}
+	void Articulation::moveRoot(const Vector3& velocityChange)
+	{
+		Body* root = m_links[0].body;
+		root->velocity() += pointVelocity(velocityChange, root->position());
+		root->angularVelocity() += velocityChange.x;
+	}
+}
@@ -179,19 +179,45 @@ namespace Physics2D {
         m_restitution = restitution;
     }
 
+    Articulation* Body::articulation() const
+    {
+        return m_articulation;
+    }
+
+    size_t Body::link() const
+    {
+        return m_link;
+    }
+
+    void Body::setArticulation(Articulation* articulation, const size_t& link)
+    {
+        m_articulation = articulation;
+        m_link = link;
+    }
+
     void Body::calcInertia()
     {
-        switch (m_shape->type()) {
+        m_inertia = calcInertia(m_shape.get(), m_mass);
+        if (realEqual(m_mass, Constant::Max))
+            m_invInertia = 0;
+        else
+			m_invInertia = !realEqual(m_inertia, 0) ? 1.0 / m_inertia : 0;
+    }
+
+    real Body::calcInertia(const Shape* shape, const real& mass)
+    {
+        real inertia = 0;
+        switch (shape->type()) {
         case Shape::Type::Circle:
         {
-            const Circle* circle = dynamic_cast<Circle*>(m_shape.get());
+            const Circle* circle = static_cast<const Circle*>(shape);
 
-            m_inertia = m_mass * circle->radius() * circle->radius() * (0.5f);
+            inertia = mass * circle->radius() * circle->radius() * (0.5f);
             break;
         }
         case Shape::Type::Polygon:
         {
-            const Polygon* polygon = dynamic_cast<Polygon*>(m_shape.get());
+            const Polygon* polygon = static_cast<const Polygon*>(shape);
 
             const Vector2 center = polygon->center();
             real sum1 = 0.0f;
@@ -201,28 +227,28 @@ namespace Physics2D {
             {
                 Vector2 n1 = polygon->vertices()[i] - center;
                 Vector2 n2 = polygon->vertices()[i + 1] - center;
-                real cross = abs(n1.cross(n2));
+                real cross = std::abs(n1.cross(n2));
                 real dot = n2.dot(n2) + n2.dot(n1) + n1.dot(n1);
                 sum1 += cross * dot;
                 sum2 += cross;
             }
 
-            m_inertia = (m_mass * (1.0f / 6.0f)) * sum1 / sum2;
+            inertia = (mass * (1.0f / 6.0f)) * sum1 / sum2;
             break;
         }
         case Shape::Type::Ellipse:
         {
-            const Ellipse* ellipse = dynamic_cast<Ellipse*>(m_shape.get());
+            const Ellipse* ellipse = static_cast<const Ellipse*>(shape);
 
             const real a = ellipse->A();
             const real b = ellipse->B();
-            m_inertia = m_mass * (a * a + b * b) * (1.0f / 5.0f);
+            inertia = mass * (a * a + b * b) * (1.0f / 5.0f);
 
             break;
         }
         case Shape::Type::Capsule:
         {
-            const Capsule* capsule = dynamic_cast<Capsule*>(m_shape.get());
+            const Capsule* capsule = static_cast<const Capsule*>(shape);
             real r = 0, h = 0, massS = 0, inertiaS = 0, massC = 0, inertiaC = 0, volume = 0;
         	
         	if(capsule->width() >= capsule->height())//Horizontal
@@ -237,21 +263,69 @@ namespace Physics2D {
             }
         		
             volume = Constant::Pi * r * r + h * 2 * r;
-            real rho = m_mass / volume;
+            real rho = mass / volume;
             massS = rho * Constant::Pi * r * r;
             massC = rho * h * 2 * r;
             inertiaC = (1.0 / 12.0) * massC * (h * h + (2 * r) * (2 * r));
             inertiaS = massS * r * r * 0.5;
-            m_inertia = inertiaC + inertiaS + massS * (3 * r + 2 * h) * h / 8.0;
+            inertia = inertiaC + inertiaS + massS * (3 * r + 2 * h) * h / 8.0;
+            break;
+        }
+        case Shape::Type::Compound:
+        {
+            //split mass by area and move inertia of every child to origin of compound
+            const Compound* compound = static_cast<const Compound*>(shape);
+            real totalArea = 0;
+            for (const ShapePrimitive& child : compound->children())
+                totalArea += calcArea(child.shape.get());
+
+            for (const ShapePrimitive& child : compound->children())
+            {
+                const real childMass = realEqual(totalArea, 0) ? mass / static_cast<real>(compound->children().size()) :
+                    mass * calcArea(child.shape.get()) / totalArea;
+                const Vector2 center = child.translate(child.shape->center());
+                inertia += calcInertia(child.shape.get(), childMass) + childMass * center.lengthSquare();
+            }
             break;
         }
         default:
             break;
         }
-        if (realEqual(m_mass, Constant::Max))
-            m_invInertia = 0;
-        else
-			m_invInertia = !realEqual(m_inertia, 0) ? 1.0 / m_inertia : 0;
+        return inertia;
+    }
+
+    real Body::calcArea(const Shape* shape)
+    {
+        switch (shape->type())
+        {
+        case Shape::Type::Circle:
+        {
+            const real radius = static_cast<const Circle*>(shape)->radius();
+            return Constant::Pi * radius * radius;
+        }
+        case Shape::Type::Polygon:
+        {
+            const std::vector<Vector2>& vertices = static_cast<const Polygon*>(shape)->vertices();
+            real area = 0;
+            for (size_t i = 0; i + 1 < vertices.size(); i++)
+                area += vertices[i].cross(vertices[i + 1]);
+            return std::abs(area) * 0.5;
+        }
+        case Shape::Type::Ellipse:
+        {
+            const Ellipse* ellipse = static_cast<const Ellipse*>(shape);
+            return Constant::Pi * ellipse->A() * ellipse->B();
+        }
+        case Shape::Type::Capsule:
+        {
+            const Capsule* capsule = static_cast<const Capsule*>(shape);
+            const real r = Math::min(capsule->width(), capsule->height()) / 2;
+            const real h = Math::max(capsule->width(), capsule->height()) - 2 * r;
+            return Constant::Pi * r * r + h * 2 * r;
+        }
+        default:
+            return 0;
+        }
     }
 
     void Body::PhysicsAttribute::step(const real& dt)
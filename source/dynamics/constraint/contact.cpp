@@ -1,106 +1,906 @@
 #include "include/dynamics/constraint/contact.h"
+#include "include/dynamics/articulation.h"
+#include <numeric>
+#ifdef PHYSICS2D_AVX2
+#include <immintrin.h>
+#endif
 
 namespace Physics2D
 {
 	RelationID generateRelation(Body* bodyA, Body* bodyB)
 	{
-		return std::stol(std::to_string(bodyA->id()) + std::to_string(bodyB->id()));
+		const uint64_t idA = static_cast<uint32_t>(bodyA->id());
+		const uint64_t idB = static_cast<uint32_t>(bodyB->id());
+		return idA < idB ? (idA << 32) | idB : (idB << 32) | idA;
 	}
-	
 
-	void ContactMaintainer::solve(real dt)
+	void ContactMaintainer::solve(real dt, Utils::WorkerPool* pool)
 	{
-		std::vector<int> removedList, clearList;
-		for (auto iter = m_contactTable.begin(); iter != m_contactTable.end(); ++iter)
+		compact();
+		pack(dt, m_blockSolve);
+		gather();
+		forEachBatch(pool, [this](ConstraintBatch& batch) { warmStart(batch); }, [this](ContactBlock& block) { warmStart(block); });
+		for (ArticulatedContact& contact : m_articulated)
+			warmStart(contact);
+
+		const bool adaptive = m_impulseTolerance > 0;
+		if (adaptive)
+			buildIslands();
+		int iterations = 0;
+		while (iterations < m_velocityIterations)
 		{
-			if (iter->second.size() == 0)
+			forEachBatch(pool, [this](ConstraintBatch& batch)
+				{
+					if (batch.active)
+						solveBatch(batch);
+				}, [this](ContactBlock& block)
+				{
+					if (block.active)
+						solveBlock(block);
+				});
+			real residual = 0;
+			for (ArticulatedContact& contact : m_articulated)
+				residual = Math::max(residual, solve(contact));
+			iterations++;
+			//contacts of articulations belong to no island, they converge as a whole
+			const bool articulatedConverged = iterations >= m_minVelocityIterations && residual < m_impulseTolerance;
+			if (adaptive && converge(iterations) && articulatedConverged)
+				break;
+		}
+
+		m_statistics = IterationStatistics();
+		m_statistics.maxIterations = iterations;
+		if (adaptive)
+		{
+			m_statistics.islands = m_islandIterations.size();
+			m_statistics.maxIterations = 0;
+			for (int& islandIterations : m_islandIterations)
 			{
-				clearList.push_back(iter->first);
-				continue;
+				//islands that did not converge ran until the cap
+				if (islandIterations == 0)
+					islandIterations = iterations;
+				m_statistics.iterations += islandIterations;
+				m_statistics.maxIterations = std::max(m_statistics.maxIterations, islandIterations);
 			}
+		}
+		scatter();
+		store();
+	}
 
-			for (auto iterInner = iter->second.begin(); iterInner != iter->second.end(); ++iterInner)
-				if (!iterInner->active)
-					removedList.push_back(iterInner->contactId);
-			for (auto id : removedList)
+	void ContactMaintainer::beginSubsteps(const real& h)
+	{
+		compact();
+		pack(h);
+		//springs stiffer than a quarter of the substep rate are not resolved by the substeps
+		m_softness = Softness::make(Math::min(m_contactHertz, 0.25 / h), m_contactDampingRatio, h);
+
+		//approaching velocity before any impulse of this step, restitution restores it at the end
+		gather();
+		for (ConstraintBatch& batch : m_batches)
+		{
+			for (size_t lane = 0; lane < batch.count; lane++)
 			{
-				for (auto removed = iter->second.begin(); removed != iter->second.end(); ++removed)
-				{
-					if (removed->contactId == id)
+				const int32_t a = batch.slotA[lane];
+				const int32_t b = batch.slotB[lane];
+				const real dvX = (m_velocityX[a] - m_angularVelocity[a] * batch.raY[lane]) - (m_velocityX[b] - m_angularVelocity[b] * batch.rbY[lane]);
+				const real dvY = (m_velocityY[a] + m_angularVelocity[a] * batch.raX[lane]) - (m_velocityY[b] + m_angularVelocity[b] * batch.rbX[lane]);
+				batch.relativeVelocity[lane] = batch.normalX[lane] * dvX + batch.normalY[lane] * dvY;
+			}
+		}
+		for (ArticulatedContact& contact : m_articulated)
+			contact.relativeVelocity = relative(contact, contact.point->vcp.normal);
+	}
+
+	void ContactMaintainer::solveSubstep(const real& h, const bool& useBias, Utils::WorkerPool* pool)
+	{
+		gather();
+		if (useBias)
+		{
+			forEachBatch(pool, [this](ConstraintBatch& batch) { warmStart(batch); });
+			for (ArticulatedContact& contact : m_articulated)
+				warmStart(contact);
+		}
+		forEachBatch(pool, [&](ConstraintBatch& batch)
+			{
+				soften(batch, h, useBias);
+				solveBatch(batch);
+			});
+		for (ArticulatedContact& contact : m_articulated)
+		{
+			soften(contact, h, useBias);
+			solve(contact);
+		}
+		scatter();
+	}
+
+	void ContactMaintainer::endSubsteps(Utils::WorkerPool* pool)
+	{
+		gather();
+		forEachBatch(pool, [this](ConstraintBatch& batch) { restitute(batch); });
+		for (ArticulatedContact& contact : m_articulated)
+			restitute(contact);
+		scatter();
+		store();
+	}
+
+	void ContactMaintainer::solvePosition(Utils::WorkerPool* pool)
+	{
+		if (!m_positionCorrection)
+			return;
+		//contacts of last solve are kept until the next one, colors still hold
+		forEachBatch(pool, [this](ConstraintBatch& batch)
+			{
+				for (size_t lane = 0; lane < batch.count; lane++)
+					correct(*batch.points[lane]);
+			}, [this](ContactBlock& block)
+			{
+				correct(*block.points[0]);
+				correct(*block.points[1]);
+			});
+	}
+
+	void ContactMaintainer::buildIslands()
+	{
+		const size_t bodies = m_graph.bodies().size();
+		m_islandParent.resize(bodies);
+		std::iota(m_islandParent.begin(), m_islandParent.end(), 0);
+		auto find = [this](int32_t slot)
+		{
+			while (m_islandParent[slot] != slot)
+			{
+				m_islandParent[slot] = m_islandParent[m_islandParent[slot]];
+				slot = m_islandParent[slot];
+			}
+			return slot;
+		};
+		//bodies that can not move do not join islands, a ground under two stacks keeps them apart
+		auto unite = [&](const int32_t& slotA, const int32_t& slotB)
+		{
+			if (m_graph.movable(slotA) && m_graph.movable(slotB))
+				m_islandParent[find(slotA)] = find(slotB);
+		};
+		for (const ConstraintBatch& batch : m_batches)
+			for (size_t lane = 0; lane < batch.count; lane++)
+				unite(batch.slotA[lane], batch.slotB[lane]);
+		for (const ContactBlock& block : m_blocks)
+			unite(block.slotA, block.slotB);
+
+		m_islandIndex.assign(bodies, -1);
+		int32_t islands = 0;
+		auto number = [&](const int32_t& slotA, const int32_t& slotB)
+		{
+			int32_t& index = m_islandIndex[find(m_graph.movable(slotA) ? slotA : slotB)];
+			if (index < 0)
+				index = islands++;
+			return index;
+		};
+		for (ConstraintBatch& batch : m_batches)
+			for (size_t lane = 0; lane < batch.count; lane++)
+				batch.island[lane] = number(batch.slotA[lane], batch.slotB[lane]);
+		for (ContactBlock& block : m_blocks)
+			block.island = number(block.slotA, block.slotB);
+
+		m_islandResidual.assign(islands, 0);
+		m_islandIterations.assign(islands, 0);
+	}
+
+	bool ContactMaintainer::converge(const int& iterations)
+	{
+		std::fill(m_islandResidual.begin(), m_islandResidual.end(), 0);
+		for (const ConstraintBatch& batch : m_batches)
+		{
+			if (!batch.active)
+				continue;
+			for (size_t lane = 0; lane < batch.count; lane++)
+				m_islandResidual[batch.island[lane]] = Math::max(m_islandResidual[batch.island[lane]], batch.residual[lane]);
+		}
+		for (const ContactBlock& block : m_blocks)
+			if (block.active)
+				m_islandResidual[block.island] = Math::max(m_islandResidual[block.island], block.residual);
+
+		bool converged = true;
+		for (size_t i = 0; i < m_islandResidual.size(); i++)
+		{
+			if (m_islandIterations[i] != 0)
+				continue;
+			if (iterations >= m_minVelocityIterations && m_islandResidual[i] < m_impulseTolerance)
+				m_islandIterations[i] = iterations;
+			else
+				converged = false;
+		}
+		if (converged)
+			return true;
+
+		//a batch keeps solving while any of its lanes belongs to an island still iterating
+		for (ConstraintBatch& batch : m_batches)
+		{
+			if (!batch.active)
+				continue;
+			batch.active = false;
+			for (size_t lane = 0; lane < batch.count; lane++)
+				batch.active = batch.active || m_islandIterations[batch.island[lane]] == 0;
+		}
+		for (ContactBlock& block : m_blocks)
+			block.active = m_islandIterations[block.island] == 0;
+		return false;
+	}
+
+	void ContactMaintainer::forEachBatch(Utils::WorkerPool* pool, const std::function<void(ConstraintBatch&)>& task,
+		const std::function<void(ContactBlock&)>& blockTask)
+	{
+		//colors run one after another, batches and blocks of one color touch disjoint bodies
+		for (size_t color = 0; color < ConstraintGraph::Overflow; color++)
+		{
+			const size_t begin = m_colorBatches[color];
+			const size_t batches = m_colorBatches[color + 1] - begin;
+			const size_t blockBegin = m_colorBlocks[color];
+			const size_t blocks = blockTask ? m_colorBlocks[color + 1] - blockBegin : 0;
+			auto run = [&](size_t i)
+			{
+				if (i < batches)
+					task(m_batches[begin + i]);
+				else
+					blockTask(m_blocks[blockBegin + i - batches]);
+			};
+			if (pool != nullptr && batches + blocks >= ParallelBatches)
+			{
+				pool->forEach(batches + blocks, [&](size_t first, size_t last, size_t)
 					{
-						iter->second.erase(removed);
-						break;
-					}
-				}
+						for (size_t i = first; i < last; i++)
+							run(i);
+					});
+				continue;
+			}
+			for (size_t i = 0; i < batches + blocks; i++)
+				run(i);
+		}
+		for (size_t i = m_colorBatches[ConstraintGraph::Overflow]; i < m_batches.size(); i++)
+			task(m_batches[i]);
+		if (blockTask)
+			for (size_t i = m_colorBlocks[ConstraintGraph::Overflow]; i < m_blocks.size(); i++)
+				blockTask(m_blocks[i]);
+	}
+
+	void ContactMaintainer::gather()
+	{
+		const std::vector<Body*>& bodies = m_graph.bodies();
+		m_velocityX.assign(bodies.size(), 0);
+		m_velocityY.assign(bodies.size(), 0);
+		m_angularVelocity.assign(bodies.size(), 0);
+		for (size_t i = 1; i < bodies.size(); i++)
+		{
+			m_velocityX[i] = bodies[i]->velocity().x;
+			m_velocityY[i] = bodies[i]->velocity().y;
+			m_angularVelocity[i] = bodies[i]->angularVelocity();
+		}
+	}
+
+	void ContactMaintainer::scatter()
+	{
+		const std::vector<Body*>& bodies = m_graph.bodies();
+		for (size_t i = 1; i < bodies.size(); i++)
+		{
+			if (!m_graph.movable(static_cast<int32_t>(i)))
+				continue;
+			bodies[i]->velocity().set(m_velocityX[i], m_velocityY[i]);
+			bodies[i]->angularVelocity() = m_angularVelocity[i];
+		}
+	}
+
+	void ContactMaintainer::store()
+	{
+		for (ConstraintBatch& batch : m_batches)
+		{
+			for (size_t lane = 0; lane < batch.count; lane++)
+			{
+				ContactConstraintPoint* ccp = batch.points[lane];
+				ccp->vcp.accumulatedNormalImpulse = batch.normalImpulse[lane];
+				ccp->vcp.accumulatedTangentImpulse = batch.tangentImpulse[lane];
+				ccp->active = false;
+			}
+		}
+		//impulses of blocks are solved in place
+		for (ContactBlock& block : m_blocks)
+		{
+			block.points[0]->active = false;
+			block.points[1]->active = false;
+		}
+		for (ArticulatedContact& contact : m_articulated)
+			contact.point->active = false;
+	}
+
+	void ContactMaintainer::warmStart(ConstraintBatch& batch)
+	{
+		for (size_t lane = 0; lane < batch.count; lane++)
+		{
+			const real pX = batch.normalImpulse[lane] * batch.normalX[lane] + batch.tangentImpulse[lane] * batch.tangentX[lane];
+			const real pY = batch.normalImpulse[lane] * batch.normalY[lane] + batch.tangentImpulse[lane] * batch.tangentY[lane];
+			const int32_t a = batch.slotA[lane];
+			const int32_t b = batch.slotB[lane];
+			if (m_graph.movable(a))
+			{
+				m_velocityX[a] += batch.invMassA[lane] * pX;
+				m_velocityY[a] += batch.invMassA[lane] * pY;
+				m_angularVelocity[a] += batch.invInertiaA[lane] * (batch.raX[lane] * pY - batch.raY[lane] * pX);
+			}
+			if (m_graph.movable(b))
+			{
+				m_velocityX[b] -= batch.invMassB[lane] * pX;
+				m_velocityY[b] -= batch.invMassB[lane] * pY;
+				m_angularVelocity[b] -= batch.invInertiaB[lane] * (batch.rbX[lane] * pY - batch.rbY[lane] * pX);
 			}
-			removedList.clear();
 		}
+	}
 
-		for(auto id: clearList)
+	void ContactMaintainer::warmStart(ContactBlock& block)
+	{
+		const int32_t a = block.slotA;
+		const int32_t b = block.slotB;
+		for (const ContactConstraintPoint* ccp : block.points)
 		{
-			for (auto iter = m_contactTable.begin(); iter != m_contactTable.end(); ++iter)
+			const VelocityConstraintPoint& vcp = ccp->vcp;
+			const Vector2 impulse = vcp.accumulatedNormalImpulse * vcp.normal + vcp.accumulatedTangentImpulse * vcp.tangent;
+			if (m_graph.movable(a))
 			{
-				if(iter->first == id)
-				{
-					m_contactTable.erase(iter);
-					break;
-				}
+				m_velocityX[a] += block.invMassA * impulse.x;
+				m_velocityY[a] += block.invMassA * impulse.y;
+				m_angularVelocity[a] += block.invInertiaA * vcp.ra.cross(impulse);
+			}
+			if (m_graph.movable(b))
+			{
+				m_velocityX[b] -= block.invMassB * impulse.x;
+				m_velocityY[b] -= block.invMassB * impulse.y;
+				m_angularVelocity[b] -= block.invInertiaB * vcp.rb.cross(impulse);
+			}
+		}
+	}
+
+	void ContactMaintainer::warmStart(ArticulatedContact& contact)
+	{
+		const VelocityConstraintPoint& vcp = contact.point->vcp;
+		apply(contact, vcp.accumulatedNormalImpulse * vcp.normal + vcp.accumulatedTangentImpulse * vcp.tangent);
+	}
+
+	void ContactMaintainer::soften(ConstraintBatch& batch, const real& h, const bool& useBias)
+	{
+		for (size_t lane = 0; lane < batch.count; lane++)
+			soften(*batch.points[lane], h, useBias, batch.target[lane], batch.restitution[lane], batch.massScale[lane], batch.impulseScale[lane]);
+	}
+
+	void ContactMaintainer::soften(ArticulatedContact& contact, const real& h, const bool& useBias)
+	{
+		soften(*contact.point, h, useBias, contact.target, contact.restitution, contact.massScale, contact.impulseScale);
+	}
+
+	void ContactMaintainer::soften(const ContactConstraintPoint& ccp, const real& h, const bool& useBias, real& target, real& restitution, real& massScale, real& impulseScale) const
+	{
+		//separation at current positions, anchors stay on the bodies and the normal is kept from detection
+		const real separation = (ccp.bodyA->toWorldPoint(ccp.localA) - ccp.bodyB->toWorldPoint(ccp.localB)).dot(ccp.vcp.normal);
+
+		restitution = 1;
+		massScale = 1;
+		impulseScale = 0;
+		if (separation > 0)
+		{
+			//speculative: allow to approach until touching within this substep
+			target = -separation / h;
+		}
+		else if (useBias)
+		{
+			target = Math::min(-m_softness.biasRate * separation, m_maxBiasVelocity);
+			massScale = m_softness.massScale;
+			impulseScale = m_softness.impulseScale;
+		}
+		else
+			target = 0;
+	}
+
+	void ContactMaintainer::restitute(ConstraintBatch& batch)
+	{
+		for (size_t lane = 0; lane < batch.count; lane++)
+		{
+			const ContactConstraintPoint* ccp = batch.points[lane];
+			const real restitution = Math::min(ccp->bodyA->restitution(), ccp->bodyB->restitution());
+			if (restitution == 0 || batch.relativeVelocity[lane] > -m_restitutionThreshold || batch.normalImpulse[lane] == 0)
+				continue;
+
+			const int32_t a = batch.slotA[lane];
+			const int32_t b = batch.slotB[lane];
+			const real dvX = (m_velocityX[a] - m_angularVelocity[a] * batch.raY[lane]) - (m_velocityX[b] - m_angularVelocity[b] * batch.rbY[lane]);
+			const real dvY = (m_velocityY[a] + m_angularVelocity[a] * batch.raX[lane]) - (m_velocityY[b] + m_angularVelocity[b] * batch.rbX[lane]);
+			const real jv = batch.normalX[lane] * dvX + batch.normalY[lane] * dvY;
+
+			const real oldImpulse = batch.normalImpulse[lane];
+			batch.normalImpulse[lane] = Math::max(oldImpulse - batch.massNormal[lane] * (jv + restitution * batch.relativeVelocity[lane]), 0);
+			const real lambda = batch.normalImpulse[lane] - oldImpulse;
+			const real pX = lambda * batch.normalX[lane];
+			const real pY = lambda * batch.normalY[lane];
+			if (m_graph.movable(a))
+			{
+				m_velocityX[a] += batch.invMassA[lane] * pX;
+				m_velocityY[a] += batch.invMassA[lane] * pY;
+				m_angularVelocity[a] += batch.invInertiaA[lane] * (batch.raX[lane] * pY - batch.raY[lane] * pX);
+			}
+			if (m_graph.movable(b))
+			{
+				m_velocityX[b] -= batch.invMassB[lane] * pX;
+				m_velocityY[b] -= batch.invMassB[lane] * pY;
+				m_angularVelocity[b] -= batch.invInertiaB[lane] * (batch.rbX[lane] * pY - batch.rbY[lane] * pX);
 			}
 		}
+	}
+
+	void ContactMaintainer::restitute(ArticulatedContact& contact)
+	{
+		const ContactConstraintPoint* ccp = contact.point;
+		VelocityConstraintPoint& vcp = contact.point->vcp;
+		const real restitution = Math::min(ccp->bodyA->restitution(), ccp->bodyB->restitution());
+		if (restitution == 0 || contact.relativeVelocity > -m_restitutionThreshold || vcp.accumulatedNormalImpulse == 0)
+			return;
+
+		const real jv = relative(contact, vcp.normal);
+		const real oldImpulse = vcp.accumulatedNormalImpulse;
+		vcp.accumulatedNormalImpulse = Math::max(oldImpulse - vcp.effectiveMassNormal * (jv + restitution * contact.relativeVelocity), 0);
+		apply(contact, (vcp.accumulatedNormalImpulse - oldImpulse) * vcp.normal);
+	}
+
+	void ContactMaintainer::correct(ContactConstraintPoint& ccp)
+	{
+		Body* bodyA = ccp.bodyA;
+		Body* bodyB = ccp.bodyB;
+		const Vector2& normal = ccp.vcp.normal;
+		const Vector2 pa = bodyA->toWorldPoint(ccp.localA);
+		const Vector2 pb = bodyB->toWorldPoint(ccp.localB);
+		const real separation = (pa - pb).dot(normal);
+		const real c = Math::clamp(m_biasFactor * (separation + m_maxPenetration), -m_maxLinearCorrection, 0);
+		if (c == 0)
+			return;
 
-		
+		//only dynamic bodies and bullets are integrated, others keep their place
+		const bool movableA = bodyA->type() == Body::BodyType::Dynamic || bodyA->type() == Body::BodyType::Bullet;
+		const bool movableB = bodyB->type() == Body::BodyType::Dynamic || bodyB->type() == Body::BodyType::Bullet;
+		const real im_a = movableA ? bodyA->inverseMass() : 0;
+		const real ii_a = movableA ? bodyA->inverseInertia() : 0;
+		const real im_b = movableB ? bodyB->inverseMass() : 0;
+		const real ii_b = movableB ? bodyB->inverseInertia() : 0;
+		const Vector2 ra = pa - bodyA->position();
+		const Vector2 rb = pb - bodyB->position();
+		const real rn_a = ra.cross(normal);
+		const real rn_b = rb.cross(normal);
+		const real k = im_a + ii_a * rn_a * rn_a + im_b + ii_b * rn_b * rn_b;
+		if (realEqual(k, 0.0))
+			return;
 
-		for (auto iter = m_contactTable.begin(); iter != m_contactTable.end(); ++iter)
+		const Vector2 impulse = (-c / k) * normal;
+		bodyA->position() += im_a * impulse;
+		bodyA->rotation() += ii_a * ra.cross(impulse);
+		bodyB->position() -= im_b * impulse;
+		bodyB->rotation() -= ii_b * rb.cross(impulse);
+	}
+
+	void ContactMaintainer::pack(real dt, const bool& blocks)
+	{
+		//larger condition estimate of the block means impulses blow up, solve such blocks point by point
+		constexpr real maxCondition = 1000;
+
+		m_graph.reset(2 * m_pairs.size());
+		m_colored.resize(ConstraintGraph::Overflow + 1);
+		for (auto& points : m_colored)
+			points.clear();
+		m_coloredBlocks.resize(ConstraintGraph::Overflow + 1);
+		for (auto& colored : m_coloredBlocks)
+			colored.clear();
+		m_articulated.clear();
+
+		for (ContactPair& contactPair : m_pairs)
 		{
-			if (iter->second.size() == 0 || !iter->second[0].active)
+			//all contacts of a pair share the bodies
+			const ContactConstraintPoint& first = contactPair.contacts.front();
+			if (first.bodyA->articulation() != nullptr || first.bodyB->articulation() != nullptr)
+			{
+				for (ContactConstraintPoint& ccp : contactPair.contacts)
+					if (ccp.active)
+						pack(ccp, dt);
 				continue;
+			}
+			//compact left active contacts only, all of them come from the same collision
+			if (blocks && contactPair.contacts.size() == 2)
+			{
+				ContactBlock block;
+				block.points[0] = &contactPair.contacts[0];
+				block.points[1] = &contactPair.contacts[1];
+				Body* bodyA = block.points[0]->bodyA;
+				Body* bodyB = block.points[0]->bodyB;
+				block.slotA = m_graph.slot(bodyA);
+				block.slotB = m_graph.slot(bodyB);
+				block.invMassA = bodyA->inverseMass();
+				block.invInertiaA = bodyA->inverseInertia();
+				block.invMassB = bodyB->inverseMass();
+				block.invInertiaB = bodyB->inverseInertia();
+
+				const VelocityConstraintPoint& vcp1 = block.points[0]->vcp;
+				const VelocityConstraintPoint& vcp2 = block.points[1]->vcp;
+				block.target[0] = (vcp1.bias - vcp1.separation) / dt + vcp1.bounce;
+				block.target[1] = (vcp2.bias - vcp2.separation) / dt + vcp2.bounce;
+
+				const real rn1a = vcp1.ra.cross(vcp1.normal);
+				const real rn1b = vcp1.rb.cross(vcp1.normal);
+				const real rn2a = vcp2.ra.cross(vcp2.normal);
+				const real rn2b = vcp2.rb.cross(vcp2.normal);
+				const real mass = block.invMassA + block.invMassB;
+				block.k11 = mass + block.invInertiaA * rn1a * rn1a + block.invInertiaB * rn1b * rn1b;
+				block.k22 = mass + block.invInertiaA * rn2a * rn2a + block.invInertiaB * rn2b * rn2b;
+				block.k12 = mass + block.invInertiaA * rn1a * rn2a + block.invInertiaB * rn1b * rn2b;
+				if (block.k11 * block.k11 < maxCondition * (block.k11 * block.k22 - block.k12 * block.k12))
+				{
+					block.normalMass = Matrix2x2(block.k11, block.k12, block.k12, block.k22);
+					block.coupled = block.normalMass.invert(block.normalMass);
+				}
+				m_coloredBlocks[m_graph.color(block.slotA, block.slotB)].emplace_back(block);
+				continue;
+			}
+			for (ContactConstraintPoint& ccp : contactPair.contacts)
+			{
+				if (!ccp.active)
+					continue;
+				const int32_t slotA = m_graph.slot(ccp.bodyA);
+				const int32_t slotB = m_graph.slot(ccp.bodyB);
+				m_colored[m_graph.color(slotA, slotB)].emplace_back(&ccp, slotA, slotB);
+			}
+		}
 
-			for(auto& ccp: iter->second)
+		//any lanes of one color are free of conflicts. overflow contacts may conflict, they take one batch each
+		m_batches.clear();
+		m_colorBatches.clear();
+		for (size_t color = 0; color <= ConstraintGraph::Overflow; color++)
+		{
+			m_colorBatches.emplace_back(m_batches.size());
+			const size_t lanes = color == ConstraintGraph::Overflow ? 1 : Lanes;
+			const auto& points = m_colored[color];
+			for (size_t i = 0; i < points.size(); i++)
 			{
-				auto& vcp = ccp.vcp;
+				if (i % lanes == 0)
+					m_batches.emplace_back();
+
+				ConstraintBatch& batch = m_batches.back();
+				const auto& [ccp, slotA, slotB] = points[i];
+				const VelocityConstraintPoint& vcp = ccp->vcp;
+				const size_t lane = batch.count++;
+				batch.points[lane] = ccp;
+				batch.slotA[lane] = slotA;
+				batch.slotB[lane] = slotB;
+				batch.raX[lane] = vcp.ra.x;
+				batch.raY[lane] = vcp.ra.y;
+				batch.rbX[lane] = vcp.rb.x;
+				batch.rbY[lane] = vcp.rb.y;
+				batch.normalX[lane] = vcp.normal.x;
+				batch.normalY[lane] = vcp.normal.y;
+				batch.tangentX[lane] = vcp.tangent.x;
+				batch.tangentY[lane] = vcp.tangent.y;
+				batch.invMassA[lane] = ccp->bodyA->inverseMass();
+				batch.invInertiaA[lane] = ccp->bodyA->inverseInertia();
+				batch.invMassB[lane] = ccp->bodyB->inverseMass();
+				batch.invInertiaB[lane] = ccp->bodyB->inverseInertia();
+				batch.massNormal[lane] = vcp.effectiveMassNormal;
+				batch.massTangent[lane] = vcp.effectiveMassTangent;
+				batch.restitution[lane] = vcp.restitution;
+				batch.target[lane] = (vcp.bias - vcp.separation) / dt + vcp.bounce;
+				batch.massScale[lane] = 1;
+				batch.impulseScale[lane] = 0;
+				batch.friction[lane] = ccp->friction;
+				batch.normalImpulse[lane] = vcp.accumulatedNormalImpulse;
+				batch.tangentImpulse[lane] = vcp.accumulatedTangentImpulse;
+			}
+		}
+		m_colorBatches.emplace_back(m_batches.size());
+
+		m_blocks.clear();
+		m_colorBlocks.clear();
+		for (const auto& colored : m_coloredBlocks)
+		{
+			m_colorBlocks.emplace_back(m_blocks.size());
+			m_blocks.insert(m_blocks.end(), colored.begin(), colored.end());
+		}
+		m_colorBlocks.emplace_back(m_blocks.size());
+	}
+
+	void ContactMaintainer::pack(ContactConstraintPoint& ccp, const real& dt)
+	{
+		VelocityConstraintPoint& vcp = ccp.vcp;
+		auto response = [](Body* body, const Vector2& r, const Vector2& axis)
+		{
+			if (body->articulation() != nullptr)
+				return body->articulation()->inverseMass(body->link(), body->position() + r, axis);
+			const real rn = r.cross(axis);
+			return body->inverseMass() + body->inverseInertia() * rn * rn;
+		};
+		const real kNormal = response(ccp.bodyA, vcp.ra, vcp.normal) + response(ccp.bodyB, vcp.rb, vcp.normal);
+		const real kTangent = response(ccp.bodyA, vcp.ra, vcp.tangent) + response(ccp.bodyB, vcp.rb, vcp.tangent);
+		vcp.effectiveMassNormal = realEqual(kNormal, 0.0) ? 0 : 1.0 / kNormal;
+		vcp.effectiveMassTangent = realEqual(kTangent, 0.0) ? 0 : 1.0 / kTangent;
+
+		ArticulatedContact contact;
+		contact.point = &ccp;
+		contact.slotA = ccp.bodyA->articulation() != nullptr ? 0 : m_graph.slot(ccp.bodyA);
+		contact.slotB = ccp.bodyB->articulation() != nullptr ? 0 : m_graph.slot(ccp.bodyB);
+		contact.target = (vcp.bias - vcp.separation) / dt + vcp.bounce;
+		contact.restitution = vcp.restitution;
+		m_articulated.emplace_back(contact);
+	}
+
+	void ContactMaintainer::solveBatch(ConstraintBatch& batch)
+	{
+		//linear x, linear y and angular velocity of body a, then of body b
+		alignas(32) real velocity[6][Lanes];
+#ifdef PHYSICS2D_AVX2
+		const __m128i slotA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(batch.slotA));
+		const __m128i slotB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(batch.slotB));
+		__m256d va_x = _mm256_i32gather_pd(m_velocityX.data(), slotA, 8);
+		__m256d va_y = _mm256_i32gather_pd(m_velocityY.data(), slotA, 8);
+		__m256d w_a = _mm256_i32gather_pd(m_angularVelocity.data(), slotA, 8);
+		__m256d vb_x = _mm256_i32gather_pd(m_velocityX.data(), slotB, 8);
+		__m256d vb_y = _mm256_i32gather_pd(m_velocityY.data(), slotB, 8);
+		__m256d w_b = _mm256_i32gather_pd(m_angularVelocity.data(), slotB, 8);
+
+		const __m256d ra_x = _mm256_loadu_pd(batch.raX), ra_y = _mm256_loadu_pd(batch.raY);
+		const __m256d rb_x = _mm256_loadu_pd(batch.rbX), rb_y = _mm256_loadu_pd(batch.rbY);
+		const __m256d im_a = _mm256_loadu_pd(batch.invMassA), ii_a = _mm256_loadu_pd(batch.invInertiaA);
+		const __m256d im_b = _mm256_loadu_pd(batch.invMassB), ii_b = _mm256_loadu_pd(batch.invInertiaB);
+
+		//relative velocity of contact points projected on axis
+		auto relative = [&](const __m256d& x, const __m256d& y)
+		{
+			const __m256d dv_x = _mm256_sub_pd(_mm256_sub_pd(va_x, _mm256_mul_pd(w_a, ra_y)), _mm256_sub_pd(vb_x, _mm256_mul_pd(w_b, rb_y)));
+			const __m256d dv_y = _mm256_sub_pd(_mm256_add_pd(va_y, _mm256_mul_pd(w_a, ra_x)), _mm256_add_pd(vb_y, _mm256_mul_pd(w_b, rb_x)));
+			return _mm256_add_pd(_mm256_mul_pd(x, dv_x), _mm256_mul_pd(y, dv_y));
+		};
+		auto apply = [&](const __m256d& lambda, const __m256d& x, const __m256d& y)
+		{
+			const __m256d p_x = _mm256_mul_pd(lambda, x);
+			const __m256d p_y = _mm256_mul_pd(lambda, y);
+			va_x = _mm256_add_pd(va_x, _mm256_mul_pd(im_a, p_x));
+			va_y = _mm256_add_pd(va_y, _mm256_mul_pd(im_a, p_y));
+			w_a = _mm256_add_pd(w_a, _mm256_mul_pd(ii_a, _mm256_sub_pd(_mm256_mul_pd(ra_x, p_y), _mm256_mul_pd(ra_y, p_x))));
+			vb_x = _mm256_sub_pd(vb_x, _mm256_mul_pd(im_b, p_x));
+			vb_y = _mm256_sub_pd(vb_y, _mm256_mul_pd(im_b, p_y));
+			w_b = _mm256_sub_pd(w_b, _mm256_mul_pd(ii_b, _mm256_sub_pd(_mm256_mul_pd(rb_x, p_y), _mm256_mul_pd(rb_y, p_x))));
+		};
 
+		const __m256d n_x = _mm256_loadu_pd(batch.normalX), n_y = _mm256_loadu_pd(batch.normalY);
+		const __m256d jv = relative(n_x, n_y);
+		const __m256d jvb = _mm256_sub_pd(_mm256_loadu_pd(batch.target), _mm256_mul_pd(_mm256_loadu_pd(batch.restitution), jv));
+		__m256d oldImpulse = _mm256_loadu_pd(batch.normalImpulse);
+		const __m256d lambda = _mm256_sub_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_loadu_pd(batch.massNormal), _mm256_loadu_pd(batch.massScale)), jvb), _mm256_mul_pd(_mm256_loadu_pd(batch.impulseScale), oldImpulse));
+		const __m256d normalImpulse = _mm256_max_pd(_mm256_add_pd(oldImpulse, lambda), _mm256_setzero_pd());
+		_mm256_storeu_pd(batch.normalImpulse, normalImpulse);
+		const __m256d normalDelta = _mm256_sub_pd(normalImpulse, oldImpulse);
+		apply(normalDelta, n_x, n_y);
 
-				Vector2 wa = Vector2::crossProduct(ccp.bodyA->angularVelocity(), vcp.ra);
-				Vector2 wb = Vector2::crossProduct(ccp.bodyB->angularVelocity(), vcp.rb);
-				vcp.va = ccp.bodyA->velocity() + wa;
-				vcp.vb = ccp.bodyB->velocity() + wb;
+		const __m256d t_x = _mm256_loadu_pd(batch.tangentX), t_y = _mm256_loadu_pd(batch.tangentY);
+		const __m256d jvt = relative(t_x, t_y);
+		const __m256d maxT = _mm256_mul_pd(_mm256_loadu_pd(batch.friction), normalImpulse);
+		oldImpulse = _mm256_loadu_pd(batch.tangentImpulse);
+		__m256d tangentImpulse = _mm256_sub_pd(oldImpulse, _mm256_mul_pd(_mm256_loadu_pd(batch.massTangent), jvt));
+		tangentImpulse = _mm256_min_pd(_mm256_max_pd(tangentImpulse, _mm256_sub_pd(_mm256_setzero_pd(), maxT)), maxT);
+		_mm256_storeu_pd(batch.tangentImpulse, tangentImpulse);
+		const __m256d tangentDelta = _mm256_sub_pd(tangentImpulse, oldImpulse);
+		apply(tangentDelta, t_x, t_y);
 
-				Vector2 dv = vcp.va - vcp.vb;
-				real jv = vcp.normal.dot(dv);
-				real jvb = - vcp.restitution * jv + vcp.bias;
-				real lambda_n = vcp.effectiveMassNormal * jvb;
-				real oldImpulse = vcp.accumulatedNormalImpulse;
-				vcp.accumulatedNormalImpulse = Math::max(oldImpulse + lambda_n, 0);
-				lambda_n = vcp.accumulatedNormalImpulse - oldImpulse;
+		//clearing sign bits gives absolute values
+		const __m256d sign = _mm256_set1_pd(-0.0);
+		_mm256_storeu_pd(batch.residual, _mm256_max_pd(_mm256_andnot_pd(sign, normalDelta), _mm256_andnot_pd(sign, tangentDelta)));
 
-				Vector2 impulse_n = lambda_n * vcp.normal;
+		_mm256_store_pd(velocity[0], va_x);
+		_mm256_store_pd(velocity[1], va_y);
+		_mm256_store_pd(velocity[2], w_a);
+		_mm256_store_pd(velocity[3], vb_x);
+		_mm256_store_pd(velocity[4], vb_y);
+		_mm256_store_pd(velocity[5], w_b);
+#else
+		//same arithmetic lane by lane
+		for (size_t lane = 0; lane < Lanes; lane++)
+		{
+			real& vaX = velocity[0][lane] = m_velocityX[batch.slotA[lane]];
+			real& vaY = velocity[1][lane] = m_velocityY[batch.slotA[lane]];
+			real& wa = velocity[2][lane] = m_angularVelocity[batch.slotA[lane]];
+			real& vbX = velocity[3][lane] = m_velocityX[batch.slotB[lane]];
+			real& vbY = velocity[4][lane] = m_velocityY[batch.slotB[lane]];
+			real& wb = velocity[5][lane] = m_angularVelocity[batch.slotB[lane]];
+
+			auto relative = [&](const real& x, const real& y)
+			{
+				const real dvX = (vaX - wa * batch.raY[lane]) - (vbX - wb * batch.rbY[lane]);
+				const real dvY = (vaY + wa * batch.raX[lane]) - (vbY + wb * batch.rbX[lane]);
+				return x * dvX + y * dvY;
+			};
+			auto apply = [&](const real& lambda, const real& x, const real& y)
+			{
+				const real pX = lambda * x;
+				const real pY = lambda * y;
+				vaX += batch.invMassA[lane] * pX;
+				vaY += batch.invMassA[lane] * pY;
+				wa += batch.invInertiaA[lane] * (batch.raX[lane] * pY - batch.raY[lane] * pX);
+				vbX -= batch.invMassB[lane] * pX;
+				vbY -= batch.invMassB[lane] * pY;
+				wb -= batch.invInertiaB[lane] * (batch.rbX[lane] * pY - batch.rbY[lane] * pX);
+			};
 
-				ccp.bodyA->applyImpulse(impulse_n, vcp.ra);
-				ccp.bodyB->applyImpulse(-impulse_n, vcp.rb);
+			const real jv = relative(batch.normalX[lane], batch.normalY[lane]);
+			const real jvb = batch.target[lane] - batch.restitution[lane] * jv;
+			real oldImpulse = batch.normalImpulse[lane];
+			batch.normalImpulse[lane] = Math::max(oldImpulse + batch.massNormal[lane] * batch.massScale[lane] * jvb - batch.impulseScale[lane] * oldImpulse, 0);
+			apply(batch.normalImpulse[lane] - oldImpulse, batch.normalX[lane], batch.normalY[lane]);
+			batch.residual[lane] = std::fabs(batch.normalImpulse[lane] - oldImpulse);
 
-				vcp.va = ccp.bodyA->velocity() + Vector2::crossProduct(ccp.bodyA->angularVelocity(), vcp.ra);
-				vcp.vb = ccp.bodyB->velocity() + Vector2::crossProduct(ccp.bodyB->angularVelocity(), vcp.rb);
-				dv = vcp.va - vcp.vb;
+			const real jvt = relative(batch.tangentX[lane], batch.tangentY[lane]);
+			const real maxT = batch.friction[lane] * batch.normalImpulse[lane];
+			oldImpulse = batch.tangentImpulse[lane];
+			batch.tangentImpulse[lane] = Math::clamp(oldImpulse - batch.massTangent[lane] * jvt, -maxT, maxT);
+			apply(batch.tangentImpulse[lane] - oldImpulse, batch.tangentX[lane], batch.tangentY[lane]);
+			batch.residual[lane] = Math::max(batch.residual[lane], std::fabs(batch.tangentImpulse[lane] - oldImpulse));
+		}
+#endif
+		//no scatter instruction in avx2. bodies that can not move are shared by lanes and other workers, they are never written
+		for (size_t lane = 0; lane < Lanes; lane++)
+		{
+			if (m_graph.movable(batch.slotA[lane]))
+			{
+				m_velocityX[batch.slotA[lane]] = velocity[0][lane];
+				m_velocityY[batch.slotA[lane]] = velocity[1][lane];
+				m_angularVelocity[batch.slotA[lane]] = velocity[2][lane];
+			}
+			if (m_graph.movable(batch.slotB[lane]))
+			{
+				m_velocityX[batch.slotB[lane]] = velocity[3][lane];
+				m_velocityY[batch.slotB[lane]] = velocity[4][lane];
+				m_angularVelocity[batch.slotB[lane]] = velocity[5][lane];
+			}
+		}
+	}
 
-				real jvt = vcp.tangent.dot(dv);
-				real lambda_t = vcp.effectiveMassTangent * - jvt;
+	real ContactMaintainer::solve(ArticulatedContact& contact)
+	{
+		VelocityConstraintPoint& vcp = contact.point->vcp;
+		const real jv = relative(contact, vcp.normal);
+		const real jvb = contact.target - contact.restitution * jv;
+		real oldImpulse = vcp.accumulatedNormalImpulse;
+		vcp.accumulatedNormalImpulse = Math::max(oldImpulse + vcp.effectiveMassNormal * contact.massScale * jvb - contact.impulseScale * oldImpulse, 0);
+		apply(contact, (vcp.accumulatedNormalImpulse - oldImpulse) * vcp.normal);
+		real residual = std::fabs(vcp.accumulatedNormalImpulse - oldImpulse);
 
+		const real jvt = relative(contact, vcp.tangent);
+		const real maxT = contact.point->friction * vcp.accumulatedNormalImpulse;
+		oldImpulse = vcp.accumulatedTangentImpulse;
+		vcp.accumulatedTangentImpulse = Math::clamp(oldImpulse - vcp.effectiveMassTangent * jvt, -maxT, maxT);
+		apply(contact, (vcp.accumulatedTangentImpulse - oldImpulse) * vcp.tangent);
+		return Math::max(residual, std::fabs(vcp.accumulatedTangentImpulse - oldImpulse));
+	}
 
-				real maxT = ccp.friction * vcp.accumulatedNormalImpulse;
-				oldImpulse = vcp.accumulatedTangentImpulse;
-				vcp.accumulatedTangentImpulse = Math::clamp(oldImpulse + lambda_t, -maxT, maxT);
+	real ContactMaintainer::relative(const ArticulatedContact& contact, const Vector2& axis) const
+	{
+		auto velocity = [this](Body* body, const int32_t& slot, const Vector2& r)
+		{
+			if (body->articulation() != nullptr)
+				return body->velocity() + Vector2::crossProduct(body->angularVelocity(), r);
+			return Vector2(m_velocityX[slot] - m_angularVelocity[slot] * r.y, m_velocityY[slot] + m_angularVelocity[slot] * r.x);
+		};
+		const ContactConstraintPoint* ccp = contact.point;
+		return axis.dot(velocity(ccp->bodyA, contact.slotA, ccp->vcp.ra) - velocity(ccp->bodyB, contact.slotB, ccp->vcp.rb));
+	}
 
-				lambda_t = vcp.accumulatedTangentImpulse - oldImpulse;
+	void ContactMaintainer::apply(const ArticulatedContact& contact, const Vector2& impulse)
+	{
+		auto push = [this](Body* body, const int32_t& slot, const Vector2& p, const Vector2& r)
+		{
+			if (body->articulation() != nullptr)
+			{
+				body->articulation()->applyImpulse(body->link(), p, body->position() + r);
+				return;
+			}
+			if (!m_graph.movable(slot))
+				return;
+			m_velocityX[slot] += body->inverseMass() * p.x;
+			m_velocityY[slot] += body->inverseMass() * p.y;
+			m_angularVelocity[slot] += body->inverseInertia() * r.cross(p);
+		};
+		const ContactConstraintPoint* ccp = contact.point;
+		push(ccp->bodyA, contact.slotA, impulse, ccp->vcp.ra);
+		push(ccp->bodyB, contact.slotB, -impulse, ccp->vcp.rb);
+	}
 
-				Vector2 impulse_t = lambda_t * vcp.tangent;
+	void ContactMaintainer::solveBlock(ContactBlock& block)
+	{
+		const int32_t a = block.slotA;
+		const int32_t b = block.slotB;
+		Vector2 va(m_velocityX[a], m_velocityY[a]);
+		Vector2 vb(m_velocityX[b], m_velocityY[b]);
+		real wa = m_angularVelocity[a];
+		real wb = m_angularVelocity[b];
 
+		auto relative = [&](const VelocityConstraintPoint& vcp, const Vector2& axis)
+		{
+			const Vector2 dv = va + Vector2::crossProduct(wa, vcp.ra) - vb - Vector2::crossProduct(wb, vcp.rb);
+			return axis.dot(dv);
+		};
+		auto apply = [&](const VelocityConstraintPoint& vcp, const real& lambda, const Vector2& axis)
+		{
+			const Vector2 impulse = lambda * axis;
+			va += block.invMassA * impulse;
+			wa += block.invInertiaA * vcp.ra.cross(impulse);
+			vb -= block.invMassB * impulse;
+			wb -= block.invInertiaB * vcp.rb.cross(impulse);
+		};
 
-				ccp.bodyA->applyImpulse(impulse_t, vcp.ra);
-				ccp.bodyB->applyImpulse(-impulse_t, vcp.rb);
+		VelocityConstraintPoint& vcp1 = block.points[0]->vcp;
+		VelocityConstraintPoint& vcp2 = block.points[1]->vcp;
+		if (block.coupled)
+		{
+			//each point aims at the velocity a single contact would reach: target - restitution * jv after the impulse.
+			//with accumulated impulses x, velocities relative to targets are w = K * x + c. find x >= 0, w >= 0 and x * w = 0
+			const real jv1 = relative(vcp1, vcp1.normal);
+			const real jv2 = relative(vcp2, vcp2.normal);
+			const Vector2 old(vcp1.accumulatedNormalImpulse, vcp2.accumulatedNormalImpulse);
+			const Vector2 c(vcp1.restitution * jv1 - block.target[0] - (block.k11 * old.x + block.k12 * old.y),
+				vcp2.restitution * jv2 - block.target[1] - (block.k12 * old.x + block.k22 * old.y));
 
-				ccp.active = false;
+			//try the cases in turn: both pushing, only first, only second, none
+			Vector2 x = -block.normalMass.multiply(c);
+			if (x.x < 0 || x.y < 0)
+			{
+				x.set(-c.x / block.k11, 0);
+				if (x.x < 0 || block.k12 * x.x + c.y < 0)
+				{
+					x.set(0, -c.y / block.k22);
+					if (x.y < 0 || block.k12 * x.y + c.x < 0)
+					{
+						x.set(0, 0);
+						//no case holds due to round off, keep last impulses
+						if (c.x < 0 || c.y < 0)
+							x = old;
+					}
+				}
 			}
+			apply(vcp1, x.x - old.x, vcp1.normal);
+			apply(vcp2, x.y - old.y, vcp2.normal);
+			block.residual = Math::max(std::fabs(x.x - old.x), std::fabs(x.y - old.y));
+			vcp1.accumulatedNormalImpulse = x.x;
+			vcp2.accumulatedNormalImpulse = x.y;
+		}
+		else
+		{
+			block.residual = 0;
+			for (size_t i = 0; i < 2; i++)
+			{
+				VelocityConstraintPoint& vcp = block.points[i]->vcp;
+				const real jvb = block.target[i] - vcp.restitution * relative(vcp, vcp.normal);
+				const real oldImpulse = vcp.accumulatedNormalImpulse;
+				vcp.accumulatedNormalImpulse = Math::max(oldImpulse + vcp.effectiveMassNormal * jvb, 0);
+				apply(vcp, vcp.accumulatedNormalImpulse - oldImpulse, vcp.normal);
+				block.residual = Math::max(block.residual, std::fabs(vcp.accumulatedNormalImpulse - oldImpulse));
+			}
+		}
 
+		for (ContactConstraintPoint* ccp : block.points)
+		{
+			VelocityConstraintPoint& vcp = ccp->vcp;
+			const real maxT = ccp->friction * vcp.accumulatedNormalImpulse;
+			const real oldImpulse = vcp.accumulatedTangentImpulse;
+			vcp.accumulatedTangentImpulse = Math::clamp(oldImpulse - vcp.effectiveMassTangent * relative(vcp, vcp.tangent), -maxT, maxT);
+			apply(vcp, vcp.accumulatedTangentImpulse - oldImpulse, vcp.tangent);
+			block.residual = Math::max(block.residual, std::fabs(vcp.accumulatedTangentImpulse - oldImpulse));
+		}
+
+		if (m_graph.movable(a))
+		{
+			m_velocityX[a] = va.x;
+			m_velocityY[a] = va.y;
+			m_angularVelocity[a] = wa;
+		}
+		if (m_graph.movable(b))
+		{
+			m_velocityX[b] = vb.x;
+			m_velocityY[b] = vb.y;
+			m_angularVelocity[b] = wb;
 		}
 	}
 
@@ -108,9 +908,16 @@ namespace Physics2D
 	{
 		const Body* bodyA = collision.bodyA;
 		const Body* bodyB = collision.bodyB;
+		//links of one articulation are held together by its joints, they do not collide with each other
+		if (bodyA->articulation() != nullptr && bodyA->articulation() == bodyB->articulation())
+			return;
 		const auto relation = generateRelation(collision.bodyA, collision.bodyB);
-		auto& contactList = m_contactTable[relation];
-		assert(contactList.size() <= 2);
+		auto& contactList = fetch(relation).contacts;
+		//points of a vertex approach change features once touching, new points take the approach recorded by the pair
+		real approach = 0;
+		for (const auto& contact : contactList)
+			if (!contact.active && contact.bodyA == bodyA)
+				approach = Math::min(approach, contact.vcp.approach);
 		for (const auto& elem : collision.contactList)
 		{
 			bool existed = false;
@@ -118,9 +925,14 @@ namespace Physics2D
 			Vector2 localB = bodyB->toLocalPoint(elem.pointB);
 			for (auto& contact : contactList)
 			{
-				const bool isPointA = localA.fuzzyEqual(contact.localA, 0.2);
-				const bool isPointB = localB.fuzzyEqual(contact.localB, 0.2);
-				if (isPointA && isPointB)
+				//already matched by another point in this step, inheriting twice would apply warm start twice.
+				//relation ignores order of bodies, so points only compare with the same order
+				if (contact.active || contact.bodyA != bodyA || contact.feature != elem.feature)
+					continue;
+				//same features are the same point. without features only nearby points are
+				const bool matched = elem.feature != 0 ||
+					(localA.fuzzyEqual(contact.localA, 0.2) && localB.fuzzyEqual(contact.localB, 0.2));
+				if (matched)
 				{
 					//satisfy the condition, transmit the old accumulated value to new value
 					contact.localA = localA;
@@ -137,11 +949,127 @@ namespace Physics2D
 			ccp.localA = localA;
 			ccp.localB = localB;
 			ccp.relation = relation;
+			ccp.feature = elem.feature;
+			ccp.vcp.approach = approach;
 			prepare(ccp, elem, collision);
 			contactList.emplace_back(ccp);
 		}
 	}
 
+	void ContactMaintainer::clear()
+	{
+		m_pairs.clear();
+		m_table.clear();
+	}
+
+	const std::vector<ContactPair>& ContactMaintainer::pairs() const
+	{
+		return m_pairs;
+	}
+
+	const IterationStatistics& ContactMaintainer::statistics() const
+	{
+		return m_statistics;
+	}
+
+	size_t ContactMaintainer::hash(const RelationID& relation)
+	{
+		//fibonacci hashing spreads packed ids over the table
+		return static_cast<size_t>((relation * 0x9E3779B97F4A7C15ull) >> 32);
+	}
+
+	size_t ContactMaintainer::probe(const RelationID& relation) const
+	{
+		const size_t mask = m_table.size() - 1;
+		size_t slot = hash(relation) & mask;
+		while (m_table[slot].second != Empty && m_table[slot].first != relation)
+			slot = (slot + 1) & mask;
+		return slot;
+	}
+
+	ContactPair& ContactMaintainer::fetch(const RelationID& relation)
+	{
+		//keep load factor under one half
+		if ((m_pairs.size() + 1) * 2 > m_table.size())
+			rehash(std::max<size_t>(m_table.size() * 2, 64));
+
+		const size_t slot = probe(relation);
+		if (m_table[slot].second != Empty)
+			return m_pairs[m_table[slot].second];
+
+		m_table[slot] = { relation, m_pairs.size() };
+		ContactPair& result = m_pairs.emplace_back();
+		result.relation = relation;
+		return result;
+	}
+
+	void ContactMaintainer::erase(const RelationID& relation)
+	{
+		const size_t mask = m_table.size() - 1;
+		size_t slot = probe(relation);
+		const size_t index = m_table[slot].second;
+		if (index == Empty)
+			return;
+
+		//move last pair into the hole and point its slot to the new index
+		if (index + 1 != m_pairs.size())
+		{
+			m_pairs[index] = std::move(m_pairs.back());
+			m_table[probe(m_pairs[index].relation)].second = index;
+		}
+		m_pairs.pop_back();
+
+		//backward shift deletion keeps probe chains unbroken without tombstones
+		m_table[slot].second = Empty;
+		size_t next = (slot + 1) & mask;
+		while (m_table[next].second != Empty)
+		{
+			const size_t home = hash(m_table[next].first) & mask;
+			//entry may move to the hole only if the hole lies on its way from home
+			if (((next - home) & mask) >= ((next - slot) & mask))
+			{
+				m_table[slot] = m_table[next];
+				m_table[next].second = Empty;
+				slot = next;
+			}
+			next = (next + 1) & mask;
+		}
+	}
+
+	void ContactMaintainer::rehash(const size_t& capacity)
+	{
+		m_table.assign(capacity, { 0, Empty });
+		for (size_t i = 0; i < m_pairs.size(); i++)
+			m_table[probe(m_pairs[i].relation)] = { m_pairs[i].relation, i };
+	}
+
+	void ContactMaintainer::compact()
+	{
+		//contacts not refreshed by add since last solve are stale
+		for (size_t i = 0; i < m_pairs.size();)
+		{
+			std::vector<ContactConstraintPoint>& contacts = m_pairs[i].contacts;
+			for (size_t j = 0; j < contacts.size();)
+			{
+				if (contacts[j].active)
+				{
+					j++;
+					continue;
+				}
+				if (j + 1 != contacts.size())
+					contacts[j] = contacts.back();
+				contacts.pop_back();
+			}
+			if (contacts.empty())
+			{
+				//erase moves the last pair into slot i, visit it again
+				erase(m_pairs[i].relation);
+				continue;
+			}
+			i++;
+		}
+	}
+
 	void ContactMaintainer::prepare(ContactConstraintPoint& ccp, const PointPair& pair, const Collision& collision)
 	{
 		ccp.bodyA = collision.bodyA;
@@ -177,16 +1105,42 @@ namespace Physics2D
 		vcp.effectiveMassNormal = realEqual(kNormal, 0.0) ? 0 : 1.0 / kNormal;
 		vcp.effectiveMassTangent = realEqual(kTangent, 0.0) ? 0 : 1.0 / kTangent;
 
-		//vcp.bias = 0;
-		vcp.bias = m_biasFactor * Math::max(0.0, collision.penetration - m_maxPenetration) * 60.0;
+		//position error only, divided by time step when packed. with position correction the error is fixed in solvePosition,
+		//except on links of articulations which are placed by their joint positions and keep the bias
+		const bool articulated = ccp.bodyA->articulation() != nullptr || ccp.bodyB->articulation() != nullptr;
+		vcp.bias = m_positionCorrection && !articulated ? 0 : m_biasFactor * Math::max(0.0, collision.penetration - m_maxPenetration);
 		vcp.restitution = Math::min(ccp.bodyA->restitution(), ccp.bodyB->restitution());
-		//accumulate inherited impulse
-		Vector2 impulse = vcp.accumulatedNormalImpulse * vcp.normal + vcp.accumulatedTangentImpulse * vcp.tangent;
-		//Vector2 impulse;
-		ccp.bodyA->applyImpulse(impulse, vcp.ra);
-		ccp.bodyB->applyImpulse(-impulse, vcp.rb);
-		
-
 
+		//a speculative contact that held nothing back last step takes the approach of this one. once it holds, the approach
+		//is kept until the contact touches, otherwise the bounce would depend on how close to the surface the step ended
+		const bool speculative = collision.penetration < 0;
+		if (speculative && vcp.accumulatedNormalImpulse == 0)
+		{
+			const Vector2 va = ccp.bodyA->velocity() + Vector2::crossProduct(ccp.bodyA->angularVelocity(), vcp.ra);
+			const Vector2 vb = ccp.bodyB->velocity() + Vector2::crossProduct(ccp.bodyB->angularVelocity(), vcp.rb);
+			vcp.approach = (va - vb).dot(vcp.normal);
+		}
+		//impulses of speculative and bouncing contacts only hold for one step, do not warm start from them
+		if (speculative || vcp.separation > 0 || vcp.bounce > 0)
+		{
+			vcp.accumulatedNormalImpulse = 0;
+			vcp.accumulatedTangentImpulse = 0;
+		}
+		vcp.separation = 0;
+		vcp.bounce = 0;
+		if (speculative)
+		{
+			//no bounce yet, only remove the approaching velocity that would close the gap of this point in this step
+			vcp.restitution = 1;
+			vcp.separation = Math::max((pair.pointA - pair.pointB).dot(vcp.normal), 0);
+		}
+		else if (vcp.approach < -m_restitutionThreshold)
+		{
+			//touching after being speculative: part at the restitution of the approach, once
+			vcp.bounce = -vcp.restitution * vcp.approach;
+			vcp.restitution = 1;
+			vcp.approach = 0;
+		}
+		//inherited impulses are applied as warm start when solving
 	}
 }
@@ -0,0 +1,81 @@
+#include "include/dynamics/constraint/graph.h"
+
+namespace Physics2D
+{
+	void ConstraintGraph::reset(const size_t& bodies)
+	{
+		size_t capacity = 64;
+		while (capacity < 2 * bodies)
+			capacity <<= 1;
+		m_table.assign(capacity, { nullptr, 0 });
+		m_bodies.assign(1, nullptr);
+		m_colors.assign(1, 0);
+		m_movable.assign(1, false);
+	}
+
+	int32_t ConstraintGraph::slot(Body* body)
+	{
+		if (body == nullptr)
+			return 0;
+
+		//keep the table at most half full, body count may exceed the hint of reset
+		if (2 * m_bodies.size() >= m_table.size())
+			rehash(2 * m_table.size());
+
+		const size_t index = probe(body);
+		if (m_table[index].first == nullptr)
+		{
+			m_table[index] = { body, static_cast<int32_t>(m_bodies.size()) };
+			m_bodies.emplace_back(body);
+			m_colors.emplace_back(0);
+			m_movable.emplace_back(body->inverseMass() != 0 || body->inverseInertia() != 0);
+		}
+		return m_table[index].second;
+	}
+
+	size_t ConstraintGraph::probe(Body* body) const
+	{
+		const size_t mask = m_table.size() - 1;
+		//fibonacci hashing spreads aligned addresses over the table
+		size_t index = static_cast<size_t>((reinterpret_cast<uintptr_t>(body) * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+		while (m_table[index].first != nullptr && m_table[index].first != body)
+			index = (index + 1) & mask;
+		return index;
+	}
+
+	void ConstraintGraph::rehash(const size_t& capacity)
+	{
+		std::vector<std::pair<Body*, int32_t>> old(capacity, { nullptr, 0 });
+		old.swap(m_table);
+		for (const auto& entry : old)
+			if (entry.first != nullptr)
+				m_table[probe(entry.first)] = entry;
+	}
+
+	size_t ConstraintGraph::color(const int32_t& slotA, const int32_t& slotB)
+	{
+		const uint64_t used = (m_movable[slotA] ? m_colors[slotA] : 0) | (m_movable[slotB] ? m_colors[slotB] : 0);
+		if (used == UINT64_MAX)
+			return Overflow;
+
+		size_t color = 0;
+		while (used & (uint64_t(1) << color))
+			color++;
+
+		if (m_movable[slotA])
+			m_colors[slotA] |= uint64_t(1) << color;
+		if (m_movable[slotB])
+			m_colors[slotB] |= uint64_t(1) << color;
+		return color;
+	}
+
+	bool ConstraintGraph::movable(const int32_t& slot) const
+	{
+		return m_movable[slot];
+	}
+
+	const std::vector<Body*>& ConstraintGraph::bodies() const
+	{
+		return m_bodies;
+	}
+}
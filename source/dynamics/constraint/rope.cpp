@@ -0,0 +1,247 @@
+#include "include/dynamics/constraint/rope.h"
+
+namespace Physics2D
+{
+	Rope::Rope(const RopePrimitive& primitive) : m_primitive(primitive)
+	{
+		assert(m_primitive.bodies.size() >= 2);
+		const size_t links = m_primitive.bodies.size() - 1;
+		m_primitive.localPointsA.resize(links);
+		m_primitive.localPointsB.resize(links);
+		m_links.resize(links);
+		m_rhs.resize(links);
+		m_upper.resize(links);
+		if (m_primitive.lengths.empty())
+			for (size_t i = 0; i < links; i++)
+				m_primitive.lengths.emplace_back((anchorB(i) - anchorA(i)).length());
+		assert(m_primitive.lengths.size() == links);
+	}
+	void Rope::prepare(const real& dt)
+	{
+		linearize();
+		for (size_t i = 0; i < m_links.size(); i++)
+		{
+			Link& link = m_links[i];
+			const real c = m_rhs[i];
+			link.bias = m_soft ? -m_softness.biasRate * c : m_positionCorrection ? 0 : -m_primitive.biasFactor * c / dt;
+			link.accumulatedImpulse = 0;
+		}
+	}
+	void Rope::solveVelocity(const real&)
+	{
+		const size_t count = m_links.size();
+		for (auto& link : m_links)
+			link.clamped = false;
+
+		//a slack link that would push is left out and the rest solved again, a few passes settle the active set
+		for (int pass = 0; pass < 4; pass++)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				const Link& link = m_links[i];
+				if (!link.active || link.clamped)
+				{
+					m_rhs[i] = 0;
+					continue;
+				}
+				Body* bodyA = m_primitive.bodies[i];
+				Body* bodyB = m_primitive.bodies[i + 1];
+				Vector2 va, vb;
+				if (bodyA != nullptr)
+					va = bodyA->velocity() + Vector2::crossProduct(bodyA->angularVelocity(), link.ra);
+				if (bodyB != nullptr)
+					vb = bodyB->velocity() + Vector2::crossProduct(bodyB->angularVelocity(), link.rb);
+				const real jv = link.normal.dot(vb - va);
+				m_rhs[i] = -jv + link.bias;
+			}
+			factorSolve();
+
+			bool changed = false;
+			if (!m_primitive.rigid)
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					Link& link = m_links[i];
+					if (link.active && !link.clamped && link.accumulatedImpulse + m_rhs[i] > 0)
+					{
+						link.clamped = true;
+						changed = true;
+					}
+				}
+			}
+			if (!changed)
+				break;
+		}
+		for (size_t i = 0; i < count; i++)
+		{
+			Link& link = m_links[i];
+			if (!link.active || link.clamped)
+				continue;
+			real lambda = m_rhs[i];
+			if (m_soft)
+				lambda = lambda * m_softness.massScale - m_softness.impulseScale * link.accumulatedImpulse;
+			link.accumulatedImpulse += lambda;
+			apply(i, lambda);
+		}
+	}
+	void Rope::solvePosition(const real&)
+	{
+		if (!m_positionCorrection)
+			return;
+
+		linearize();
+		for (size_t i = 0; i < m_links.size(); i++)
+		{
+			Link& link = m_links[i];
+			link.clamped = false;
+			//slack links near full length keep their length so that neighbours cannot stretch them
+			const real c = m_primitive.rigid ? m_rhs[i] : Math::max(m_rhs[i], 0);
+			m_rhs[i] = -Math::clamp(c, -MaxLinearCorrection, MaxLinearCorrection);
+		}
+		factorSolve();
+
+		for (size_t i = 0; i < m_links.size(); i++)
+		{
+			const Link& link = m_links[i];
+			if (!link.active)
+				continue;
+			const Vector2 impulse = m_rhs[i] * link.normal;
+			real im, ii;
+			massOf(m_primitive.bodies[i], im, ii);
+			if (im != 0 || ii != 0)
+			{
+				m_primitive.bodies[i]->position() -= im * impulse;
+				m_primitive.bodies[i]->rotation() -= ii * link.ra.cross(impulse);
+			}
+			massOf(m_primitive.bodies[i + 1], im, ii);
+			if (im != 0 || ii != 0)
+			{
+				m_primitive.bodies[i + 1]->position() += im * impulse;
+				m_primitive.bodies[i + 1]->rotation() += ii * link.rb.cross(impulse);
+			}
+		}
+	}
+	void Rope::setSoftness(const Softness& softness)
+	{
+		m_soft = true;
+		m_softness = softness;
+	}
+	void Rope::clearSoftness()
+	{
+		m_soft = false;
+	}
+	void Rope::setPositionCorrection(const bool& positionCorrection)
+	{
+		m_positionCorrection = positionCorrection;
+	}
+	const RopePrimitive& Rope::primitive() const
+	{
+		return m_primitive;
+	}
+	real Rope::stretch(const size_t& link) const
+	{
+		return (anchorB(link) - anchorA(link)).length() - m_primitive.lengths[link];
+	}
+	Vector2 Rope::anchorA(const size_t& link) const
+	{
+		Body* body = m_primitive.bodies[link];
+		return body == nullptr ? m_primitive.localPointsA[link] : body->toWorldPoint(m_primitive.localPointsA[link]);
+	}
+	Vector2 Rope::anchorB(const size_t& link) const
+	{
+		Body* body = m_primitive.bodies[link + 1];
+		return body == nullptr ? m_primitive.localPointsB[link] : body->toWorldPoint(m_primitive.localPointsB[link]);
+	}
+	void Rope::linearize()
+	{
+		real im_prev = 0, ii_prev = 0;
+		massOf(m_primitive.bodies[0], im_prev, ii_prev);
+		for (size_t i = 0; i < m_links.size(); i++)
+		{
+			Link& link = m_links[i];
+			Body* bodyA = m_primitive.bodies[i];
+			Body* bodyB = m_primitive.bodies[i + 1];
+			const Vector2 pa = anchorA(i);
+			const Vector2 pb = anchorB(i);
+			link.ra = bodyA == nullptr ? Vector2() : pa - bodyA->position();
+			link.rb = bodyB == nullptr ? Vector2() : pb - bodyB->position();
+
+			const Vector2 error = pb - pa;
+			const real length = error.length();
+			const real c = length - m_primitive.lengths[i];
+			m_rhs[i] = c;
+
+			real im_a = im_prev, ii_a = ii_prev, im_b, ii_b;
+			massOf(bodyB, im_b, ii_b);
+			im_prev = im_b;
+			ii_prev = ii_b;
+
+			link.active = !realEqual(length, 0) && (m_primitive.rigid || c > -LinearSlop);
+			if (!link.active)
+				continue;
+			link.normal = error / length;
+			const real rn_a = link.ra.cross(link.normal);
+			const real rn_b = link.rb.cross(link.normal);
+			link.diagonal = im_a + ii_a * rn_a * rn_a + im_b + ii_b * rn_b * rn_b;
+			if (realEqual(link.diagonal, 0))
+				link.active = false;
+		}
+		//neighbours couple through the body they share, bodies[i] is end B of link i - 1 and end A of link i
+		for (size_t i = 1; i < m_links.size(); i++)
+		{
+			Link& link = m_links[i];
+			const Link& prev = m_links[i - 1];
+			real im, ii;
+			massOf(m_primitive.bodies[i], im, ii);
+			link.lower = -(im * prev.normal.dot(link.normal) + ii * prev.rb.cross(prev.normal) * link.ra.cross(link.normal));
+		}
+	}
+	void Rope::factorSolve()
+	{
+		//thomas algorithm, rows of links left out are identity rows with zero right hand side
+		const size_t count = m_links.size();
+		auto used = [&](const size_t& i)
+		{
+			return m_links[i].active && !m_links[i].clamped;
+		};
+		for (size_t i = 0; i < count; i++)
+		{
+			if (!used(i))
+			{
+				m_upper[i] = 0;
+				m_rhs[i] = 0;
+				continue;
+			}
+			const real lower = i > 0 && used(i - 1) ? m_links[i].lower : 0;
+			const real upper = i + 1 < count && used(i + 1) ? m_links[i + 1].lower : 0;
+			const real previousUpper = i > 0 ? m_upper[i - 1] : 0;
+			const real previousRhs = i > 0 ? m_rhs[i - 1] : 0;
+			const real pivot = m_links[i].diagonal - lower * previousUpper;
+			m_upper[i] = upper / pivot;
+			m_rhs[i] = (m_rhs[i] - lower * previousRhs) / pivot;
+		}
+		for (size_t i = count - 1; i-- > 0;)
+			m_rhs[i] -= m_upper[i] * m_rhs[i + 1];
+	}
+	void Rope::apply(const size_t& link, const real& impulse)
+	{
+		const Link& constraint = m_links[link];
+		const Vector2 p = impulse * constraint.normal;
+		Body* bodyA = m_primitive.bodies[link];
+		Body* bodyB = m_primitive.bodies[link + 1];
+		real im, ii;
+		massOf(bodyA, im, ii);
+		if (im != 0 || ii != 0)
+			bodyA->applyImpulse(-p, constraint.ra);
+		massOf(bodyB, im, ii);
+		if (im != 0 || ii != 0)
+			bodyB->applyImpulse(p, constraint.rb);
+	}
+	void Rope::massOf(Body* body, real& im, real& ii)
+	{
+		//only dynamic bodies and bullets respond to the rope
+		const bool movable = body != nullptr && (body->type() == Body::BodyType::Dynamic || body->type() == Body::BodyType::Bullet);
+		im = movable ? body->inverseMass() : 0;
+		ii = movable ? body->inverseInertia() : 0;
+	}
+}
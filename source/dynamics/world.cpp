@@ -10,19 +10,137 @@ namespace Physics2D
 		for (auto& joint : m_jointList)
 			joint.release();
 	}
-	void World::stepVelocity(const real& dt)
+	void World::JointBatch::clear()
 	{
-		for (int i = 0; i < m_velocityIteration; i++)
-			for (auto& joint : m_jointList)
-				joint->prepare(dt);
+		distance.clear();
+		point.clear();
+		rotation.clear();
+		orientation.clear();
+		others.clear();
+	}
+	size_t World::JointBatch::size() const
+	{
+		return distance.size() + point.size() + rotation.size() + orientation.size() + others.size();
+	}
+	//run task over the part of joints that falls in [begin, end) of the whole batch, offset is where joints start
+	template<typename T, typename Task>
+	static void solveRange(const std::vector<T*>& joints, size_t& offset, const size_t& begin, const size_t& end, const Task& task)
+	{
+		const size_t first = std::max(begin, offset);
+		const size_t last = std::min(end, offset + joints.size());
+		for (size_t i = first; i < last; i++)
+			task(joints[i - offset]);
+		offset += joints.size();
+	}
+	template<typename Task>
+	void World::solveJoints(Utils::WorkerPool* pool, const Task& task)
+	{
+		//colors with fewer joints are not worth waking the workers
+		const size_t parallelJoints = 64;
+		for (size_t color = 0; color <= ConstraintGraph::Overflow; color++)
+		{
+			const JointBatch& batch = m_jointColors[color];
+			const size_t count = batch.size();
+			if (count == 0)
+				continue;
+
+			auto solve = [&](size_t begin, size_t end)
+			{
+				size_t offset = 0;
+				solveRange(batch.distance, offset, begin, end, task);
+				solveRange(batch.point, offset, begin, end, task);
+				solveRange(batch.rotation, offset, begin, end, task);
+				solveRange(batch.orientation, offset, begin, end, task);
+				solveRange(batch.others, offset, begin, end, task);
+			};
+			if (pool != nullptr && color != ConstraintGraph::Overflow && count >= parallelJoints)
+				pool->forEach(count, [&](size_t begin, size_t end, size_t) { solve(begin, end); });
+			else
+				solve(0, count);
+		}
+	}
+	void World::stepVelocity(const real& dt, Utils::WorkerPool* pool)
+	{
+		for (auto& joint : m_jointList)
+			joint->setPositionCorrection(m_positionCorrection);
+		for (auto& rope : m_ropeList)
+			rope->setPositionCorrection(m_positionCorrection);
+
+		//external forces first, so joints and ropes hold against the velocity of this step
+		integrateVelocity(dt);
+
+		colorJoints();
+		solveJoints(pool, [&](auto* joint) { joint->prepare(dt); });
+		for (auto& rope : m_ropeList)
+			rope->prepare(dt);
 
 		for (int i = 0; i < m_velocityIteration; i++)
-			for (auto& joint : m_jointList)
-				joint->solveVelocity(dt);
+		{
+			solveJoints(pool, [&](auto* joint) { joint->solveVelocity(dt); });
+			for (auto& rope : m_ropeList)
+				rope->solveVelocity(dt);
+		}
+	}
+	void World::stepPosition(const real& dt, Utils::WorkerPool* pool, ContactMaintainer* contactMaintainer)
+	{
+		integratePosition(dt, pool);
+		clearForces();
+
+		//nonlinear gauss seidel on integrated positions, each iteration sees corrections of the last one
+		colorJoints();
+		for (int i = 0; i < m_positionIteration; i++)
+		{
+			solveJoints(pool, [&](auto* joint) { joint->solvePosition(dt); });
+			for (auto& rope : m_ropeList)
+				rope->solvePosition(dt);
+			if (contactMaintainer != nullptr)
+				contactMaintainer->solvePosition(pool);
+		}
+	}
+	void World::substep(const real& dt, ContactMaintainer& contactMaintainer, Utils::WorkerPool* pool)
+	{
+		const real h = dt / m_substeps;
+		const Softness softness = Softness::make(m_jointHertz, m_jointDampingRatio, h);
+		for (auto& joint : m_jointList)
+			joint->setSoftness(softness);
+		for (auto& rope : m_ropeList)
+			rope->setSoftness(softness);
 
+		colorJoints();
+		contactMaintainer.beginSubsteps(h);
+		for (int i = 0; i < m_substeps; i++)
+		{
+			integrateVelocity(h);
+			solveJoints(pool, [&](auto* joint)
+				{
+					joint->prepare(h);
+					joint->solveVelocity(h);
+				});
+			for (auto& rope : m_ropeList)
+			{
+				rope->prepare(h);
+				rope->solveVelocity(h);
+			}
+			contactMaintainer.solveSubstep(h, true, pool);
+			integratePosition(h, pool);
+			contactMaintainer.solveSubstep(h, false, pool);
+		}
+		contactMaintainer.endSubsteps(pool);
+
+		for (auto& joint : m_jointList)
+			joint->clearSoftness();
+		for (auto& rope : m_ropeList)
+			rope->clearSoftness();
+		clearForces();
+	}
+	void World::integrateVelocity(const real& h)
+	{
 		const Vector2 g = m_enableGravity ? m_gravity : (0, 0);
 		for (auto& body : m_bodyList)
 		{
+			//links are integrated by their articulation
+			if (body->articulation() != nullptr)
+				continue;
 			switch (body->type())
 			{
 			case Body::BodyType::Static:
@@ -32,102 +150,546 @@ namespace Physics2D
 				break;
 			}
 			case Body::BodyType::Dynamic:
+			case Body::BodyType::Bullet:
 			{
-				body->forces() += body->mass() * g;
-				body->velocity() += body->inverseMass() * body->forces() * dt * m_velocityIteration;
-				body->angularVelocity() += body->inverseInertia() * body->torques() * dt * m_velocityIteration;
+				const Vector2 forces = body->forces() + body->mass() * g;
+				body->velocity() += body->inverseMass() * forces * h;
+				body->angularVelocity() += body->inverseInertia() * body->torques() * h;
 				break;
 			}
 			case Body::BodyType::Kinematic:
 			{
-				body->velocity() += body->inverseMass() * body->forces() * dt * m_velocityIteration;
-				body->angularVelocity() += body->inverseInertia() * body->torques() * dt * m_velocityIteration;
-				break;
-			}
-			case Body::BodyType::Bullet:
-			{
+				body->velocity() += body->inverseMass() * body->forces() * h;
+				body->angularVelocity() += body->inverseInertia() * body->torques() * h;
 				break;
 			}
 			}
 		}
+		for (auto& articulation : m_articulationList)
+			articulation->stepVelocity(h, g);
 	}
-	void World::stepPosition(const real& dt)
+	void World::integratePosition(const real& h, Utils::WorkerPool* pool)
 	{
-		for (int i = 0; i < m_positionIteration; i++)
-			for(auto& joint: m_jointList)
-				joint->solvePosition(dt);
+		//bullets are swept against all bodies, other fast bodies only against bodies that do not respond to them
+		m_obstacles.clear();
+		for (auto& body : m_bodyList)
+			if (body->type() == Body::BodyType::Static || body->type() == Body::BodyType::Kinematic)
+				m_obstacles.emplace_back(body.get());
 
+		m_fastBodies.clear();
+		m_motions.clear();
+		m_events.clear();
 		for (auto& body : m_bodyList)
 		{
-			switch (body->type())
+			if (body->articulation() != nullptr)
+				continue;
+			if (body->type() == Body::BodyType::Bullet || (body->type() == Body::BodyType::Dynamic && !m_obstacles.empty() && isFast(body.get(), h)))
+				addSwept(body.get(), h);
+		}
+		for (Body* body : m_fastBodies)
+			request(body, 0);
+		schedule(h, pool);
+		solveImpacts(h, pool);
+
+		for (auto& body : m_bodyList)
+		{
+			if (body->articulation() != nullptr)
+				continue;
+			if (auto iter = m_motions.find(body.get()); iter != m_motions.end())
 			{
-			case Body::BodyType::Static:
-				break;
-			case Body::BodyType::Dynamic:
+				body->stepPosition(h - iter->second.time);
+				continue;
+			}
+			if (body->type() != Body::BodyType::Dynamic && body->type() != Body::BodyType::Kinematic)
+				continue;
+
+			body->position() += body->velocity() * h;
+			body->rotation() += body->angularVelocity() * h;
+		}
+		for (auto& articulation : m_articulationList)
+			articulation->stepPosition(h);
+	}
+	void World::solveImpacts(const real& h, Utils::WorkerPool* pool)
+	{
+		//fewer impacts are not worth waking the workers
+		const size_t parallelImpacts = 16;
+		while (!m_events.empty())
+		{
+			m_batch.clear();
+			m_batchRegions.clear();
+			while (!m_events.empty())
 			{
-				body->position() += body->velocity() * dt * m_positionIteration;
-				body->rotation() += body->angularVelocity() * dt * m_positionIteration;
+				const ImpactEvent event = m_events.front();
+				if (event.version != versionOf(event.body) || event.otherVersion != versionOf(event.other))
+				{
+					std::pop_heap(m_events.begin(), m_events.end());
+					m_events.pop_back();
+					//dropped for a change of the other only, the body may still hit something else
+					if (event.version == versionOf(event.body))
+					{
+						request(event.body, event.time);
+						schedule(h, nullptr);
+					}
+					continue;
+				}
+				//bodies of a batch are swept again only after all of it is resolved, so impacts passed on to third bodies
+				//wait for the next batch. batches do not depend on the number of workers, only on whether there is a pool
+				const AABB region = pool != nullptr ? reachable(event, h) : AABB();
+				if (!m_batch.empty() && (pool == nullptr || !independent(event, region)))
+					break;
 
-				body->forces().clear();
-				body->clearTorque();
-				break;
+				std::pop_heap(m_events.begin(), m_events.end());
+				m_events.pop_back();
+				//dynamic bodies struck are tracked from here on, before any impact of the batch is resolved
+				if (event.other->articulation() == nullptr && event.other->type() == Body::BodyType::Dynamic)
+					track(event.other);
+				m_batch.emplace_back(event);
+				m_batchRegions.emplace_back(region);
 			}
-			case Body::BodyType::Kinematic:
+
+			if (pool != nullptr && m_batch.size() >= parallelImpacts)
+			{
+				pool->forEach(m_batch.size(), [&](size_t begin, size_t end, size_t)
+					{
+						for (size_t i = begin; i < end; i++)
+							resolve(m_batch[i]);
+					});
+			}
+			else
 			{
-				body->position() += body->velocity() * dt * m_positionIteration;
-				body->rotation() += body->angularVelocity() * dt * m_positionIteration;
+				for (const ImpactEvent& event : m_batch)
+					resolve(event);
+			}
+			for (const ImpactEvent& event : m_batch)
+				reschedule(event, h);
+			schedule(h, pool);
+		}
+	}
+	void World::addSwept(Body* body, const real& h)
+	{
+		Motion& motion = track(body);
+		motion.swept = true;
+		m_fastBodies.emplace_back(body);
+		//the leaf covers the rest of the sweep, so pairs generated after the step include whatever it may have passed
+		if (m_broadphase != nullptr)
+			m_broadphase->update(body, CCD::sweep(body, h - motion.time));
+	}
+	void World::request(Body* body, const real& now)
+	{
+		Motion& motion = m_motions.at(body);
+		if (motion.request < m_requests.size())
+		{
+			m_requests[motion.request].second = Math::min(m_requests[motion.request].second, now);
+			return;
+		}
+		motion.request = m_requests.size();
+		m_requests.emplace_back(body, now);
+	}
+	void World::schedule(const real& h, Utils::WorkerPool* pool)
+	{
+		//sweeps only read bodies, so they are spread over pool when there are enough of them
+		const size_t parallelSweeps = 16;
+		const size_t workers = pool != nullptr ? pool->size() : 1;
+		if (m_scans.size() < workers)
+			m_scans.resize(workers);
+		m_found.assign(m_requests.size(), ImpactEvent());
 
-				body->forces().clear();
-				body->clearTorque();
-				break;
+		auto sweep = [&](size_t begin, size_t end, size_t worker)
+		{
+			for (size_t i = begin; i < end; i++)
+				findImpact(m_requests[i].first, m_requests[i].second, h, m_scans[worker], m_found[i]);
+		};
+		if (pool != nullptr && m_requests.size() >= parallelSweeps)
+			pool->forEach(m_requests.size(), sweep);
+		else
+			sweep(0, m_requests.size(), 0);
+
+		for (size_t i = 0; i < m_requests.size(); i++)
+		{
+			m_motions.at(m_requests[i].first).request = Motion::None;
+			if (m_found[i].other == nullptr)
+				continue;
+			m_events.emplace_back(m_found[i]);
+			std::push_heap(m_events.begin(), m_events.end());
+		}
+		m_requests.clear();
+	}
+	void World::findImpact(Body* body, const real& now, const real& h, Scan& scan, ImpactEvent& event) const
+	{
+		const Motion& motion = m_motions.at(body);
+		if (motion.impacts >= MaxImpacts)
+			return;
+		const real start = Math::max(now, motion.time);
+		if (start >= h)
+			return;
+
+		//poses are taken along velocities from the time every body is at, bodies are not moved
+		auto at = [](Body* target, const real& elapsed)
+		{
+			Body::PhysicsAttribute attribute = target->physicsAttribute();
+			if (target->type() != Body::BodyType::Static)
+				attribute.step(elapsed);
+			return attribute;
+		};
+		findCandidates(body, CCD::sweep(body, at(body, start - motion.time), h - start), scan);
+
+		event.time = h;
+		for (Body* other : scan.candidates)
+		{
+			//both bodies are placed at the later of their times, impacts of this pair before it were found from there already
+			const real otherTime = timeOf(other);
+			const real from = Math::max(start, otherTime);
+			const real span = event.time - from;
+			if (span <= 0)
+				continue;
+			const Body::PhysicsAttribute attribute = at(body, from - motion.time);
+			const Body::PhysicsAttribute otherAttribute = at(other, from - otherTime);
+			if (!CCD::sweep(body, attribute, span).collide(CCD::sweep(other, otherAttribute, span)))
+				continue;
+
+			PointPair closest;
+			if (auto toi = CCD::timeOfImpact(body, attribute, other, otherAttribute, span, &closest); toi.has_value())
+			{
+				event.time = from + toi.value();
+				event.other = other;
+				event.closest = closest;
 			}
-			case Body::BodyType::Bullet:
+		}
+		if (event.other == nullptr)
+			return;
+
+		event.body = body;
+		event.version = motion.version;
+		event.otherVersion = versionOf(event.other);
+	}
+	void World::resolve(const ImpactEvent& event)
+	{
+		Body* body = event.body;
+		Body* other = event.other;
+		moveTo(body, event.time);
+
+		auto iter = m_motions.find(other);
+		const bool tracked = iter != m_motions.end();
+		const Vector2 position = other->position();
+		const real rotation = other->rotation();
+		if (tracked)
+			moveTo(other, event.time);
+		else if (other->type() != Body::BodyType::Static)
+			other->stepPosition(event.time);
+
+		impact(body, other, event.closest, other->position() - position);
+
+		Motion& motion = m_motions.find(body)->second;
+		motion.version++;
+		motion.impacts++;
+		if (tracked)
+		{
+			iter->second.version++;
+			iter->second.impacts++;
+			return;
+		}
+		other->position() = position;
+		other->rotation() = rotation;
+	}
+	void World::reschedule(const ImpactEvent& event, const real& h)
+	{
+		Body* body = event.body;
+		Body* other = event.other;
+		auto iter = m_motions.find(other);
+		const bool tracked = iter != m_motions.end();
+		if (tracked && !iter->second.swept && other->type() == Body::BodyType::Dynamic && !m_obstacles.empty() && isFast(other, h))
+			addSwept(other, h);
+
+		AABB changed = CCD::sweep(body, h - event.time);
+		if (tracked)
+			changed.unite(CCD::sweep(other, h - event.time));
+		//leaves of swept bodies keep covering the rest of their sweeps
+		if (m_broadphase != nullptr)
+		{
+			m_broadphase->update(body, CCD::sweep(body, h - event.time));
+			if (tracked && iter->second.swept)
+				m_broadphase->update(other, CCD::sweep(other, h - event.time));
+		}
+		request(body, event.time);
+		if (tracked && iter->second.swept)
+			request(other, event.time);
+
+		//bullets crossing the new sweeps may meet these bodies before their own events
+		auto recheck = [&](Body* bullet)
+		{
+			if (bullet == body || bullet == other || bullet->type() != Body::BodyType::Bullet)
+				return;
+			if (auto motion = m_motions.find(bullet); motion != m_motions.end() && motion->second.swept)
+				request(bullet, event.time);
+		};
+		if (m_broadphase != nullptr)
+		{
+			m_nodes.clear();
+			m_broadphase->query(changed, m_nodes);
+			for (DBVH::Node* node : m_nodes)
+				recheck(node->pair.body);
+			return;
+		}
+		for (size_t i = 0; i < m_fastBodies.size(); i++)
+			if (changed.collide(CCD::sweep(m_fastBodies[i], h - timeOf(m_fastBodies[i]))))
+				recheck(m_fastBodies[i]);
+	}
+	AABB World::reachable(const ImpactEvent& event, const real& h)
+	{
+		Body* body = event.body;
+		Body* other = event.other;
+		//an impulse with restitution and friction up to one changes no velocity by more than twice the approach speed per unit of friction
+		const real friction = Math::sqrt(body->friction() * other->friction());
+		const real approach = (body->velocity() - other->velocity()).length()
+			+ std::abs(body->angularVelocity()) * CCD::reach(body) + std::abs(other->angularVelocity()) * CCD::reach(other);
+		const real change = (1 + Math::min(body->restitution(), other->restitution())) * (1 + friction) * approach * (h - event.time);
+
+		AABB region = CCD::sweep(body, h - timeOf(body));
+		region.expand(2 * (change + CCD::reach(body)));
+		if (other->type() != Body::BodyType::Static)
+		{
+			AABB otherRegion = CCD::sweep(other, h - timeOf(other));
+			otherRegion.expand(2 * (change + CCD::reach(other)));
+			region.unite(otherRegion);
+		}
+		return region;
+	}
+	bool World::independent(const ImpactEvent& event, const AABB& region) const
+	{
+		//static bodies are only read by impacts, links share their articulation
+		auto shares = [](Body* a, Body* b)
+		{
+			if (a == b)
+				return a->type() != Body::BodyType::Static;
+			return a->articulation() != nullptr && a->articulation() == b->articulation();
+		};
+		for (size_t i = 0; i < m_batch.size(); i++)
+		{
+			const ImpactEvent& resolved = m_batch[i];
+			for (Body* a : { event.body, event.other })
+				for (Body* b : { resolved.body, resolved.other })
+					if (shares(a, b))
+						return false;
+			if (region.collide(m_batchRegions[i]))
+				return false;
+		}
+		return true;
+	}
+	World::Motion& World::track(Body* body)
+	{
+		return m_motions[body];
+	}
+	void World::moveTo(Body* body, const real& time)
+	{
+		Motion& motion = m_motions.find(body)->second;
+		body->stepPosition(time - motion.time);
+		motion.time = time;
+	}
+	real World::timeOf(Body* body) const
+	{
+		auto iter = m_motions.find(body);
+		return iter != m_motions.end() ? iter->second.time : 0;
+	}
+	size_t World::versionOf(Body* body) const
+	{
+		auto iter = m_motions.find(body);
+		return iter != m_motions.end() ? iter->second.version : 0;
+	}
+	void World::impact(Body* body, Body* other, const PointPair& closest, const Vector2& offset)
+	{
+		const Vector2 gap = closest.pointB - closest.pointA;
+		const real distance = gap.length();
+		if (realEqual(distance, 0))
+			return;
+		const Vector2 normal = gap / distance;
+
+		//one closest point of touching faces would spin the bodies, so the manifold is taken with body pushed slightly into other
+		std::vector<PointPair> points;
+		const Vector2 shift = normal * (distance + CCD::Tolerance);
+		body->position() += shift;
+		for (const Collision& collision : Detector::detect({ { body, other } }))
+		{
+			for (PointPair pair : collision.contactList)
 			{
-				break;
+				if (collision.bodyA != body)
+					std::swap(pair.pointA, pair.pointB);
+				pair.pointA -= shift;
+				points.emplace_back(pair);
+			}
+		}
+		body->position() -= shift;
+		if (points.empty())
+			points.emplace_back(closest);
+
+		//links respond through their articulation, which still has them where they were placed
+		Articulation* articulation = other->articulation();
+		const bool movable = articulation == nullptr && (other->type() == Body::BodyType::Dynamic || other->type() == Body::BodyType::Bullet);
+		const real im_a = body->inverseMass();
+		const real ii_a = body->inverseInertia();
+		const real im_b = movable ? other->inverseMass() : 0;
+		const real ii_b = movable ? other->inverseInertia() : 0;
+		const real restitution = Math::min(body->restitution(), other->restitution());
+		const real friction = Math::sqrt(body->friction() * other->friction());
+		const Vector2 tangent = normal.perpendicular();
+
+		struct Point
+		{
+			Vector2 ra;
+			Vector2 rb;
+			real normalMass = 0;
+			real tangentMass = 0;
+			real target = 0;
+			real normalImpulse = 0;
+			real tangentImpulse = 0;
+		};
+		auto relative = [&](const Point& point)
+		{
+			return body->velocity() + Vector2::crossProduct(body->angularVelocity(), point.ra)
+				- other->velocity() - Vector2::crossProduct(other->angularVelocity(), point.rb);
+		};
+		auto apply = [&](const Point& point, const Vector2& impulse)
+		{
+			body->applyImpulse(-impulse, point.ra);
+			if (articulation != nullptr)
+				articulation->applyImpulse(other->link(), impulse, other->position() - offset + point.rb);
+			else if (movable)
+				other->applyImpulse(impulse, point.rb);
+		};
+		std::vector<Point> manifold;
+		for (const PointPair& pair : points)
+		{
+			Point point;
+			point.ra = pair.pointA - body->position();
+			point.rb = pair.pointB - other->position();
+			const real rn_a = point.ra.cross(normal);
+			const real rn_b = point.rb.cross(normal);
+			const real rt_a = point.ra.cross(tangent);
+			const real rt_b = point.rb.cross(tangent);
+			real k = im_a + ii_a * rn_a * rn_a + im_b + ii_b * rn_b * rn_b;
+			real kt = im_a + ii_a * rt_a * rt_a + im_b + ii_b * rt_b * rt_b;
+			if (articulation != nullptr)
+			{
+				const Vector2 linkPoint = other->position() - offset + point.rb;
+				k += articulation->inverseMass(other->link(), linkPoint, normal);
+				kt += articulation->inverseMass(other->link(), linkPoint, tangent);
+			}
+			if (realEqual(k, 0))
+				continue;
+			point.normalMass = 1 / k;
+			point.tangentMass = realEqual(kt, 0) ? 0 : 1 / kt;
+			//approaching speed is turned into separating speed scaled by restitution
+			point.target = -restitution * Math::max(relative(point).dot(normal), 0);
+			manifold.emplace_back(point);
+		}
+
+		//a few sequential impulse iterations share the impact among the points
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			for (Point& point : manifold)
+			{
+				const Vector2 v = relative(point);
+				const real oldNormal = point.normalImpulse;
+				point.normalImpulse = Math::max(oldNormal + point.normalMass * (v.dot(normal) - point.target), 0);
+				apply(point, (point.normalImpulse - oldNormal) * normal);
+
+				const real maxFriction = friction * point.normalImpulse;
+				const real oldTangent = point.tangentImpulse;
+				point.tangentImpulse = Math::clamp(oldTangent + point.tangentMass * relative(point).dot(tangent), -maxFriction, maxFriction);
+				apply(point, (point.tangentImpulse - oldTangent) * tangent);
 			}
+		}
+	}
+	void World::findCandidates(Body* body, const AABB& region, Scan& scan) const
+	{
+		scan.candidates.clear();
+		const bool bullet = body->type() == Body::BodyType::Bullet;
+		if (m_broadphase == nullptr)
+		{
+			if (!bullet)
+			{
+				scan.candidates = m_obstacles;
+				return;
 			}
+			for (auto& element : m_bodyList)
+				if (element.get() != body)
+					scan.candidates.emplace_back(element.get());
+			return;
+		}
+
+		scan.nodes.clear();
+		m_broadphase->query(region, scan.nodes, body);
+		for (DBVH::Node* node : scan.nodes)
+		{
+			Body* other = node->pair.body;
+			if (bullet || other->type() == Body::BodyType::Static || other->type() == Body::BodyType::Kinematic)
+				scan.candidates.emplace_back(other);
 		}
 	}
-	void World::step(const real& dt)
+	bool World::isFast(Body* body, const real& h) const
+	{
+		const AABB aabb = AABB::fromBody(body);
+		const real extent = Math::min(aabb.width, aabb.height) * 0.5;
+		const real travel = (body->velocity().length() + std::abs(body->angularVelocity()) * Math::max(aabb.width, aabb.height) * 0.5) * h;
+		return travel > extent;
+	}
+	void World::clearForces()
 	{
-		const Vector2 g = m_enableGravity ? m_gravity : (0, 0);
 		for (auto& body : m_bodyList)
 		{
-			switch (body->type())
+			if (body->type() == Body::BodyType::Static)
+				continue;
+
+			body->forces().clear();
+			body->clearTorque();
+		}
+	}
+	void World::colorJoints()
+	{
+		m_jointGraph.reset(2 * m_jointList.size());
+		m_jointColors.resize(ConstraintGraph::Overflow + 1);
+		for (auto& batch : m_jointColors)
+			batch.clear();
+
+		for (auto& joint : m_jointList)
+		{
+			const size_t color = m_jointGraph.color(m_jointGraph.slot(joint->bodyA()), m_jointGraph.slot(joint->bodyB()));
+			JointBatch& batch = m_jointColors[color];
+			switch (joint->type())
 			{
-			case Body::BodyType::Static:
+			case JointType::Distance:
+				batch.distance.emplace_back(static_cast<DistanceJoint*>(joint.get()));
+				break;
+			case JointType::Point:
+				batch.point.emplace_back(static_cast<PointJoint*>(joint.get()));
+				break;
+			case JointType::Rotation:
+				batch.rotation.emplace_back(static_cast<RotationJoint*>(joint.get()));
+				break;
+			case JointType::Orientation:
+				batch.orientation.emplace_back(static_cast<OrientationJoint*>(joint.get()));
+				break;
+			default:
+				batch.others.emplace_back(joint.get());
 				break;
-			case Body::BodyType::Dynamic:
-				{
-					const Vector2 forces = g + body->forces();
-					const Vector2 a = body->inverseMass() * forces;
-					const Vector2 v = (body->velocity() + a * dt * m_velocityIteration) * m_linearVelocityDamping;
-					const Vector2 p = body->position() + v * dt * m_positionIteration;
-
-					const real b = body->inverseInertia() * body->torques();
-					const real av = (body->angularVelocity() + b * dt * m_velocityIteration) * m_angularVelocityDamping;
-					const real rotation = body->rotation() + av * dt * m_positionIteration;
-
-					body->velocity() = v;
-					body->position() = p;
-					body->angularVelocity() = av;
-					body->rotation() = rotation;
-
-					body->forces().clear();
-					body->clearTorque();
-					break;
-				}
-			case Body::BodyType::Kinematic:
-				{
-					break;
-				}
-			case Body::BodyType::Bullet:
-				{
-					break;
-				}
 			}
 		}
 	}
+	void World::step(const real& dt)
+	{
+		//integrated and swept like stepVelocity and stepPosition without constraints, moving bodies are damped
+		integrateVelocity(dt);
+		for (auto& body : m_bodyList)
+		{
+			if (body->articulation() != nullptr)
+				continue;
+			if (body->type() != Body::BodyType::Dynamic && body->type() != Body::BodyType::Bullet)
+				continue;
+			body->velocity() *= m_linearVelocityDamping;
+			body->angularVelocity() *= m_angularVelocityDamping;
+		}
+		integratePosition(dt);
+		clearForces();
+	}
 	
 	real World::bias() const
 	{
@@ -149,6 +711,16 @@ namespace Physics2D
 		m_velocityIteration = velocityIteration;
 	}
 
+	bool World::positionCorrection() const
+	{
+		return m_positionCorrection;
+	}
+
+	void World::setPositionCorrection(const bool& positionCorrection)
+	{
+		m_positionCorrection = positionCorrection;
+	}
+
 	real World::positionIteration() const
 	{
 		return m_positionIteration;
@@ -159,6 +731,46 @@ namespace Physics2D
 		m_positionIteration = positionIteration;
 	}
 
+	World::SolverMode World::solverMode() const
+	{
+		return m_solverMode;
+	}
+
+	void World::setSolverMode(const SolverMode& solverMode)
+	{
+		m_solverMode = solverMode;
+	}
+
+	int World::substeps() const
+	{
+		return m_substeps;
+	}
+
+	void World::setSubsteps(const int& substeps)
+	{
+		m_substeps = Math::max(substeps, 1);
+	}
+
+	real World::jointHertz() const
+	{
+		return m_jointHertz;
+	}
+
+	void World::setJointHertz(const real& jointHertz)
+	{
+		m_jointHertz = jointHertz;
+	}
+
+	real World::jointDampingRatio() const
+	{
+		return m_jointDampingRatio;
+	}
+
+	void World::setJointDampingRatio(const real& jointDampingRatio)
+	{
+		m_jointDampingRatio = jointDampingRatio;
+	}
+
 	Integrator World::integrator() const
 	{
 		return m_integrator;
@@ -169,6 +781,16 @@ namespace Physics2D
 		m_integrator = integrator;
 	}
 
+	DBVH* World::broadphase() const
+	{
+		return m_broadphase;
+	}
+
+	void World::setBroadphase(DBVH* broadphase)
+	{
+		m_broadphase = broadphase;
+	}
+
 	std::vector<std::unique_ptr<Body>>& World::bodyList()
 	{
 		return m_bodyList;
@@ -178,6 +800,16 @@ namespace Physics2D
 	{
 		return m_jointList;
 	}
+
+	std::vector<std::unique_ptr<Rope>>& World::ropeList()
+	{
+		return m_ropeList;
+	}
+
+	std::vector<std::unique_ptr<Articulation>>& World::articulationList()
+	{
+		return m_articulationList;
+	}
 	
 	Vector2 World::gravity() const
 	{
@@ -328,4 +960,20 @@ namespace Physics2D
 		m_jointList.emplace_back(std::move(joint));
 		return temp;
 	}
+
+	Rope* World::createRope(const RopePrimitive& primitive)
+	{
+		auto rope = std::make_unique<Rope>(primitive);
+		Rope* temp = rope.get();
+		m_ropeList.emplace_back(std::move(rope));
+		return temp;
+	}
+
+	Articulation* World::createArticulation(Body* root)
+	{
+		auto articulation = std::make_unique<Articulation>(root);
+		Articulation* temp = articulation.get();
+		m_articulationList.emplace_back(std::move(articulation));
+		return temp;
+	}
 }
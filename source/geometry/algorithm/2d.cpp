@@ -447,4 +447,159 @@ namespace Physics2D
 		return ra >= 0 && rb >= 0 && rc >= 0
 		|| ra <= 0 && rb <= 0 && rc <= 0;
 	}
+
+	std::vector<size_t> GeometryAlgorithm2D::triangulate(const std::vector<Vector2>& vertices)
+	{
+		std::vector<size_t> result;
+		size_t count = vertices.size();
+		if (count > 1 && vertices.front().fuzzyEqual(vertices.back()))
+			count--;
+		if (count < 3)
+			return result;
+
+		real area = 0;
+		for (size_t i = 0; i < count; i++)
+			area += vertices[i].cross(vertices[(i + 1) % count]);
+
+		std::vector<size_t> remain(count);
+		for (size_t i = 0; i < count; i++)
+			remain[i] = i;
+		if (area < 0)
+			std::reverse(remain.begin(), remain.end());
+
+		auto isEar = [&](const size_t& prev, const size_t& curr, const size_t& next)
+		{
+			const Vector2& a = vertices[prev];
+			const Vector2& b = vertices[curr];
+			const Vector2& c = vertices[next];
+			for (const size_t& index : remain)
+			{
+				if (index == prev || index == curr || index == next)
+					continue;
+				const Vector2& p = vertices[index];
+				if (p.fuzzyEqual(a) || p.fuzzyEqual(b) || p.fuzzyEqual(c))
+					continue;
+				if ((b - a).cross(p - a) >= 0 && (c - b).cross(p - b) >= 0 && (a - c).cross(p - c) >= 0)
+					return false;
+			}
+			return true;
+		};
+
+		size_t i = 0;
+		size_t tried = 0;
+		while (remain.size() > 3)
+		{
+			const size_t size = remain.size();
+			i %= size;
+			const size_t prev = remain[(i + size - 1) % size];
+			const size_t curr = remain[i];
+			const size_t next = remain[(i + 1) % size];
+			const real cross = (vertices[curr] - vertices[prev]).cross(vertices[next] - vertices[curr]);
+
+			//collinear vertex adds nothing, drop it
+			if (std::abs(cross) < Constant::GeometryEpsilon)
+			{
+				remain.erase(remain.begin() + i);
+				tried = 0;
+				continue;
+			}
+			//no ear left means the polygon is not simple, clip anyway to terminate
+			if ((cross > 0 && isEar(prev, curr, next)) || tried > size)
+			{
+				result.insert(result.end(), { prev, curr, next });
+				remain.erase(remain.begin() + i);
+				tried = 0;
+				continue;
+			}
+			i++;
+			tried++;
+		}
+		const real cross = (vertices[remain[1]] - vertices[remain[0]]).cross(vertices[remain[2]] - vertices[remain[1]]);
+		if (std::abs(cross) >= Constant::GeometryEpsilon)
+			result.insert(result.end(), remain.begin(), remain.end());
+		return result;
+	}
+
+	std::vector<std::vector<Vector2>> GeometryAlgorithm2D::convexDecomposition(const std::vector<Vector2>& vertices)
+	{
+		const std::vector<size_t> triangles = triangulate(vertices);
+		std::vector<std::vector<size_t>> pieces;
+		pieces.reserve(triangles.size() / 3);
+		for (size_t i = 0; i + 2 < triangles.size(); i += 3)
+			pieces.push_back({ triangles[i], triangles[i + 1], triangles[i + 2] });
+
+		auto isConvex = [&](const std::vector<size_t>& piece)
+		{
+			const size_t size = piece.size();
+			for (size_t i = 0; i < size; i++)
+			{
+				const Vector2& a = vertices[piece[i]];
+				const Vector2& b = vertices[piece[(i + 1) % size]];
+				const Vector2& c = vertices[piece[(i + 2) % size]];
+				if ((b - a).cross(c - b) < -Constant::GeometryEpsilon)
+					return false;
+			}
+			return true;
+		};
+		//merge piece j into piece i across diagonal a -> b of piece i, which is b -> a in piece j
+		auto merge = [&](const std::vector<size_t>& first, const std::vector<size_t>& second, std::vector<size_t>& result)
+		{
+			for (size_t i = 0; i < first.size(); i++)
+			{
+				const size_t a = first[i];
+				const size_t b = first[(i + 1) % first.size()];
+				for (size_t j = 0; j < second.size(); j++)
+				{
+					if (second[j] != b || second[(j + 1) % second.size()] != a)
+						continue;
+					result.clear();
+					for (size_t k = 0; k < first.size(); k++)
+						result.emplace_back(first[(i + 1 + k) % first.size()]);
+					for (size_t k = 2; k < second.size(); k++)
+						result.emplace_back(second[(j + k) % second.size()]);
+					return true;
+				}
+			}
+			return false;
+		};
+
+		std::vector<size_t> merged;
+		bool changed = true;
+		while (changed)
+		{
+			changed = false;
+			for (size_t i = 0; i < pieces.size() && !changed; i++)
+			{
+				for (size_t j = i + 1; j < pieces.size(); j++)
+				{
+					if (!merge(pieces[i], pieces[j], merged) || !isConvex(merged))
+						continue;
+					pieces[i] = merged;
+					pieces.erase(pieces.begin() + j);
+					changed = true;
+					break;
+				}
+			}
+		}
+
+		std::vector<std::vector<Vector2>> result;
+		result.reserve(pieces.size());
+		for (const auto& piece : pieces)
+		{
+			std::vector<Vector2> polygon;
+			for (size_t i = 0; i < piece.size(); i++)
+			{
+				//skip vertices lying on the straight line of neighbors
+				const Vector2& prev = vertices[piece[(i + piece.size() - 1) % piece.size()]];
+				const Vector2& curr = vertices[piece[i]];
+				const Vector2& next = vertices[piece[(i + 1) % piece.size()]];
+				if (std::abs((curr - prev).cross(next - curr)) < Constant::GeometryEpsilon)
+					continue;
+				polygon.emplace_back(curr);
+			}
+			polygon.emplace_back(polygon.front());
+			result.emplace_back(polygon);
+		}
+		return result;
+	}
 }
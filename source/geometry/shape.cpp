@@ -1,5 +1,6 @@
 #include "include/geometry/shape.h"
 #include "include/geometry/algorithm/2d.h"
+#include "include/collision/broadphase/aabb.h"
 
 namespace Physics2D
 {
@@ -43,15 +44,22 @@ namespace Physics2D
 		return m_vertices;
 	}
 
+	const std::vector<Vector2>& Polygon::normals() const
+	{
+		return m_normals;
+	}
+
 	void Polygon::append(const std::initializer_list<Vector2>& vertices)
 	{
 		for (const Vector2& vertex : vertices)
 			m_vertices.emplace_back(vertex);
+		updateNormals();
 	}
 
 	void Polygon::append(const Vector2& vertex)
 	{
 		m_vertices.emplace_back(vertex);
+		updateNormals();
 	}
 
 	Vector2 Polygon::center()const
@@ -66,6 +74,26 @@ namespace Physics2D
 			vertex *= factor;
 	}
 
+	void Polygon::updateNormals()
+	{
+		m_normals.clear();
+		if (m_vertices.size() < 2)
+			return;
+
+		//orientation of vertices, outward normal is on the right side of ccw edges
+		real area = 0;
+		for (size_t i = 0; i < m_vertices.size() - 1; i++)
+			area += m_vertices[i].cross(m_vertices[i + 1]);
+
+		for (size_t i = 0; i < m_vertices.size() - 1; i++)
+		{
+			Vector2 normal = (m_vertices[i + 1] - m_vertices[i]).perpendicular();
+			if (area > 0)
+				normal.negate();
+			m_normals.emplace_back(normal.isOrigin() ? normal : normal.normal());
+		}
+	}
+
 	bool Polygon::contains(const Vector2& point, const real& epsilon)
 	{
 		for(int i = 0;i < m_vertices.size() - 1;i++)
@@ -131,6 +159,7 @@ namespace Physics2D
 		m_vertices.emplace_back(Vector2(m_width * (0.5f), -m_height * (0.5f)));
 		m_vertices.emplace_back(Vector2(m_width * (0.5f), m_height * (0.5f)));
 		m_vertices.emplace_back(Vector2(-m_width * (0.5f), m_height * (0.5f)));
+		updateNormals();
 	}
 
 	Circle::Circle() : m_radius(0)
@@ -430,6 +459,29 @@ namespace Physics2D
 	{
 		return Matrix2x2(rotation).multiply(source) + transform;
 	}
+	real ShapePrimitive::radius() const
+	{
+		switch (shape->type())
+		{
+		case Shape::Type::Circle:
+			return static_cast<const Circle*>(shape.get())->radius() + shape->skin();
+		case Shape::Type::Capsule:
+		{
+			const Capsule* capsule = static_cast<const Capsule*>(shape.get());
+			return Math::min(capsule->width(), capsule->height()) * 0.5 + shape->skin();
+		}
+		default:
+			return shape->skin();
+		}
+	}
+	ShapePrimitive ShapePrimitive::compose(const ShapePrimitive& local) const
+	{
+		ShapePrimitive result;
+		result.shape = local.shape;
+		result.rotation = rotation + local.rotation;
+		result.transform = translate(local.transform);
+		return result;
+	}
 	Sector::Sector()
 	{
 		m_startRadian = 0;
@@ -490,4 +542,311 @@ namespace Physics2D
 		m_endRadian = end;
 		m_radius = radius;
 	}
+
+	Compound::Compound()
+	{
+		m_type = Type::Compound;
+	}
+
+	bool Compound::contains(const Vector2& point, const real& epsilon)
+	{
+		for (const ShapePrimitive& child : m_children)
+			if (child.shape->contains(Matrix2x2(-child.rotation).multiply(point - child.transform), epsilon))
+				return true;
+		return false;
+	}
+
+	void Compound::scale(const real& factor)
+	{
+		for (ShapePrimitive& child : m_children)
+		{
+			child.shape->scale(factor);
+			child.transform *= factor;
+		}
+		updateTree();
+	}
+
+	Vector2 Compound::center() const
+	{
+		Vector2 result;
+		if (m_children.empty())
+			return result;
+		for (const ShapePrimitive& child : m_children)
+			result += child.translate(child.shape->center());
+		return result / static_cast<real>(m_children.size());
+	}
+
+	void Compound::append(const std::shared_ptr<Shape>& shape, const Vector2& position, const real& rotation)
+	{
+		assert(shape != nullptr && shape->type() != Type::Compound);
+		ShapePrimitive child;
+		child.shape = shape;
+		child.transform = position;
+		child.rotation = rotation;
+		m_children.emplace_back(child);
+		updateTree();
+	}
+
+	void Compound::appendConcave(const std::vector<Vector2>& vertices)
+	{
+		for (const auto& piece : GeometryAlgorithm2D::convexDecomposition(vertices))
+		{
+			auto polygon = std::make_shared<Polygon>();
+			for (const Vector2& vertex : piece)
+				polygon->append(vertex);
+			ShapePrimitive child;
+			child.shape = polygon;
+			m_children.emplace_back(child);
+		}
+		updateTree();
+	}
+
+	void Compound::clear()
+	{
+		m_children.clear();
+		m_tree.clear();
+	}
+
+	const std::vector<ShapePrimitive>& Compound::children() const
+	{
+		return m_children;
+	}
+
+	const StaticTree& Compound::tree() const
+	{
+		return m_tree;
+	}
+
+	void Compound::updateTree()
+	{
+		std::vector<AABB> boxes;
+		boxes.reserve(m_children.size());
+		for (const ShapePrimitive& child : m_children)
+			boxes.emplace_back(AABB::fromShape(child));
+		m_tree.build(boxes);
+	}
+
+	Chain::Chain()
+	{
+		m_type = Type::Chain;
+	}
+
+	bool Chain::contains(const Vector2& point, const real& epsilon)
+	{
+		for (size_t i = 0; i < segmentCount(); i++)
+		{
+			const Segment target = segment(i);
+			if ((GeometryAlgorithm2D::pointToLineSegment(target.start, target.end, point) - point).lengthSquare() < epsilon)
+				return true;
+		}
+		return false;
+	}
+
+	void Chain::scale(const real& factor)
+	{
+		for (Vector2& vertex : m_vertices)
+			vertex *= factor;
+		updateTree();
+	}
+
+	Vector2 Chain::center() const
+	{
+		Vector2 result;
+		if (m_vertices.empty())
+			return result;
+		for (const Vector2& vertex : m_vertices)
+			result += vertex;
+		return result / static_cast<real>(m_vertices.size());
+	}
+
+	void Chain::set(const std::vector<Vector2>& vertices, bool loop)
+	{
+		m_vertices = vertices;
+		//closing vertex is implied by loop
+		if (loop && m_vertices.size() > 1 && m_vertices.front().fuzzyEqual(m_vertices.back()))
+			m_vertices.pop_back();
+		m_loop = loop && m_vertices.size() > 2;
+		updateTree();
+	}
+
+	const std::vector<Vector2>& Chain::vertices() const
+	{
+		return m_vertices;
+	}
+
+	bool Chain::loop() const
+	{
+		return m_loop;
+	}
+
+	size_t Chain::segmentCount() const
+	{
+		if (m_vertices.size() < 2)
+			return 0;
+		return m_loop ? m_vertices.size() : m_vertices.size() - 1;
+	}
+
+	Chain::Segment Chain::segment(const size_t& index) const
+	{
+		assert(index < segmentCount());
+		const size_t count = m_vertices.size();
+		Segment result;
+		result.start = m_vertices[index];
+		result.end = m_vertices[(index + 1) % count];
+		if (index > 0 || m_loop)
+			result.previous = m_vertices[(index + count - 1) % count];
+		if (index + 2 < count || m_loop)
+			result.next = m_vertices[(index + 2) % count];
+		return result;
+	}
+
+	const StaticTree& Chain::tree() const
+	{
+		return m_tree;
+	}
+
+	void Chain::updateTree()
+	{
+		std::vector<AABB> boxes;
+		boxes.reserve(segmentCount());
+		for (size_t i = 0; i < segmentCount(); i++)
+		{
+			const Vector2& start = m_vertices[i];
+			const Vector2& end = m_vertices[(i + 1) % m_vertices.size()];
+			AABB box;
+			box.position = (start + end) * 0.5;
+			box.width = std::abs(start.x - end.x);
+			box.height = std::abs(start.y - end.y);
+			boxes.emplace_back(box);
+		}
+		m_tree.build(boxes);
+	}
+
+	Heightfield::Heightfield()
+	{
+		m_type = Type::Heightfield;
+	}
+
+	bool Heightfield::contains(const Vector2& point, const real& epsilon)
+	{
+		if (segmentCount() == 0 || point.x < m_left - epsilon || point.x > right() + epsilon)
+			return false;
+		const size_t index = std::min(static_cast<size_t>(Math::max(std::floor((point.x - m_left) / m_spacing), 0)), segmentCount() - 1);
+		const Chain::Segment column = segment(index);
+		const real t = Math::clamp((point.x - column.end.x) / m_spacing, 0, 1);
+		return point.y <= column.end.y + (column.start.y - column.end.y) * t + epsilon;
+	}
+
+	void Heightfield::scale(const real& factor)
+	{
+		for (real& height : m_heights)
+			height *= factor;
+		m_spacing *= factor;
+		m_left *= factor;
+		updateBounds();
+	}
+
+	Vector2 Heightfield::center() const
+	{
+		return Vector2((m_left + right()) * 0.5, (m_minHeight + m_maxHeight) * 0.5);
+	}
+
+	void Heightfield::set(const std::vector<real>& heights, const real& spacing, const real& left)
+	{
+		assert(spacing > 0);
+		m_heights = heights;
+		m_spacing = spacing;
+		m_left = left;
+		updateBounds();
+	}
+
+	void Heightfield::setHeight(const size_t& index, const real& height)
+	{
+		assert(index < m_heights.size());
+		const real old = m_heights[index];
+		m_heights[index] = height;
+		//only a sample that was on the bounds can shrink them
+		if ((old <= m_minHeight && height > old) || (old >= m_maxHeight && height < old))
+			updateBounds();
+		else
+		{
+			m_minHeight = Math::min(m_minHeight, height);
+			m_maxHeight = Math::max(m_maxHeight, height);
+		}
+	}
+
+	const std::vector<real>& Heightfield::heights() const
+	{
+		return m_heights;
+	}
+
+	real Heightfield::spacing() const
+	{
+		return m_spacing;
+	}
+
+	real Heightfield::left() const
+	{
+		return m_left;
+	}
+
+	real Heightfield::right() const
+	{
+		return m_left + m_spacing * static_cast<real>(segmentCount());
+	}
+
+	real Heightfield::minHeight() const
+	{
+		return m_minHeight;
+	}
+
+	real Heightfield::maxHeight() const
+	{
+		return m_maxHeight;
+	}
+
+	Vector2 Heightfield::sample(const size_t& index) const
+	{
+		assert(index < m_heights.size());
+		return Vector2(m_left + m_spacing * static_cast<real>(index), m_heights[index]);
+	}
+
+	size_t Heightfield::segmentCount() const
+	{
+		return m_heights.size() < 2 ? 0 : m_heights.size() - 1;
+	}
+
+	Chain::Segment Heightfield::segment(const size_t& index) const
+	{
+		assert(index < segmentCount());
+		Chain::Segment result;
+		result.start = sample(index + 1);
+		result.end = sample(index);
+		if (index + 2 < m_heights.size())
+			result.previous = sample(index + 2);
+		if (index > 0)
+			result.next = sample(index - 1);
+		return result;
+	}
+
+	std::tuple<size_t, size_t> Heightfield::columns(const real& minX, const real& maxX) const
+	{
+		const size_t count = segmentCount();
+		if (count == 0 || maxX < m_left || minX > right())
+			return { 0, 0 };
+		const real first = Math::max(std::floor((minX - m_left) / m_spacing), 0);
+		const real last = std::floor((maxX - m_left) / m_spacing) + 1;
+		return { static_cast<size_t>(first), std::min(static_cast<size_t>(Math::max(last, 0)), count) };
+	}
+
+	void Heightfield::updateBounds()
+	{
+		m_minHeight = 0;
+		m_maxHeight = 0;
+		if (m_heights.empty())
+			return;
+		const auto [min, max] = std::minmax_element(m_heights.begin(), m_heights.end());
+		m_minHeight = *min;
+		m_maxHeight = *max;
+	}
 }
@@ -0,0 +1,83 @@
+#include "include/utils/worker_pool.h"
+
+namespace Physics2D::Utils
+{
+	WorkerPool::WorkerPool(size_t threads)
+	{
+		threads = std::max<size_t>(threads, 1);
+		m_threads.reserve(threads - 1);
+		for (size_t i = 1; i < threads; i++)
+			m_threads.emplace_back(&WorkerPool::run, this, i);
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_start.notify_all();
+		for (auto& thread : m_threads)
+			thread.join();
+	}
+
+	size_t WorkerPool::size() const
+	{
+		return m_threads.size() + 1;
+	}
+
+	void WorkerPool::forEach(const size_t& count, const Task& task)
+	{
+		if (count == 0)
+			return;
+
+		const size_t workers = std::min(size(), count);
+		if (workers == 1)
+		{
+			task(0, count, 0);
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_task = &task;
+			m_count = count;
+			m_workers = workers;
+			m_pending = workers - 1;
+			++m_generation;
+		}
+		m_start.notify_all();
+
+		task(0, count / workers, 0);
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this] { return m_pending == 0; });
+		m_task = nullptr;
+	}
+
+	void WorkerPool::run(size_t worker)
+	{
+		size_t generation = 0;
+		while (true)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_start.wait(lock, [&] { return m_stop || m_generation != generation; });
+			if (m_stop)
+				return;
+
+			generation = m_generation;
+			if (worker >= m_workers)
+				continue;
+
+			const Task* task = m_task;
+			const size_t begin = m_count * worker / m_workers;
+			const size_t end = m_count * (worker + 1) / m_workers;
+			lock.unlock();
+
+			(*task)(begin, end, worker);
+
+			lock.lock();
+			if (--m_pending == 0)
+				m_done.notify_one();
+		}
+	}
+}
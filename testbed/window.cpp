@@ -47,8 +47,11 @@ namespace Physics2D
 		m_world.setLinearVelocityDamping(0.8f);
 		m_world.setAirFrictionCoefficient(0.8f);
 		m_world.setAngularVelocityDamping(0.8f);
-		m_world.setPositionIteration(1);
+		m_world.setPositionIteration(3);
 		m_world.setVelocityIteration(1);
+		m_world.setPositionCorrection(true);
+		contactMaintainer.m_blockSolve = true;
+		contactMaintainer.m_positionCorrection = true;
 		
 		//createStackBox(6, 1.1, 1.1);
 		//createBoxRoom();
@@ -63,6 +66,7 @@ namespace Physics2D
 		camera.setViewport(Utils::Camera::Viewport((0, 0), (1920, 1080)));
 		camera.setWorld(&m_world);
 		camera.setDbvh(&dbvh);
+		m_world.setBroadphase(&dbvh);
 		camera.setTree(&tree);
 		
 		camera.setAabbVisible(false);
@@ -192,23 +196,28 @@ namespace Physics2D
 		const real inv_dt = 30;
 
 		
-		m_world.stepVelocity(dt);
+		if (m_world.solverMode() == World::SolverMode::Substep)
+		{
+			for (auto& result : Detector::detect(dbvh.generatePairs(), &workerPool, dt, &manifoldCache))
+				contactMaintainer.add(result);
 
-		for(int i = 0;i < 1;i++)
+			m_world.substep(dt, contactMaintainer, &workerPool);
+		}
+		else
 		{
-			auto potentialList = dbvh.generatePairs();
-			for (auto pair : potentialList)
+			m_world.stepVelocity(dt, &workerPool);
+
+			for (int i = 0; i < 1; i++)
 			{
-				auto result = Detector::detect(pair.first, pair.second);
-				if (result.isColliding)
+				auto potentialList = dbvh.generatePairs();
+				for (auto& result : Detector::detect(potentialList, &workerPool, dt, &manifoldCache))
 					contactMaintainer.add(result);
+
+				contactMaintainer.solve(dt, &workerPool);
 			}
 
-			contactMaintainer.solve(dt);
+			m_world.stepPosition(dt, &workerPool, &contactMaintainer);
 		}
-		
-
-		m_world.stepPosition(dt);
 
 		for (auto& body : m_world.bodyList())
 			dbvh.update(body.get());
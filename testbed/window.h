@@ -20,6 +20,7 @@
 
 #include "include/collision/broadphase/tree.h"
 #include "include/utils/camera.h"
+#include "include/utils/worker_pool.h"
 #include "include/collision/continuous/ccd.h"
 
 namespace Physics2D
@@ -122,6 +123,8 @@ namespace Physics2D
 		real roomSize = 10;
 
 		ContactMaintainer contactMaintainer;
+		Utils::WorkerPool workerPool;
+		ManifoldCache manifoldCache{ 0.0001, 0.0001 };
 	};
 	
 }
@@ -17,9 +17,22 @@ namespace Physics2D
 		{
 			fmt::print("-----{} starts-----\n", m_name);
 			run();
-			fmt::print("-----{} ends-----\n", m_name);
+			fmt::print("-----{} ends, {} failed-----\n", m_name, m_failures);
+		}
+		int failures()const
+		{
+			return m_failures;
 		}
 	protected:
+		//report a broken expectation and keep running, so that one pass shows every failure of a scenario
+		void check(const bool& condition, const std::string& what)
+		{
+			if (condition)
+				return;
+			m_failures++;
+			fmt::print("failed: {}\n", what);
+		}
 		std::string m_name;
+		int m_failures = 0;
 	};
 }
@@ -0,0 +1,111 @@
+#pragma once
+#include "include/physics2d.h"
+#include "include/dynamics/world.h"
+#include "include/dynamics/articulation.h"
+#include "tests/test.h"
+namespace Physics2D
+{
+	class ArticulationTest : public Test
+	{
+	public:
+		ArticulationTest() : Test("articulation test")
+		{
+		}
+		void run() override
+		{
+			testChain();
+			testFloating();
+		}
+		//chains of 0.5m, 1kg bars released horizontally must stay finite and gain little energy at testbed steps
+		void testChain()
+		{
+			const Vector2 gravity(0, -9.8);
+			for (const real& hz : { 60, 30 })
+			{
+				for (const int& count : { 3, 4, 5, 20 })
+				{
+					World world;
+					world.setGravity(gravity);
+					auto bar = std::make_shared<Rectangle>(0.5, 0.1);
+					Articulation* articulation = world.createArticulation(make(world, bar, { 0, 0 }, Body::BodyType::Static));
+					size_t parent = 0;
+					for (int i = 0; i < count; i++)
+						parent = articulation->addRevolute(parent, make(world, bar, { 0.5 * (i + 1), 0 }, Body::BodyType::Dynamic), { 0.25, 0 }, { -0.25, 0 });
+
+					const real start = energy(world, gravity);
+					real gain = 0;
+					bool finite = true;
+					for (int step = 0; step < 10 * hz && finite; step++)
+					{
+						world.stepVelocity(1 / hz);
+						world.stepPosition(1 / hz);
+						const real current = energy(world, gravity) - start;
+						finite = std::isfinite(current);
+						gain = finite ? Math::max(gain, current) : current;
+					}
+					//potential energy the chain has to swing with, released from horizontal
+					const real scale = -gravity.y * count * 0.25 * count;
+					check(finite && gain < 0.15 * scale, fmt::format("{} links at {} Hz gain {} J of {} J", count, hz, gain, scale));
+				}
+			}
+		}
+		//without gravity a floating tree keeps the momentum impulses gave it while its links swing
+		void testFloating()
+		{
+			World world;
+			world.setGravity({ 0, 0 });
+			auto bar = std::make_shared<Rectangle>(0.5, 0.2);
+			Body* root = make(world, bar, { 1, 2 }, Body::BodyType::Dynamic);
+			root->setMass(2);
+			Articulation* articulation = world.createArticulation(root);
+			Body* first = make(world, bar, { 1.5, 2 }, Body::BodyType::Dynamic);
+			Body* second = make(world, bar, { 2, 2 }, Body::BodyType::Dynamic);
+			Body* slider = make(world, bar, { 1, 2.5 }, Body::BodyType::Dynamic);
+			slider->rotation() = Constant::Pi / 2;
+			articulation->addRevolute(0, first, { 0.25, 0 }, { -0.25, 0 });
+			const size_t tip = articulation->addRevolute(1, second, { 0.25, 0 }, { -0.25, 0 });
+			articulation->addPrismatic(0, slider, { 0, 0.1 }, { -0.25, 0 }, { 0, 1 });
+			articulation->applyImpulse(tip, { 0.3, 1 }, second->toWorldPoint({ 0.2, 0 }));
+			articulation->applyImpulse(0, { -0.5, 0.2 }, root->toWorldPoint({ -0.2, 0.1 }));
+
+			Vector2 momentum;
+			for (auto& body : world.bodyList())
+				momentum += body->mass() * body->velocity();
+			check(std::fabs(momentum.x + 0.2) < 1e-9 && std::fabs(momentum.y - 1.2) < 1e-9,
+				fmt::format("impulses give momentum ({}, {})", momentum.x, momentum.y));
+			for (int step = 0; step < 600; step++)
+			{
+				world.stepVelocity(1.0 / 60);
+				world.stepPosition(1.0 / 60);
+			}
+			momentum.clear();
+			for (auto& body : world.bodyList())
+				momentum += body->mass() * body->velocity();
+			check(std::fabs(momentum.x + 0.2) < 1e-6 && std::fabs(momentum.y - 1.2) < 1e-6,
+				fmt::format("floating tree ends with momentum ({}, {})", momentum.x, momentum.y));
+		}
+	private:
+		Body* make(World& world, const std::shared_ptr<Shape>& shape, const Vector2& position, const Body::BodyType& type)
+		{
+			Body* body = world.createBody();
+			body->setShape(shape);
+			body->position() = position;
+			body->setMass(1);
+			body->setType(type);
+			return body;
+		}
+		//kinetic and potential energy of dynamic bodies
+		real energy(World& world, const Vector2& gravity)
+		{
+			real energy = 0;
+			for (auto& body : world.bodyList())
+			{
+				if (body->type() != Body::BodyType::Dynamic)
+					continue;
+				energy += 0.5 * body->mass() * body->velocity().lengthSquare() + 0.5 * body->inertia() * body->angularVelocity() * body->angularVelocity()
+					- body->mass() * gravity.dot(body->position());
+			}
+			return energy;
+		}
+	};
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include "include/physics2d.h"
+#include "include/dynamics/world.h"
+#include "include/collision/broadphase/dbvh.h"
+#include "include/utils/worker_pool.h"
+#include "tests/test.h"
+namespace Physics2D
+{
+	class BulletTest : public Test
+	{
+	public:
+		BulletTest() : Test("bullet test")
+		{
+		}
+		void run() override
+		{
+			testWall();
+			testCrossing();
+			testWorkers();
+		}
+		//a bullet crossing more than the wall in one step stops at its face and bounces off
+		void testWall()
+		{
+			for (const real& restitution : { 0, 1 })
+			{
+				World world;
+				world.setGravity({ 0, 0 });
+				world.setLinearVelocityDamping(1);
+				world.setAngularVelocityDamping(1);
+				Body* wall = make(world, std::make_shared<Rectangle>(0.1, 4), { 8, 0 }, Body::BodyType::Static);
+				wall->setRestitution(restitution);
+				Body* bullet = make(world, std::make_shared<Rectangle>(0.1, 0.1), { -5, 0.5 }, Body::BodyType::Bullet);
+				bullet->setRestitution(restitution);
+				bullet->velocity() = { 1000, 0 };
+
+				real farthest = bullet->position().x;
+				for (int step = 0; step < 60; step++)
+				{
+					world.step(1.0 / 60);
+					farthest = Math::max(farthest, bullet->position().x);
+				}
+				//faces of the wall and the bullet meet at 7.9
+				check(farthest < 7.9 + 0.01, fmt::format("bullet with restitution {} reaches {}", restitution, farthest));
+				check(std::fabs(bullet->velocity().x + 1000 * restitution) < 0.01,
+					fmt::format("bullet with restitution {} leaves at {}", restitution, bullet->velocity().x));
+			}
+		}
+		//two bullets whose paths cross at the same time meet there instead of passing through each other
+		void testCrossing()
+		{
+			World world;
+			world.setGravity({ 0, 0 });
+			Body* first = make(world, std::make_shared<Rectangle>(0.1, 0.1), { -5, 0 }, Body::BodyType::Bullet);
+			Body* second = make(world, std::make_shared<Rectangle>(0.1, 0.1), { 3, 4.8 }, Body::BodyType::Bullet);
+			first->velocity() = { 1000, 0 };
+			second->velocity() = { 0, -600 };
+			first->setRestitution(0);
+			second->setRestitution(0);
+			world.stepVelocity(1.0 / 60);
+			world.stepPosition(1.0 / 60);
+
+			const Vector2 momentum = first->velocity() + second->velocity();
+			check(std::fabs(momentum.x - 1000) < 1e-6 && std::fabs(momentum.y + 600) < 1e-6,
+				fmt::format("crossing bullets end with momentum ({}, {})", momentum.x, momentum.y));
+			check(first->velocity().y < -1 && second->velocity().x > 1,
+				fmt::format("crossing bullets leave at ({}, {}) and ({}, {})", first->velocity().x, first->velocity().y, second->velocity().x, second->velocity().y));
+		}
+		//a gallery of bullets, boxes and walls gives the same bits for any number of workers,
+		//and stays close to the serial path, which resolves impacts passed on to third bodies in strict time order
+		void testWorkers()
+		{
+			const std::vector<State> serial = gallery(nullptr);
+			Utils::WorkerPool one(1);
+			const std::vector<State> single = gallery(&one);
+			for (const size_t& workers : { 2, 4 })
+			{
+				Utils::WorkerPool pool(workers);
+				const std::vector<State> pooled = gallery(&pool);
+				size_t differ = 0;
+				for (size_t i = 0; i < pooled.size(); i++)
+					if (!(pooled[i] == single[i]))
+						differ++;
+				check(differ == 0, fmt::format("{} bodies differ between 1 and {} workers", differ, workers));
+			}
+			real deviation = 0;
+			for (size_t i = 0; i < serial.size(); i++)
+			{
+				deviation = Math::max(deviation, (serial[i].position - single[i].position).length());
+				deviation = Math::max(deviation, (serial[i].velocity - single[i].velocity).length() / 1000);
+			}
+			check(deviation < 1e-3, fmt::format("pooled gallery deviates from serial by {}", deviation));
+		}
+	private:
+		struct State
+		{
+			Vector2 position;
+			Vector2 velocity;
+			real rotation = 0;
+			real angularVelocity = 0;
+			bool operator==(const State& other)const
+			{
+				return position.x == other.position.x && position.y == other.position.y && velocity.x == other.velocity.x && velocity.y == other.velocity.y
+					&& rotation == other.rotation && angularVelocity == other.angularVelocity;
+			}
+		};
+		//400 rows of a bullet, a box in its way and a wall behind, five steps with a broadphase
+		std::vector<State> gallery(Utils::WorkerPool* pool)
+		{
+			World world;
+			world.setGravity({ 0, 0 });
+			DBVH tree;
+			auto small = std::make_shared<Rectangle>(0.1, 0.1);
+			auto wall = std::make_shared<Rectangle>(0.2, 0.5);
+			auto box = std::make_shared<Rectangle>(0.4, 0.4);
+			for (int i = 0; i < 400; i++)
+			{
+				make(world, wall, { 8, i * 2.0 }, Body::BodyType::Static);
+				make(world, box, { 2.0 + i % 5, i * 2.0 + 0.1 }, Body::BodyType::Dynamic);
+				Body* bullet = make(world, small, { -5, i * 2.0 }, Body::BodyType::Bullet);
+				bullet->setMass(0.5);
+				bullet->velocity() = { 900.0 + i % 7 * 20, 0 };
+			}
+			for (auto& body : world.bodyList())
+				tree.insert(body.get());
+			world.setBroadphase(&tree);
+			for (int step = 0; step < 5; step++)
+			{
+				world.stepVelocity(1.0 / 60);
+				world.stepPosition(1.0 / 60, pool);
+				for (auto& body : world.bodyList())
+					tree.update(body.get());
+			}
+			std::vector<State> states;
+			for (auto& body : world.bodyList())
+				states.push_back({ body->position(), body->velocity(), body->rotation(), body->angularVelocity() });
+			return states;
+		}
+		Body* make(World& world, const std::shared_ptr<Shape>& shape, const Vector2& position, const Body::BodyType& type)
+		{
+			Body* body = world.createBody();
+			body->setShape(shape);
+			body->position() = position;
+			body->setMass(type == Body::BodyType::Static ? Constant::Max : 1);
+			body->setType(type);
+			return body;
+		}
+	};
+}
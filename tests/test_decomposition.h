@@ -0,0 +1,160 @@
+#pragma once
+#include "include/physics2d.h"
+#include "include/collision/detector.h"
+#include "tests/test.h"
+namespace Physics2D
+{
+	class DecompositionTest : public Test
+	{
+	public:
+		DecompositionTest() : Test("convex decomposition test")
+		{
+		}
+		void run() override
+		{
+			testPieces();
+			testCompound();
+		}
+		//pieces are convex, counter-clockwise and closed, cover the polygon exactly once and keep every diagonal essential
+		void testPieces()
+		{
+			std::vector<std::pair<std::string, std::vector<Vector2>>> polygons;
+			polygons.emplace_back("l", std::vector<Vector2>{ { 0, 0 }, { 4, 0 }, { 4, 1 }, { 1, 1 }, { 1, 3 }, { 0, 3 } });
+			std::vector<Vector2> comb{ { 0, 0 }, { 9, 0 } };
+			for (int tooth = 4; tooth >= 0; tooth--)
+			{
+				comb.emplace_back(2.0 * tooth + 1, 3);
+				comb.emplace_back(2.0 * tooth, 3);
+				if (tooth > 0)
+					comb.emplace_back(2.0 * tooth, 1);
+				if (tooth > 0)
+					comb.emplace_back(2.0 * tooth - 1, 1);
+			}
+			polygons.emplace_back("comb", comb);
+			std::vector<Vector2> star;
+			for (int i = 0; i < 10; i++)
+				star.emplace_back(Vector2(std::cos(Constant::Pi / 5 * i), std::sin(Constant::Pi / 5 * i)) * (i % 2 == 0 ? 3 : 1.2));
+			polygons.emplace_back("star", star);
+			//clockwise with the closing vertex repeated
+			std::vector<Vector2> closed(polygons[0].second.rbegin(), polygons[0].second.rend());
+			closed.emplace_back(closed.front());
+			polygons.emplace_back("closed clockwise l", closed);
+
+			for (const auto& [name, source] : polygons)
+			{
+				std::vector<Vector2> vertices = source;
+				if (vertices.front() == vertices.back())
+					vertices.pop_back();
+				const real area = std::fabs(signedArea(vertices));
+				size_t reflex = 0;
+				const real winding = signedArea(vertices) > 0 ? 1 : -1;
+				for (size_t i = 0; i < vertices.size(); i++)
+				{
+					const Vector2& previous = vertices[(i + vertices.size() - 1) % vertices.size()];
+					const Vector2& next = vertices[(i + 1) % vertices.size()];
+					if (winding * (vertices[i] - previous).cross(next - vertices[i]) < 0)
+						reflex++;
+				}
+
+				const std::vector<size_t> triangles = GeometryAlgorithm2D::triangulate(source);
+				real triangleArea = 0;
+				size_t flat = 0;
+				for (size_t i = 0; i + 2 < triangles.size(); i += 3)
+				{
+					const real piece = signedArea({ source[triangles[i]], source[triangles[i + 1]], source[triangles[i + 2]] });
+					if (piece < 1e-9)
+						flat++;
+					triangleArea += piece;
+				}
+				check(flat == 0, fmt::format("{}: {} triangles are flat or clockwise", name, flat));
+				//collinear vertices are dropped instead of giving flat triangles
+				check(triangles.size() <= 3 * (vertices.size() - 2) && std::fabs(triangleArea - area) < 1e-9 * area,
+					fmt::format("{}: {} triangle indices covering {} of {}", name, triangles.size(), triangleArea, area));
+
+				const auto pieces = GeometryAlgorithm2D::convexDecomposition(source);
+				//a partition whose diagonals are all essential has at most 2r + 1 pieces
+				check(!pieces.empty() && pieces.size() <= 2 * reflex + 1, fmt::format("{}: {} pieces for {} reflex vertices", name, pieces.size(), reflex));
+				real pieceArea = 0;
+				for (const auto& piece : pieces)
+				{
+					const bool closedPiece = piece.size() >= 4 && piece.front() == piece.back();
+					check(closedPiece, fmt::format("{}: piece of {} vertices is not closed", name, piece.size()));
+					if (!closedPiece)
+						continue;
+					const std::vector<Vector2> ring(piece.begin(), piece.end() - 1);
+					pieceArea += signedArea(ring);
+					bool convex = true;
+					for (size_t i = 0; i < ring.size(); i++)
+						if ((ring[(i + 1) % ring.size()] - ring[i]).cross(ring[(i + 2) % ring.size()] - ring[(i + 1) % ring.size()]) < -1e-9)
+							convex = false;
+					check(convex, fmt::format("{}: piece of {} vertices is not convex and counter-clockwise", name, ring.size()));
+				}
+				check(std::fabs(pieceArea - area) < 1e-9 * area, fmt::format("{}: pieces cover {} of {}", name, pieceArea, area));
+
+				//points of a grid missing edges and diagonals lie in exactly one piece inside the polygon and in none outside
+				size_t wrong = 0;
+				for (int i = 0; i < 130; i++)
+				{
+					for (int j = 0; j < 70; j++)
+					{
+						const Vector2 point(-3.0137 + 0.1 * i, -3.0291 + 0.1 * j);
+						size_t inside = 0;
+						for (const auto& piece : pieces)
+							if (containsConvex(piece, point))
+								inside++;
+						if (inside != (contains(vertices, point) ? 1 : 0))
+							wrong++;
+					}
+				}
+				check(wrong == 0, fmt::format("{}: {} sample points covered wrongly", name, wrong));
+			}
+		}
+		//a circle in the notch of a concave compound touches none of its pieces, one pressed into an arm does
+		void testCompound()
+		{
+			auto compound = std::make_shared<Compound>();
+			compound->appendConcave({ { -3, 0 }, { 3, 0 }, { 3, 4 }, { 2, 4 }, { 2, 1 }, { -2, 1 }, { -2, 4 }, { -3, 4 } });
+			check(compound->children().size() >= 3, fmt::format("u splits into {} children", compound->children().size()));
+			auto circle = std::make_shared<Circle>();
+			circle->setRadius(0.8);
+
+			Body cup, ball;
+			cup.setShape(compound);
+			cup.setMass(1);
+			ball.setShape(circle);
+			ball.setMass(1);
+			ball.position().set(0, 2.5);
+			check(!Detector::detect(&cup, &ball).isColliding, "ball in the notch collides with the cup");
+			ball.position().set(1.5, 2.5);
+			const Collision collision = Detector::detect(&cup, &ball);
+			check(collision.isColliding && std::fabs(collision.penetration - 0.3) < 1e-3,
+				fmt::format("ball pressed into the arm collides {} at depth {}", collision.isColliding, collision.penetration));
+		}
+	private:
+		static real signedArea(const std::vector<Vector2>& ring)
+		{
+			real area = 0;
+			for (size_t i = 0; i < ring.size(); i++)
+				area += ring[i].cross(ring[(i + 1) % ring.size()]);
+			return area / 2;
+		}
+		//strictly inside a counter-clockwise closed convex piece
+		static bool containsConvex(const std::vector<Vector2>& piece, const Vector2& point)
+		{
+			for (size_t i = 0; i + 1 < piece.size(); i++)
+				if ((piece[i + 1] - piece[i]).cross(point - piece[i]) <= 0)
+					return false;
+			return true;
+		}
+		//crossing number of a ray to the right
+		static bool contains(const std::vector<Vector2>& ring, const Vector2& point)
+		{
+			bool inside = false;
+			for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++)
+				if ((ring[i].y > point.y) != (ring[j].y > point.y) &&
+					point.x < (ring[j].x - ring[i].x) * (point.y - ring[i].y) / (ring[j].y - ring[i].y) + ring[i].x)
+					inside = !inside;
+			return inside;
+		}
+	};
+}
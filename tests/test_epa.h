@@ -0,0 +1,140 @@
+#pragma once
+#include "include/physics2d.h"
+#include "include/collision/algorithm/gjk.h"
+#include "include/collision/algorithm/sat.h"
+#include "include/collision/detector.h"
+#include "tests/test.h"
+namespace Physics2D
+{
+	class EpaTest : public Test
+	{
+	public:
+		EpaTest() : Test("epa test")
+		{
+		}
+		void run() override
+		{
+			testPolygons();
+			testCurved();
+			testDetector();
+		}
+		//deep polygon pairs: the heap expansion finds the depth sat finds, and the depth of the rescanning expansion
+		void testPolygons()
+		{
+			auto rectangle = std::make_shared<Rectangle>(2, 1);
+			auto hexagon = std::make_shared<Polygon>();
+			for (int i = 0; i < 6; i++)
+				hexagon->append(Vector2(std::cos(Constant::Pi / 3 * i), std::sin(Constant::Pi / 3 * i)) * 1.2);
+			hexagon->append(Vector2(1.2, 0));
+			for (const std::shared_ptr<Polygon>& other : { std::static_pointer_cast<Polygon>(rectangle), hexagon })
+			{
+				for (int i = 0; i < 24; i++)
+				{
+					ShapePrimitive shapeA, shapeB;
+					shapeA.shape = rectangle;
+					shapeA.rotation = 0.3 * i;
+					shapeB.shape = other;
+					shapeB.rotation = -0.7 * i;
+					shapeB.transform.set(0.4 * std::cos(1.1 * i), 0.4 * std::sin(1.1 * i));
+
+					auto [isColliding, simplex] = GJK::gjk(shapeA, shapeB);
+					check(isColliding, fmt::format("polygon pair {} should overlap", i));
+					if (!isColliding)
+						continue;
+					auto [polytope, iterations] = GJK::epa(shapeA, shapeB, simplex);
+					const PenetrationInfo heap = GJK::dumpInfo(GJK::dumpSource(polytope));
+					const PenetrationInfo rescan = GJK::dumpInfo(GJK::dumpSource(expand(shapeA, shapeB, simplex)));
+					const SATResult exact = SAT::polygonVsPolygon(shapeA, shapeB);
+
+					check(iterations < 20, fmt::format("polygon pair {} took {} iterations", i, iterations));
+					check(std::fabs(heap.penetration - exact.penetration) < 1e-4 * exact.penetration,
+						fmt::format("polygon pair {} depth {} against sat {}", i, heap.penetration, exact.penetration));
+					check(std::fabs(heap.penetration - rescan.penetration) < 1e-4 * rescan.penetration,
+						fmt::format("polygon pair {} depth {} against rescan {}", i, heap.penetration, rescan.penetration));
+					//ties of faces may flip the normal, either way b must leave a at the depth along it
+					check(separation(shapeA, shapeB, heap.normal) - heap.penetration < 1e-4 * exact.penetration,
+						fmt::format("polygon pair {} leaves along its normal at {}, not {}", i, separation(shapeA, shapeB, heap.normal), heap.penetration));
+				}
+			}
+		}
+		//curved shapes are only approximated by the polytope, its depth must come close to where b leaves a along the normal
+		void testCurved()
+		{
+			auto circle = std::make_shared<Circle>();
+			circle->setRadius(1);
+			auto ellipse = std::make_shared<Ellipse>(2, 1);
+			auto rectangle = std::make_shared<Rectangle>(2, 1);
+			for (int i = 0; i < 24; i++)
+			{
+				ShapePrimitive shapeA, shapeB;
+				shapeA.shape = ellipse;
+				shapeA.rotation = 0.3 * i;
+				shapeB.shape = i % 2 == 0 ? std::static_pointer_cast<Shape>(circle) : rectangle;
+				shapeB.rotation = -0.7 * i;
+				shapeB.transform.set(0.5 * std::cos(1.1 * i), 0.5 * std::sin(1.1 * i));
+
+				auto [isColliding, simplex] = GJK::gjk(shapeA, shapeB);
+				check(isColliding, fmt::format("curved pair {} should overlap", i));
+				if (!isColliding)
+					continue;
+				auto [polytope, iterations] = GJK::epa(shapeA, shapeB, simplex);
+				const PenetrationInfo heap = GJK::dumpInfo(GJK::dumpSource(polytope));
+				const PenetrationInfo rescan = GJK::dumpInfo(GJK::dumpSource(expand(shapeA, shapeB, simplex)));
+				const real exact = separation(shapeA, shapeB, heap.normal);
+				//pairs that run into the iteration cap stop short of the relative error
+				const real tolerance = iterations < 20 ? 1e-3 : 1e-2;
+				check(std::fabs(exact - heap.penetration) < tolerance * exact,
+					fmt::format("curved pair {} depth {} leaves at {} after {} iterations", i, heap.penetration, exact, iterations));
+				check(std::fabs(rescan.penetration - heap.penetration) < 1e-2 * exact,
+					fmt::format("curved pair {} depth {} against rescan {}", i, heap.penetration, rescan.penetration));
+			}
+		}
+		//pairs without a specialized kernel report the iterations epa spent on them
+		void testDetector()
+		{
+			Body bodyA, bodyB;
+			bodyA.setShape(std::make_shared<Ellipse>(2, 1));
+			bodyB.setShape(std::make_shared<Rectangle>(2, 1));
+			bodyA.position().set(0, 0);
+			bodyB.position().set(0.3, 0.2);
+			bodyB.rotation() = 0.4;
+			const Collision collision = Detector::detect(&bodyA, &bodyB);
+			check(collision.isColliding && collision.epaIterations > 0,
+				fmt::format("ellipse and rectangle collide {} after {} epa iterations", collision.isColliding, collision.epaIterations));
+		}
+	private:
+		//how far b moves against normal until gjk stops finding it in a, by bisection
+		static real separation(const ShapePrimitive& shapeA, ShapePrimitive shapeB, const Vector2& normal)
+		{
+			const Vector2 start = shapeB.transform;
+			real low = 0, high = 10;
+			for (int i = 0; i < 60; i++)
+			{
+				const real middle = (low + high) / 2;
+				shapeB.transform = start - normal * middle;
+				if (std::get<0>(GJK::gjk(shapeA, shapeB)))
+					low = middle;
+				else
+					high = middle;
+			}
+			return high;
+		}
+		//expansion before the heap: rescan the polytope for its closest edge every iteration
+		static Simplex expand(const ShapePrimitive& shapeA, const ShapePrimitive& shapeB, const Simplex& source)
+		{
+			Simplex simplex = source;
+			for (size_t iteration = 0; iteration <= 20; iteration++)
+			{
+				auto [index1, index2] = GJK::findEdgeClosestToOrigin(simplex);
+				Vector2 normal = GJK::calculateDirectionByEdge(simplex.vertices[index1].result, simplex.vertices[index2].result, false).normal();
+				if (GeometryAlgorithm2D::isPointOnSegment(simplex.vertices[index1].result, simplex.vertices[index2].result, { 0, 0 }))
+					normal.negate();
+				const Minkowski p = GJK::support(shapeA, shapeB, normal);
+				if (simplex.contains(p) || simplex.fuzzyContains(p, 0.0001))
+					break;
+				simplex.insert(index1, p);
+			}
+			return simplex;
+		}
+	};
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include "include/physics2d.h"
+#include "include/collision/detector.h"
+#include "include/dynamics/constraint/contact.h"
+#include "tests/test.h"
+namespace Physics2D
+{
+	class FeatureTest : public Test
+	{
+	public:
+		FeatureTest() : Test("feature test")
+		{
+		}
+		void run() override
+		{
+			testTilt();
+			testLonePoint();
+			testWarmStart();
+		}
+		//a box rocking on a box keeps the ids of both corners, although the reference face flips between them
+		void testTilt()
+		{
+			Body ground, box;
+			setup(ground, box, 1);
+			uint64_t left = 0, right = 0;
+			size_t changed = 0, manifolds = 0, flipped = 0;
+			for (int i = 0; i < 200; i++)
+			{
+				place(box, 1, 0.004 * std::sin(0.37 * i), 0.05 * std::sin(0.13 * i));
+				const Collision collision = Detector::detect(&ground, &box);
+				if (collision.contactList.size() != 2)
+					continue;
+				manifolds++;
+				//face of the lower box gives a vertical normal, face of the tilted box does not
+				if (collision.normal.x != 0)
+					flipped++;
+				const bool ordered = collision.contactList[0].pointB.x < collision.contactList[1].pointB.x;
+				const uint64_t first = collision.contactList[ordered ? 0 : 1].feature;
+				const uint64_t second = collision.contactList[ordered ? 1 : 0].feature;
+				if (left == 0)
+				{
+					left = first;
+					right = second;
+				}
+				if (first != left || second != right)
+					changed++;
+			}
+			check(manifolds > 150, fmt::format("only {} of the tilts give two points", manifolds));
+			check(flipped > 20 && manifolds - flipped > 20, fmt::format("upper box is reference on {} of {} tilts", flipped, manifolds));
+			check(left != 0 && right != 0 && left != right, fmt::format("corners get ids {:x} and {:x}", left, right));
+			check(changed == 0, fmt::format("ids of the corners change on {} of {} tilts", changed, manifolds));
+		}
+		//the corner left touching after the other one lifts off keeps the id it had in the two point manifold
+		void testLonePoint()
+		{
+			Body ground, box;
+			setup(ground, box, 1);
+			place(box, 1, 0, 0);
+			const Collision flat = Detector::detect(&ground, &box);
+			check(flat.contactList.size() == 2, fmt::format("flat box touches at {} points", flat.contactList.size()));
+			if (flat.contactList.size() != 2)
+				return;
+			for (const real& rotation : { -0.2, 0.2 })
+			{
+				place(box, 1, rotation, 0);
+				const Collision tilted = Detector::detect(&ground, &box);
+				check(tilted.contactList.size() == 1, fmt::format("box tilted {} touches at {} points", rotation, tilted.contactList.size()));
+				if (tilted.contactList.size() != 1)
+					continue;
+				const Vector2 corner = tilted.contactList[0].pointB;
+				const PointPair& nearest = std::fabs(flat.contactList[0].pointB.x - corner.x) < std::fabs(flat.contactList[1].pointB.x - corner.x) ?
+					flat.contactList[0] : flat.contactList[1];
+				check(tilted.contactList[0].feature == nearest.feature,
+					fmt::format("box tilted {} touches with id {:x}, its corner had {:x}", rotation, tilted.contactList[0].feature, nearest.feature));
+			}
+		}
+		//contacts found again inherit from the same corner while the reference flips, also on boxes smaller than the distance fuzzy matching accepts
+		void testWarmStart()
+		{
+			for (const real& size : { 1.0, 0.1 })
+			{
+				Body ground, box;
+				setup(ground, box, size);
+				ContactMaintainer maintainer;
+				size_t inherited = 0, swapped = 0, fresh = 0;
+				for (int i = 0; i < 300; i++)
+				{
+					place(box, size, 0.005 * std::sin(0.41 * i) * (i % 3 == 0 ? -1 : 1), 0.05 * size * std::sin(0.07 * i));
+					const Collision collision = Detector::detect(&ground, &box);
+					if (!collision.isColliding)
+						continue;
+					const std::vector<ContactPair>& pairs = maintainer.pairs();
+					const std::vector<ContactConstraintPoint> before = pairs.empty() ? std::vector<ContactConstraintPoint>() : pairs.front().contacts;
+					maintainer.add(collision);
+					const std::vector<ContactConstraintPoint>& after = maintainer.pairs().front().contacts;
+					for (size_t j = 0; j < after.size(); j++)
+					{
+						if (j >= before.size() || !after[j].active)
+						{
+							fresh++;
+							continue;
+						}
+						inherited++;
+						//the corner of the box does not move on the box, only the point on the ground slides
+						if ((after[j].localB - before[j].localB).length() > 0.01 * size)
+							swapped++;
+					}
+					maintainer.solve(1.0 / 60);
+					box.velocity().set(0, 0);
+					box.angularVelocity() = 0;
+				}
+				check(inherited > 400, fmt::format("only {} contacts of the {} box are found again", inherited, size));
+				check(swapped == 0, fmt::format("{} of {} contacts of the {} box inherit from the other corner", swapped, inherited, size));
+				check(fresh <= 2, fmt::format("{} contacts of the {} box start fresh", fresh, size));
+			}
+		}
+	private:
+		//a box stacked on an equal box, top face of the lower one at zero
+		static void setup(Body& ground, Body& box, const real& size)
+		{
+			ground.setShape(std::make_shared<Rectangle>(size, size));
+			ground.position().set(0, -0.5 * size);
+			ground.setMass(Constant::Max);
+			ground.setType(Body::BodyType::Static);
+			ground.setId(1);
+			box.setShape(std::make_shared<Rectangle>(size, size));
+			box.setMass(1);
+			box.setType(Body::BodyType::Dynamic);
+			box.setId(2);
+		}
+		//the lower corner of the box sinks a hundredth of its size into the ground
+		static void place(Body& box, const real& size, const real& rotation, const real& x)
+		{
+			box.rotation() = rotation;
+			const real half = size * 0.5;
+			const real lowest = half * (std::fabs(std::sin(rotation)) + std::cos(rotation));
+			box.position().set(x, lowest - 0.01 * size);
+		}
+	};
+}
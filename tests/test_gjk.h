@@ -44,8 +44,9 @@ namespace Physics2D
 			fmt::print("p: {}\n", b.center());
 
 			auto [isCollide, simplex] = GJK::gjk(spa, spb);
-			simplex = GJK::epa(spa, spb, simplex);
-			auto info = GJK::dumpInfo(simplex);
+			auto [polytope, iterations] = GJK::epa(spa, spb, simplex);
+			fmt::print("epa iterations: {}\n", iterations);
+			auto info = GJK::dumpInfo(GJK::dumpSource(polytope));
 
 			auto result = GeometryAlgorithm2D::lineSegmentIntersection({ -4,2 }, { -2,3 }, { -2,0 }, { -3,4 });
 			if (result.has_value())
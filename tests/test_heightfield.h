@@ -0,0 +1,185 @@
+#pragma once
+#include "include/physics2d.h"
+#include "include/collision/detector.h"
+#include "tests/test.h"
+namespace Physics2D
+{
+	class HeightfieldTest : public Test
+	{
+	public:
+		HeightfieldTest() : Test("heightfield test")
+		{
+		}
+		void run() override
+		{
+			testColumns();
+			testEdit();
+			testDetector();
+		}
+		//the columns found by division are the columns overlapping a range, at most one touching it at an end on either side
+		void testColumns()
+		{
+			Heightfield heightfield;
+			std::vector<real> heights;
+			for (int i = 0; i < 50; i++)
+				heights.emplace_back(std::sin(0.7 * i));
+			heightfield.set(heights, 0.25, -3);
+			const size_t count = heightfield.segmentCount();
+			check(count == 49 && std::fabs(heightfield.right() - 9.25) < 1e-12, fmt::format("{} columns end at {}", count, heightfield.right()));
+
+			size_t missed = 0, extra = 0;
+			std::vector<std::pair<real, real>> ranges;
+			for (int i = 0; i < 400; i++)
+			{
+				const real minX = -5 + 16 * (0.5 + 0.5 * std::sin(1.3 * i));
+				ranges.emplace_back(minX, minX + 3 * (0.5 + 0.5 * std::cos(2.9 * i)));
+			}
+			//ends on sample x and ranges of no width
+			ranges.insert(ranges.end(), { { -3, -3 }, { -3, 9.25 }, { -0.5, 0.5 }, { 9.25, 9.25 }, { 1, 1 }, { -10, -3.5 }, { 9.5, 12 }, { -10, 12 } });
+			for (const auto& [minX, maxX] : ranges)
+			{
+				const auto [first, last] = heightfield.columns(minX, maxX);
+				for (size_t i = 0; i < count; i++)
+				{
+					const real start = heightfield.left() + heightfield.spacing() * i;
+					const real end = start + heightfield.spacing();
+					const bool overlaps = start < maxX && end > minX;
+					const bool touches = start <= maxX && end >= minX;
+					const bool found = i >= first && i < last;
+					if (overlaps && !found)
+						missed++;
+					if (found && !touches)
+						extra++;
+				}
+				if (last > count || (first < last && last - first > static_cast<size_t>((maxX - minX) / heightfield.spacing()) + 2))
+					extra++;
+			}
+			check(missed == 0 && extra == 0, fmt::format("{} overlapping columns missed, {} found apart from the range", missed, extra));
+
+			//height between samples is interpolated along the column
+			size_t wrong = 0;
+			for (int i = 0; i < 1000; i++)
+			{
+				const real x = -3 + 12.25 * (i + 0.5) / 1000;
+				const size_t index = static_cast<size_t>((x + 3) / 0.25);
+				const real t = (x + 3) / 0.25 - index;
+				const real height = heights[index] * (1 - t) + heights[index + 1] * t;
+				if (!heightfield.contains({ x, height - 0.01 }) || heightfield.contains({ x, height + 0.01 }))
+					wrong++;
+			}
+			check(wrong == 0, fmt::format("{} points on either side of the surface are classified wrongly", wrong));
+		}
+		//edits keep the bounds those of the heights, including raising the lowest and lowering the highest sample
+		void testEdit()
+		{
+			Heightfield heightfield;
+			std::vector<real> heights(64, 0);
+			heightfield.set(heights, 0.5);
+			size_t wrong = 0;
+			for (int i = 0; i < 2000; i++)
+			{
+				const size_t index = static_cast<size_t>(31.5 + 31.5 * std::sin(1.7 * i));
+				real height = 2 * std::sin(0.37 * i);
+				//every fourth edit hits the sample on a bound
+				if (i % 4 == 0)
+				{
+					const auto bound = i % 8 == 0 ? std::min_element(heights.begin(), heights.end()) : std::max_element(heights.begin(), heights.end());
+					height = std::cos(0.61 * i);
+					heightfield.setHeight(bound - heights.begin(), height);
+					*bound = height;
+				}
+				else
+				{
+					heightfield.setHeight(index, height);
+					heights[index] = height;
+				}
+				const auto [min, max] = std::minmax_element(heights.begin(), heights.end());
+				if (heightfield.minHeight() != *min || heightfield.maxHeight() != *max || heightfield.heights() != heights)
+					wrong++;
+			}
+			check(wrong == 0, fmt::format("bounds differ from the heights after {} edits", wrong));
+
+			//a sample raised under a ball reaches it, lowered again it lets go
+			Body ground, ball;
+			auto terrain = std::make_shared<Heightfield>();
+			terrain->set(std::vector<real>(64, 0), 0.5);
+			ground.setShape(terrain);
+			ground.setMass(Constant::Max);
+			ground.setType(Body::BodyType::Static);
+			auto circle = std::make_shared<Circle>();
+			circle->setRadius(0.5);
+			ball.setShape(circle);
+			ball.setMass(1);
+			ball.position().set(10, 2);
+			check(Detector::detectChain(&ball, &ground).empty(), "ball above flat ground collides");
+			terrain->setHeight(20, 1.8);
+			const std::vector<Collision> raised = Detector::detectChain(&ball, &ground);
+			check(!raised.empty() && std::fabs(raised.front().penetration - 0.3) < 1e-9,
+				fmt::format("ball on a raised sample collides {} times", raised.size()));
+			terrain->setHeight(20, 0);
+			check(Detector::detectChain(&ball, &ground).empty() && terrain->maxHeight() == 0, "ball above lowered ground collides");
+		}
+		//a moved and rotated heightfield collides like the chain through its samples
+		void testDetector()
+		{
+			auto terrain = std::make_shared<Heightfield>();
+			std::vector<real> heights;
+			for (int i = 0; i < 200; i++)
+				heights.emplace_back(0.6 * std::sin(0.3 * i) + 0.2 * std::cos(1.1 * i));
+			terrain->set(heights, 0.2, -20);
+			std::vector<Vector2> vertices;
+			for (size_t i = heights.size(); i-- > 0;)
+				vertices.emplace_back(terrain->sample(i));
+			auto chain = std::make_shared<Chain>();
+			chain->set(vertices);
+
+			auto circle = std::make_shared<Circle>();
+			circle->setRadius(0.3);
+			auto box = std::make_shared<Rectangle>(0.8, 0.4);
+			auto capsule = std::make_shared<Capsule>();
+			capsule->set(0.9, 0.3);
+			const std::shared_ptr<Shape> shapes[] = { circle, box, capsule };
+
+			size_t differ = 0, colliding = 0;
+			for (int i = 0; i < 300; i++)
+			{
+				Body heightfieldBody, chainBody, body;
+				for (Body* ground : { &heightfieldBody, &chainBody })
+				{
+					ground->setShape(ground == &heightfieldBody ? std::static_pointer_cast<Shape>(terrain) : chain);
+					ground->position().set(1, -0.5);
+					ground->rotation() = 0.2;
+					ground->setMass(Constant::Max);
+					ground->setType(Body::BodyType::Static);
+				}
+				body.setShape(shapes[i % 3]);
+				body.setMass(1);
+				const real x = -19 + 37.0 * i / 300;
+				body.position() = heightfieldBody.toWorldPoint({ x, 0.6 * std::sin(0.3 * (x + 20) / 0.2) + 0.3 * std::sin(2.3 * i) });
+				body.rotation() = std::sin(1.9 * i);
+
+				const std::vector<Collision> found = Detector::detectChain(&body, &heightfieldBody);
+				const std::vector<Collision> expected = Detector::detectChain(&body, &chainBody);
+				if (!found.empty())
+					colliding++;
+				if (found.size() != expected.size())
+				{
+					differ++;
+					continue;
+				}
+				for (const Collision& collision : found)
+				{
+					bool matched = false;
+					for (const Collision& other : expected)
+						if ((collision.normal - other.normal).length() < 1e-9 && std::fabs(collision.penetration - other.penetration) < 1e-9
+							&& collision.contactList.size() == other.contactList.size())
+							matched = true;
+					if (!matched)
+						differ++;
+				}
+			}
+			check(colliding > 100, fmt::format("only {} of the bodies touch the ground", colliding));
+			check(differ == 0, fmt::format("{} collisions differ from the chain", differ));
+		}
+	};
+}
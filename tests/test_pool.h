@@ -0,0 +1,157 @@
+#pragma once
+#include "include/physics2d.h"
+#include "include/collision/detector.h"
+#include "include/dynamics/world.h"
+#include "include/dynamics/constraint/contact.h"
+#include "include/collision/broadphase/dbvh.h"
+#include "include/utils/worker_pool.h"
+#include "tests/test.h"
+namespace Physics2D
+{
+	class PoolTest : public Test
+	{
+	public:
+		PoolTest() : Test("pool test")
+		{
+		}
+		void run() override
+		{
+			testNarrowphase();
+			testSolver();
+		}
+		//every pair owns its output slot, so a batch detected on any number of workers gives the same bits as without pool
+		void testNarrowphase()
+		{
+			World world;
+			DBVH tree;
+			pile(world, tree);
+			const auto pairs = tree.generatePairs();
+			for (const real& speculativeTime : { 0.0, 1.0 / 60 })
+			{
+				const std::vector<Collision> serial = Detector::detect(pairs, nullptr, speculativeTime);
+				check(serial.size() > 100, fmt::format("pile gives only {} collisions", serial.size()));
+				for (const size_t& workers : { 1, 2, 4 })
+				{
+					Utils::WorkerPool pool(workers);
+					const std::vector<Collision> pooled = Detector::detect(pairs, &pool, speculativeTime);
+					size_t differ = pooled.size() == serial.size() ? 0 : Math::max(pooled.size(), serial.size());
+					for (size_t i = 0; i < pooled.size() && i < serial.size(); i++)
+						if (!same(pooled[i], serial[i]))
+							differ++;
+					check(differ == 0, fmt::format("{} collisions differ on {} workers with speculation {}", differ, workers, speculativeTime));
+				}
+			}
+		}
+		//colors are solved in the same order with or without pool and batches of a color share no body,
+		//so the pile settles to the same bits on any number of workers, in both solver modes
+		void testSolver()
+		{
+			for (const bool& substep : { false, true })
+			{
+				const std::vector<real> serial = settle(nullptr, substep);
+				for (const size_t& workers : { 1, 2, 4 })
+				{
+					Utils::WorkerPool pool(workers);
+					const std::vector<real> pooled = settle(&pool, substep);
+					size_t differ = 0;
+					for (size_t i = 0; i < pooled.size(); i++)
+						if (pooled[i] != serial[i])
+							differ++;
+					check(differ == 0, fmt::format("{} values differ on {} workers in {} mode", differ, workers, substep ? "substep" : "iteration"));
+				}
+			}
+		}
+	private:
+		//the pile with joints between stacked bodies, stepped like the testbed, poses and velocities of all bodies at the end
+		static std::vector<real> settle(Utils::WorkerPool* pool, const bool& substep)
+		{
+			World world;
+			DBVH tree;
+			pile(world, tree);
+			world.setGravity({ 0, -9.8 });
+			world.setSolverMode(substep ? World::SolverMode::Substep : World::SolverMode::Iteration);
+			world.setPositionCorrection(true);
+			auto& bodies = world.bodyList();
+			for (size_t i = 1; i + 60 < bodies.size(); i += 9)
+			{
+				RotationJointPrimitive primitive;
+				primitive.bodyA = bodies[i].get();
+				primitive.bodyB = bodies[i + 60].get();
+				world.createJoint(primitive);
+			}
+			ContactMaintainer contactMaintainer;
+			contactMaintainer.m_blockSolve = true;
+			contactMaintainer.m_positionCorrection = true;
+			const real dt = 1.0 / 30;
+			for (int step = 0; step < 30; step++)
+			{
+				if (substep)
+				{
+					for (auto& result : Detector::detect(tree.generatePairs(), pool, dt))
+						contactMaintainer.add(result);
+					world.substep(dt, contactMaintainer, pool);
+				}
+				else
+				{
+					world.stepVelocity(dt, pool);
+					for (auto& result : Detector::detect(tree.generatePairs(), pool, dt))
+						contactMaintainer.add(result);
+					contactMaintainer.solve(dt, pool);
+					world.stepPosition(dt, pool, &contactMaintainer);
+				}
+				for (auto& body : bodies)
+					tree.update(body.get());
+			}
+			std::vector<real> values;
+			for (auto& body : bodies)
+			{
+				values.insert(values.end(), { body->position().x, body->position().y, body->rotation() });
+				values.insert(values.end(), { body->velocity().x, body->velocity().y, body->angularVelocity() });
+			}
+			return values;
+		}
+		//boxes, circles and capsules dropped on each other and on a floor, overlapping in many places
+		static void pile(World& world, DBVH& tree)
+		{
+			auto floor = std::make_shared<Rectangle>(60, 1);
+			auto box = std::make_shared<Rectangle>(1, 0.6);
+			auto circle = std::make_shared<Circle>();
+			circle->setRadius(0.4);
+			auto capsule = std::make_shared<Capsule>();
+			capsule->set(1.2, 0.4);
+			const std::shared_ptr<Shape> shapes[] = { box, circle, capsule };
+
+			Body* ground = world.createBody();
+			ground->setShape(floor);
+			ground->setMass(Constant::Max);
+			ground->setType(Body::BodyType::Static);
+			for (int i = 0; i < 600; i++)
+			{
+				Body* body = world.createBody();
+				body->setShape(shapes[i % 3]);
+				body->position().set(-25 + (i % 60) * 0.85, 0.6 + (i / 60) * 0.7 + 0.05 * std::sin(1.7 * i));
+				body->rotation() = 0.5 * std::sin(2.3 * i);
+				body->velocity().set(std::sin(0.9 * i), -2 + std::cos(1.3 * i));
+				body->setMass(1);
+				body->setType(Body::BodyType::Dynamic);
+			}
+			for (auto& body : world.bodyList())
+				tree.insert(body.get());
+		}
+		static bool same(const Collision& a, const Collision& b)
+		{
+			if (a.isColliding != b.isColliding || a.bodyA != b.bodyA || a.bodyB != b.bodyB || a.contactList.size() != b.contactList.size())
+				return false;
+			if (a.normal.x != b.normal.x || a.normal.y != b.normal.y || a.penetration != b.penetration)
+				return false;
+			for (size_t i = 0; i < a.contactList.size(); i++)
+			{
+				const PointPair& p = a.contactList[i];
+				const PointPair& q = b.contactList[i];
+				if (p.pointA.x != q.pointA.x || p.pointA.y != q.pointA.y || p.pointB.x != q.pointB.x || p.pointB.y != q.pointB.y || p.feature != q.feature)
+					return false;
+			}
+			return true;
+		}
+	};
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include "include/physics2d.h"
+#include "include/dynamics/world.h"
+#include "include/dynamics/constraint/contact.h"
+#include "tests/test.h"
+#include <map>
+#include <set>
+namespace Physics2D
+{
+	class RelationTest : public Test
+	{
+	public:
+		RelationTest() : Test("relation test")
+		{
+		}
+		void run() override
+		{
+			testKey();
+			testTable();
+		}
+		//keys of different pairs differ, whatever digits their ids share, and ignore the order of bodies
+		void testKey()
+		{
+			Body a, b, c, d;
+			a.setId(1);
+			b.setId(23);
+			c.setId(12);
+			d.setId(3);
+			check(generateRelation(&a, &b) != generateRelation(&c, &d), "pairs (1, 23) and (12, 3) share a key");
+			check(generateRelation(&a, &b) == generateRelation(&b, &a), "key of (1, 23) depends on order");
+
+			std::set<RelationID> keys;
+			size_t asymmetric = 0, pairs = 0;
+			std::vector<int> ids;
+			for (int i = 0; i < 150; i++)
+				ids.emplace_back(i);
+			ids.insert(ids.end(), { 9999, 10000, 65535, 65536, 99999, INT32_MAX - 1, INT32_MAX });
+			for (size_t i = 0; i < ids.size(); i++)
+			{
+				for (size_t j = i + 1; j < ids.size(); j++)
+				{
+					a.setId(ids[i]);
+					b.setId(ids[j]);
+					keys.insert(generateRelation(&a, &b));
+					if (generateRelation(&a, &b) != generateRelation(&b, &a))
+						asymmetric++;
+					pairs++;
+				}
+			}
+			check(keys.size() == pairs && asymmetric == 0, fmt::format("{} pairs give {} keys, {} depend on order", pairs, keys.size(), asymmetric));
+		}
+		//pairs come and go over many steps, the table keeps finding each pair in its slot through swap-removes and rehashes
+		void testTable()
+		{
+			World world;
+			world.setGravity({ 0, 0 });
+			auto circle = std::make_shared<Circle>();
+			circle->setRadius(0.5);
+			std::vector<Body*> bodies;
+			for (int i = 0; i < 300; i++)
+			{
+				Body* body = world.createBody();
+				body->setShape(circle);
+				body->setMass(1);
+				body->setType(Body::BodyType::Dynamic);
+				body->setId(i + 1);
+				bodies.emplace_back(body);
+			}
+
+			ContactMaintainer maintainer;
+			size_t duplicated = 0, missing = 0, mixed = 0, lost = 0, kept = 0;
+			std::map<RelationID, std::pair<Body*, Body*>> previous;
+			for (int step = 0; step < 200; step++)
+			{
+				//between 0 and 1200 pairs, many of them present in the step before
+				std::map<RelationID, std::pair<Body*, Body*>> expected;
+				const int count = static_cast<int>(600 + 600 * std::sin(0.11 * step));
+				for (int k = 0; k < count; k++)
+				{
+					const size_t i = static_cast<size_t>(k * 7 + step / 3) % bodies.size();
+					const size_t j = (i + 1 + static_cast<size_t>(k * 13 + step * step) % 37) % bodies.size();
+					//both orders of the pair land in the same key
+					Body* bodyA = k % 2 == 0 ? bodies[i] : bodies[j];
+					Body* bodyB = k % 2 == 0 ? bodies[j] : bodies[i];
+					const RelationID relation = generateRelation(bodyA, bodyB);
+					if (expected.count(relation) != 0)
+						continue;
+					expected[relation] = { bodyA, bodyB };
+					Collision collision;
+					collision.isColliding = true;
+					collision.bodyA = bodyA;
+					collision.bodyB = bodyB;
+					collision.normal.set(0, 1);
+					collision.penetration = 0.001;
+					PointPair point;
+					point.pointA = bodyA->position();
+					point.pointB = bodyB->position();
+					point.feature = 1;
+					collision.contactList.emplace_back(point);
+					maintainer.add(collision);
+				}
+				//pairs found again in the same order keep their contact instead of getting a second one
+				for (const ContactPair& pair : maintainer.pairs())
+				{
+					const auto last = previous.find(pair.relation);
+					if (last == previous.end() || expected.count(pair.relation) == 0 || last->second != expected[pair.relation])
+						continue;
+					kept++;
+					if (pair.contacts.size() != 1)
+						lost++;
+				}
+				maintainer.solve(1.0 / 60);
+
+				std::set<RelationID> found;
+				for (const ContactPair& pair : maintainer.pairs())
+				{
+					if (!found.insert(pair.relation).second)
+						duplicated++;
+					for (const ContactConstraintPoint& contact : pair.contacts)
+						if (contact.relation != pair.relation || generateRelation(contact.bodyA, contact.bodyB) != pair.relation)
+							mixed++;
+				}
+				for (const auto& [relation, bodyPair] : expected)
+					if (found.count(relation) == 0)
+						missing++;
+				if (found.size() != expected.size())
+					missing++;
+				previous = expected;
+			}
+			check(kept > 5000, fmt::format("only {} pairs stay from one step to the next", kept));
+			check(duplicated == 0 && missing == 0 && mixed == 0 && lost == 0,
+				fmt::format("pairs duplicated {}, missing {}, holding other contacts {}, renewed as new {}", duplicated, missing, mixed, lost));
+		}
+	};
+}
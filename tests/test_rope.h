@@ -0,0 +1,171 @@
+#pragma once
+#include "include/physics2d.h"
+#include "include/dynamics/world.h"
+#include "include/dynamics/constraint/rope.h"
+#include "tests/test.h"
+namespace Physics2D
+{
+	class RopeTest : public Test
+	{
+	public:
+		RopeTest() : Test("rope test")
+		{
+		}
+		void run() override
+		{
+			testIterative();
+			testHanging();
+		}
+		//one direct solve gives the velocities sequential impulses over the same links only reach after many iterations
+		void testIterative()
+		{
+			World world;
+			auto box = std::make_shared<Rectangle>(0.2, 0.05);
+			RopePrimitive primitive;
+			primitive.rigid = true;
+			primitive.bodies.emplace_back(nullptr);
+			primitive.localPointsA.emplace_back(0, 0);
+			primitive.localPointsB.emplace_back(-0.1, 0);
+			const int count = 40;
+			for (int i = 0; i < count; i++)
+			{
+				Body* body = world.createBody();
+				body->setShape(box);
+				body->position().set(0.15 + 0.25 * i, 0.1 * std::sin(1.3 * i));
+				body->rotation() = 0.4 * std::cos(0.7 * i);
+				body->velocity().set(std::sin(2.1 * i), std::cos(1.7 * i));
+				body->angularVelocity() = std::sin(0.9 * i);
+				body->setMass(1);
+				body->setType(Body::BodyType::Dynamic);
+				primitive.bodies.emplace_back(body);
+				if (i + 1 < count)
+				{
+					primitive.localPointsA.emplace_back(0.1, 0);
+					primitive.localPointsB.emplace_back(-0.1, 0);
+				}
+			}
+			std::vector<std::pair<Vector2, real>> start;
+			for (size_t i = 1; i < primitive.bodies.size(); i++)
+				start.emplace_back(primitive.bodies[i]->velocity(), primitive.bodies[i]->angularVelocity());
+
+			Rope rope(primitive);
+			rope.prepare(1.0 / 60);
+			rope.solveVelocity(1.0 / 60);
+			const real direct = residual(primitive);
+			std::vector<std::pair<Vector2, real>> solved;
+			for (size_t i = 1; i < primitive.bodies.size(); i++)
+				solved.emplace_back(primitive.bodies[i]->velocity(), primitive.bodies[i]->angularVelocity());
+			check(direct < 1e-9, fmt::format("direct solve leaves links moving apart at {}", direct));
+
+			restore(primitive, start);
+			iterate(primitive, 1);
+			const real single = residual(primitive);
+			check(single > 1e3 * direct, fmt::format("one iteration leaves {} against {} of the direct solve", single, direct));
+
+			restore(primitive, start);
+			iterate(primitive, 20000);
+			real difference = 0;
+			for (size_t i = 1; i < primitive.bodies.size(); i++)
+			{
+				Body* body = primitive.bodies[i];
+				difference = Math::max(difference, (body->velocity() - solved[i - 1].first).length());
+				difference = Math::max(difference, std::fabs(body->angularVelocity() - solved[i - 1].second));
+			}
+			check(difference < 1e-6, fmt::format("converged iterations differ from the direct solve by {}", difference));
+		}
+		//a long chain hanging from its top and swung sideways holds its links with one velocity iteration and position correction
+		void testHanging()
+		{
+			World world;
+			world.setGravity({ 0, -9.8 });
+			world.setVelocityIteration(1);
+			world.setPositionIteration(2);
+			world.setPositionCorrection(true);
+			auto box = std::make_shared<Rectangle>(0.2, 0.05);
+			//empty anchors link centers of bodies, the top link ends at the world origin
+			RopePrimitive primitive;
+			primitive.rigid = true;
+			primitive.bodies.emplace_back(nullptr);
+			const int count = 200;
+			for (int i = 0; i < count; i++)
+			{
+				Body* body = world.createBody();
+				body->setShape(box);
+				body->position().set(0, -0.15 - 0.25 * i);
+				body->velocity().set(2.0 * (i + 1) / count, 0);
+				body->setMass(1);
+				body->setType(Body::BodyType::Dynamic);
+				primitive.bodies.emplace_back(body);
+			}
+			Rope* rope = world.createRope(primitive);
+			real worst = 0;
+			for (int step = 0; step < 600; step++)
+			{
+				world.stepVelocity(1.0 / 60);
+				world.stepPosition(1.0 / 60);
+				for (size_t i = 0; i + 1 < primitive.bodies.size(); i++)
+					worst = Math::max(worst, std::fabs(rope->stretch(i)));
+			}
+			check(worst < 1e-4, fmt::format("{} links stretch up to {}", count, worst));
+		}
+	private:
+		static Vector2 velocityAt(Body* body, const Vector2& r)
+		{
+			return body == nullptr ? Vector2() : body->velocity() + Vector2::crossProduct(body->angularVelocity(), r);
+		}
+		static Vector2 anchor(Body* body, const Vector2& local)
+		{
+			return body == nullptr ? local : body->toWorldPoint(local);
+		}
+		//largest relative velocity along a link
+		static real residual(const RopePrimitive& primitive)
+		{
+			real worst = 0;
+			for (size_t i = 0; i + 1 < primitive.bodies.size(); i++)
+			{
+				Body* bodyA = primitive.bodies[i];
+				Body* bodyB = primitive.bodies[i + 1];
+				const Vector2 pa = anchor(bodyA, primitive.localPointsA[i]);
+				const Vector2 pb = anchor(bodyB, primitive.localPointsB[i]);
+				const Vector2 normal = (pb - pa).normal();
+				const Vector2 va = velocityAt(bodyA, bodyA == nullptr ? Vector2() : pa - bodyA->position());
+				const Vector2 vb = velocityAt(bodyB, pb - bodyB->position());
+				worst = Math::max(worst, std::fabs(normal.dot(vb - va)));
+			}
+			return worst;
+		}
+		//sequential impulses over the links, one after another, like joints are solved
+		static void iterate(const RopePrimitive& primitive, const int& iterations)
+		{
+			for (int iteration = 0; iteration < iterations; iteration++)
+			{
+				for (size_t i = 0; i + 1 < primitive.bodies.size(); i++)
+				{
+					Body* bodyA = primitive.bodies[i];
+					Body* bodyB = primitive.bodies[i + 1];
+					const Vector2 pa = anchor(bodyA, primitive.localPointsA[i]);
+					const Vector2 pb = anchor(bodyB, primitive.localPointsB[i]);
+					const Vector2 normal = (pb - pa).normal();
+					const Vector2 ra = bodyA == nullptr ? Vector2() : pa - bodyA->position();
+					const Vector2 rb = pb - bodyB->position();
+					real k = bodyB->inverseMass() + bodyB->inverseInertia() * rb.cross(normal) * rb.cross(normal);
+					if (bodyA != nullptr)
+						k += bodyA->inverseMass() + bodyA->inverseInertia() * ra.cross(normal) * ra.cross(normal);
+					const real lambda = -normal.dot(velocityAt(bodyB, rb) - velocityAt(bodyA, ra)) / k;
+					const Vector2 impulse = lambda * normal;
+					bodyB->applyImpulse(impulse, rb);
+					if (bodyA != nullptr)
+						bodyA->applyImpulse(-impulse, ra);
+				}
+			}
+		}
+		static void restore(const RopePrimitive& primitive, const std::vector<std::pair<Vector2, real>>& state)
+		{
+			for (size_t i = 1; i < primitive.bodies.size(); i++)
+			{
+				primitive.bodies[i]->velocity() = state[i - 1].first;
+				primitive.bodies[i]->angularVelocity() = state[i - 1].second;
+			}
+		}
+	};
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include "include/physics2d.h"
+#include "include/collision/broadphase/dbvh.h"
+#include "include/dynamics/world.h"
+#include "include/dynamics/constraint/contact.h"
+#include "tests/test.h"
+namespace Physics2D
+{
+	class SpeculationTest : public Test
+	{
+	public:
+		SpeculationTest() : Test("speculation test")
+		{
+		}
+		void run() override
+		{
+			testFaceOn();
+			testDropPhase();
+		}
+		//a face hitting a wall must rebound like it does without speculation, without any spin
+		void testFaceOn()
+		{
+			for (const bool& edge : { false, true })
+			{
+				for (const bool& speculate : { false, true })
+				{
+					const Scene scene = hit(speculate, edge, 0.5, { 10, 0 }, { -3, 0.1 }, 60);
+					check(std::fabs(scene.velocity.x + 8) < 0.01 && std::fabs(scene.velocity.y) < 0.01,
+						fmt::format("box leaves {} at ({}, {}) with speculation {}", edge ? "edge" : "wall", scene.velocity.x, scene.velocity.y, speculate));
+					check(scene.spin < 0.01, fmt::format("box spins up to {} on {} with speculation {}", scene.spin, edge ? "edge" : "wall", speculate));
+				}
+			}
+			const Scene fast = hit(true, false, 0.1, { 1000, 0 }, { -3, 0.1 }, 10);
+			check(std::fabs(fast.velocity.x + 800) < 0.01 && fast.spin < 0.1, fmt::format("small box at 1000 m/s leaves at ({}, {}) spinning {}", fast.velocity.x, fast.velocity.y, fast.spin));
+		}
+		//the rebound must not depend on where the last step before the impact ended
+		void testDropPhase()
+		{
+			for (const real& speed : { 300, 400, 500, 600 })
+			{
+				for (const real& height : { 7.0, 11.3, 17.9, 23.2, 29.7 })
+				{
+					const Scene scene = hit(true, false, 0.5, { 0, -speed }, { 0.1, height }, 8);
+					check(std::fabs(scene.velocity.y - 0.8 * speed) < 0.01,
+						fmt::format("drop at {} from {} rebounds at {}", speed, height, scene.velocity.y));
+				}
+			}
+		}
+	private:
+		struct Scene
+		{
+			Vector2 velocity;
+			real spin = 0;
+		};
+		//testbed loop at 30 Hz without gravity, the box moves along x into a wall or along y into the ground
+		Scene hit(const bool& speculate, const bool& edge, const real& size, const Vector2& velocity, const Vector2& start, const int& steps)
+		{
+			World world;
+			world.setGravity({ 0, 0 });
+			world.setPositionIteration(3);
+			world.setVelocityIteration(1);
+			world.setPositionCorrection(true);
+			ContactMaintainer maintainer;
+			maintainer.m_blockSolve = true;
+			maintainer.m_positionCorrection = true;
+			ManifoldCache cache{ 0.0001, 0.0001 };
+			DBVH dbvh;
+
+			const bool wall = velocity.x != 0;
+			Body* ground = world.createBody();
+			if (edge)
+			{
+				auto shape = std::make_shared<Edge>();
+				shape->set(wall ? Vector2(0, -1000) : Vector2(-1000, 0), wall ? Vector2(0, 1000) : Vector2(1000, 0));
+				ground->setShape(shape);
+			}
+			else
+			{
+				ground->setShape(std::make_shared<Rectangle>(wall ? 1.0 : 2000.0, wall ? 2000.0 : 1.0));
+				ground->position() = wall ? Vector2(0.5, 0) : Vector2(0, -0.5);
+			}
+			ground->setMass(Constant::Max);
+			ground->setType(Body::BodyType::Static);
+			ground->setRestitution(0.8);
+
+			Body* box = world.createBody();
+			box->setShape(std::make_shared<Rectangle>(size, size));
+			box->position() = start;
+			box->setMass(1);
+			box->setType(Body::BodyType::Dynamic);
+			box->velocity() = velocity;
+			box->setRestitution(0.8);
+
+			dbvh.insert(ground);
+			dbvh.insert(box);
+			world.setBroadphase(&dbvh);
+
+			const real dt = 1.0 / 30;
+			Scene scene;
+			for (int i = 0; i < steps; i++)
+			{
+				world.stepVelocity(dt);
+				for (auto& collision : Detector::detect(dbvh.generatePairs(), nullptr, speculate ? dt : 0, &cache))
+					maintainer.add(collision);
+				maintainer.solve(dt);
+				world.stepPosition(dt, nullptr, &maintainer);
+				for (auto& body : world.bodyList())
+					dbvh.update(body.get());
+				scene.spin = Math::max(scene.spin, std::fabs(box->angularVelocity()));
+			}
+			scene.velocity = box->velocity();
+			return scene;
+		}
+	};
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "include/physics2d.h"
+#include "tests/test.h"
+namespace Physics2D
+{
+	class SupportTest : public Test
+	{
+	public:
+		SupportTest() : Test("support test")
+		{
+		}
+		void run() override
+		{
+			testPlateau();
+		}
+		//hill climbing must reach the farthest vertex from every seed, also across runs of collinear vertices
+		void testPlateau()
+		{
+			Polygon square, slab, round;
+			//square with six vertices per side
+			for (int side = 0; side < 4; side++)
+			{
+				for (int k = 0; k < 6; k++)
+				{
+					const real t = -1 + 2.0 * k / 6;
+					const Vector2 points[4] = { Vector2(t, -1), Vector2(1, t), Vector2(-t, 1), Vector2(-1, -t) };
+					square.append(points[side]);
+				}
+			}
+			for (int k = 0; k < 20; k++)
+				slab.append(Vector2(-2 + 4.0 * k / 20, -0.5));
+			for (int k = 0; k < 3; k++)
+				slab.append(Vector2(2, -0.5 + k * 0.33));
+			for (int k = 0; k < 20; k++)
+				slab.append(Vector2(2 - 4.0 * k / 20, 0.5));
+			for (int k = 0; k < 40; k++)
+				round.append(Vector2(Math::cosx(2 * Constant::Pi * k / 40), Math::sinx(2 * Constant::Pi * k / 40)));
+
+			for (Polygon* polygon : { &square, &slab, &round })
+			{
+				polygon->append(polygon->vertices()[0]);
+				const auto& vertices = polygon->vertices();
+				const size_t count = vertices.size() - 1;
+				std::vector<Vector2> directions = { { 0, 1 }, { 0, -1 }, { 1, 0 }, { -1, 0 } };
+				for (int d = 0; d < 720; d++)
+					directions.emplace_back(Math::cosx(2 * Constant::Pi * d / 720), Math::sinx(2 * Constant::Pi * d / 720));
+
+				int wrong = 0;
+				for (const Vector2& direction : directions)
+				{
+					real farthest = Constant::NegativeMin;
+					for (size_t i = 0; i < count; i++)
+						farthest = Math::max(farthest, vertices[i].dot(direction));
+					for (size_t seed = 0; seed < count; seed++)
+						if (vertices[GJK::findFarthestIndex(polygon, direction, seed)].dot(direction) < farthest - Constant::GeometryEpsilon)
+							wrong++;
+				}
+				check(wrong == 0, fmt::format("hill climbing missed the farthest vertex {} times on a {}-gon", wrong, count));
+			}
+		}
+	};
+}